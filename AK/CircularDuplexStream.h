@@ -11,8 +11,6 @@
 
 namespace AK {
 
-// FIXME: There are a lot of raw loops here, that's not necessary an issue but it
-//        has to be verified that the optimizer is able to insert memcpy instead.
 template<size_t Capacity>
 class CircularDuplexStream : public AK::DuplexStream {
 public:
@@ -20,9 +18,13 @@ public:
     {
         const auto nwritten = min(bytes.size(), Capacity - m_queue.size());
 
-        for (size_t idx = 0; idx < nwritten; ++idx)
-            m_queue.enqueue(bytes[idx]);
+        // The free space wraps around the end of the storage at most once
+        const auto tail = (m_queue.head_index() + m_queue.size()) % Capacity;
+        const auto first_part = min(nwritten, Capacity - tail);
+        __builtin_memcpy(m_queue.m_storage + tail, bytes.data(), first_part);
+        __builtin_memcpy(m_queue.m_storage, bytes.data() + first_part, nwritten - first_part);
 
+        m_queue.m_size += nwritten;
         m_total_written += nwritten;
         return nwritten;
     }
@@ -46,9 +48,13 @@ public:
 
         const auto nread = min(bytes.size(), m_queue.size());
 
-        for (size_t idx = 0; idx < nread; ++idx)
-            bytes[idx] = m_queue.dequeue();
+        const auto head = m_queue.head_index();
+        const auto first_part = min(nread, Capacity - head);
+        __builtin_memcpy(bytes.data(), m_queue.m_storage + head, first_part);
+        __builtin_memcpy(bytes.data() + first_part, m_queue.m_storage, nread - first_part);
 
+        m_queue.m_head = (head + nread) % Capacity;
+        m_queue.m_size -= nread;
         return nread;
     }
 
@@ -69,6 +75,28 @@ public:
         return nread;
     }
 
+    // Writes count bytes starting seekback bytes before the end of what was written so far. Like LZ77 back references,
+    // these may overlap the bytes being written, which then repeat.
+    bool copy_from_seekback(size_t seekback, size_t count)
+    {
+        if (seekback == 0 || seekback > Capacity || seekback > m_total_written || count > remaining_space()) {
+            set_recoverable_error();
+            return false;
+        }
+
+        auto destination = (m_queue.head_index() + m_queue.size()) % Capacity;
+        auto source = (destination + Capacity - seekback) % Capacity;
+        for (size_t idx = 0; idx < count; ++idx) {
+            m_queue.m_storage[destination] = m_queue.m_storage[source];
+            destination = (destination + 1) % Capacity;
+            source = (source + 1) % Capacity;
+        }
+
+        m_queue.m_size += count;
+        m_total_written += count;
+        return true;
+    }
+
     bool read_or_error(Bytes bytes) override
     {
         if (m_queue.size() < bytes.size()) {
@@ -96,6 +124,8 @@ public:
     bool unreliable_eof() const override { return eof(); }
     bool eof() const { return m_queue.size() == 0; }
 
+    size_t remaining_space() const { return Capacity - m_queue.size(); }
+
     size_t remaining_contigous_space() const
     {
         return min(Capacity - m_queue.size(), m_queue.capacity() - (m_queue.head_index() + m_queue.size()) % Capacity);
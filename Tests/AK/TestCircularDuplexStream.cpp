@@ -61,3 +61,28 @@ TEST_CASE(overwritting_is_well_defined)
 
     EXPECT(stream.eof());
 }
+
+TEST_CASE(copy_from_seekback_repeats_overlapping_bytes)
+{
+    constexpr size_t capacity = 16;
+
+    CircularDuplexStream<capacity> stream;
+
+    // Move the end of the stream close to the end of the storage, so that the copy has to wrap around it
+    Array<u8, 12> padding {};
+    stream << padding;
+    stream >> padding;
+
+    stream << static_cast<u8>(1) << static_cast<u8>(2) << static_cast<u8>(3);
+    EXPECT(stream.copy_from_seekback(3, 7));
+
+    Array<u8, 10> buffer;
+    stream >> buffer;
+
+    Array<u8, 10> expected { 1, 2, 3, 1, 2, 3, 1, 2, 3, 1 };
+    EXPECT_EQ(buffer, expected);
+    EXPECT(stream.eof());
+
+    EXPECT(!stream.copy_from_seekback(capacity + 1, 1));
+    EXPECT(stream.handle_any_error());
+}
@@ -147,6 +147,22 @@ TEST_CASE(deflate_round_trip_compress_large)
     EXPECT(uncompressed.value() == original);
 }
 
+TEST_CASE(deflate_round_trip_compress_parallel)
+{
+    // Enough for more than one batch of chunks on two threads, so that chunks are primed with the end of both their own batch and the previous one
+    auto size = Compress::ParallelDeflateCompressor::chunk_size * 5 + 1234;
+    auto original = ByteBuffer::create_uninitialized(size);
+    fill_with_random(original.data(), 4096);
+    for (size_t i = 4096; i < size; i += 4096) // repeat the random data so that chunks have something to find in their dictionary
+        original.bytes().slice(0, min<size_t>(4096, size - i)).copy_to(original.bytes().slice(i));
+    auto compressed = Compress::ParallelDeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST, 2);
+    EXPECT(compressed.has_value());
+    EXPECT(compressed.value().size() < size / 10);
+    auto uncompressed = Compress::DeflateDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
+
 TEST_CASE(deflate_compress_literals)
 {
     // This byte array is known to not produce any back references with our lz77 implementation even at the highest compression settings
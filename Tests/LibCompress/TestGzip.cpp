@@ -95,3 +95,15 @@ TEST_CASE(gzip_round_trip)
     EXPECT(uncompressed.has_value());
     EXPECT(uncompressed.value() == original);
 }
+
+TEST_CASE(gzip_round_trip_parallel)
+{
+    auto size = Compress::ParallelDeflateCompressor::chunk_size * 3 + 1234;
+    auto original = ByteBuffer::create_uninitialized(size);
+    fill_with_random(original.data(), size);
+    auto compressed = Compress::GzipCompressor::compress_all(original, 2);
+    EXPECT(compressed.has_value());
+    auto uncompressed = Compress::GzipDecompressor::decompress_all(compressed.value());
+    EXPECT(uncompressed.has_value());
+    EXPECT(uncompressed.value() == original);
+}
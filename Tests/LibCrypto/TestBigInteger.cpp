@@ -201,6 +201,104 @@ TEST_CASE(test_unsigned_bigint_multiplication_with_big_numbers2)
     EXPECT_EQ(result.words(), expected_result);
 }
 
+// Deterministic operands with every word in use, so that the products have as many carries as random data does.
+static Crypto::UnsignedBigInteger bigint_with_words(size_t length, u32 seed)
+{
+    Vector<u8> bytes;
+    u32 state = seed;
+    for (size_t i = 0; i < length * sizeof(u32); ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        bytes.append(static_cast<u8>(state) | 1);
+    }
+    return Crypto::UnsignedBigInteger::import_data(bytes.data(), bytes.size());
+}
+
+static Crypto::UnsignedBigInteger bigint_with_all_bits_set(size_t length)
+{
+    Vector<u8> bytes;
+    bytes.resize(length * sizeof(u32));
+    memset(bytes.data(), 0xff, bytes.size());
+    return Crypto::UnsignedBigInteger::import_data(bytes.data(), bytes.size());
+}
+
+// The plain quadratic algorithm, to check the multiplication of operands that are long enough for Karatsuba against.
+static Vector<u32> schoolbook_product(Crypto::UnsignedBigInteger const& left, Crypto::UnsignedBigInteger const& right)
+{
+    auto left_length = left.trimmed_length();
+    auto right_length = right.trimmed_length();
+    Vector<u32> product;
+    product.resize(left_length + right_length);
+    for (size_t i = 0; i < left_length; ++i) {
+        u64 carry = 0;
+        for (size_t j = 0; j < right_length; ++j) {
+            u64 word = static_cast<u64>(left.words()[i]) * right.words()[j] + product[i + j] + carry;
+            product[i + j] = static_cast<u32>(word);
+            carry = word >> 32;
+        }
+        product[i + right_length] = static_cast<u32>(carry);
+    }
+    while (!product.is_empty() && product.last() == 0)
+        product.take_last();
+    return product;
+}
+
+static void expect_product_matches_schoolbook(size_t left_length, size_t right_length)
+{
+    auto left = bigint_with_words(left_length, 0x9e3779b9 ^ left_length);
+    auto right = bigint_with_words(right_length, 0x85ebca6b ^ right_length);
+    Vector<u32> expected_result = schoolbook_product(left, right);
+    EXPECT_EQ(left.multiplied_by(right).words(), expected_result);
+    EXPECT_EQ(right.multiplied_by(left).words(), expected_result);
+}
+
+TEST_CASE(test_unsigned_bigint_multiplication_around_karatsuba_threshold)
+{
+    // Karatsuba takes over at 48 words.
+    for (size_t length = 46; length <= 50; ++length)
+        expect_product_matches_schoolbook(length, length);
+    expect_product_matches_schoolbook(47, 48);
+    expect_product_matches_schoolbook(48, 49);
+    expect_product_matches_schoolbook(95, 96);
+    expect_product_matches_schoolbook(96, 97);
+}
+
+TEST_CASE(test_unsigned_bigint_multiplication_well_above_karatsuba_threshold)
+{
+    expect_product_matches_schoolbook(200, 200);
+    expect_product_matches_schoolbook(385, 385);
+    expect_product_matches_schoolbook(1000, 999);
+}
+
+TEST_CASE(test_unsigned_bigint_multiplication_with_uneven_lengths)
+{
+    expect_product_matches_schoolbook(1000, 1);
+    expect_product_matches_schoolbook(1000, 47);
+    expect_product_matches_schoolbook(1000, 48);
+    expect_product_matches_schoolbook(1000, 49);
+    expect_product_matches_schoolbook(960, 48);
+    // The last slice is shorter than the short operand, and then gets sliced up itself.
+    expect_product_matches_schoolbook(1000, 131);
+    expect_product_matches_schoolbook(2000, 700);
+}
+
+TEST_CASE(test_unsigned_bigint_multiplication_with_all_bits_set)
+{
+    // (2^a - 1) * (2^b - 1) = 2^(a + b) - 2^a - 2^b + 1, which carries through every word.
+    auto check = [](size_t left_length, size_t right_length) {
+        auto left = bigint_with_all_bits_set(left_length);
+        auto right = bigint_with_all_bits_set(right_length);
+        Vector<u32> expected_result = schoolbook_product(left, right);
+        EXPECT_EQ(left.multiplied_by(right).words(), expected_result);
+    };
+    check(48, 48);
+    check(49, 49);
+    check(97, 97);
+    check(300, 48);
+    check(300, 100);
+}
+
 TEST_CASE(test_unsigned_bigint_simple_division)
 {
     Crypto::UnsignedBigInteger num1(27194);
@@ -253,6 +351,24 @@ TEST_CASE(test_bigint_modular_inverse)
     EXPECT_EQ(result, 25);
 }
 
+TEST_CASE(test_bigint_modular_inverse_of_unreduced_value)
+{
+    auto result = Crypto::NumberTheory::ModularInverse(94, 87);
+    EXPECT_EQ(result, 25);
+}
+
+TEST_CASE(test_bigint_modular_inverse_with_even_modulus)
+{
+    auto result = Crypto::NumberTheory::ModularInverse(17, 3120);
+    EXPECT_EQ(result, 2753);
+}
+
+TEST_CASE(test_bigint_modular_inverse_with_multi_word_intermediates)
+{
+    auto result = Crypto::NumberTheory::ModularInverse(45377336, 666506809);
+    EXPECT_EQ(result, 353637005);
+}
+
 TEST_CASE(test_bigint_even_simple_modular_power)
 {
     Crypto::UnsignedBigInteger base { 7 };
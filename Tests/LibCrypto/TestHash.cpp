@@ -6,6 +6,7 @@
 
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/Authentication/HMAC.h>
+#include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/Hash/MD5.h>
 #include <LibCrypto/Hash/SHA1.h>
 #include <LibCrypto/Hash/SHA2.h>
@@ -166,6 +167,18 @@ TEST_CASE(test_SHA256_hash_empty_string)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
 }
 
+TEST_CASE(test_hash_manager_peek_does_not_disturb_hash)
+{
+    auto hasher = make<Crypto::Hash::Manager>(Crypto::Hash::HashKind::SHA256);
+    hasher->update("Well hello ");
+    auto peeked = hasher->peek();
+    EXPECT(memcmp(peeked.immutable_data(), Crypto::Hash::SHA256::hash("Well hello ").data, Crypto::Hash::SHA256::digest_size()) == 0);
+
+    hasher->update("friends");
+    auto digest = hasher->digest();
+    EXPECT(memcmp(digest.immutable_data(), Crypto::Hash::SHA256::hash("Well hello friends").data, Crypto::Hash::SHA256::digest_size()) == 0);
+}
+
 TEST_CASE(test_SHA384_name)
 {
     Crypto::Hash::SHA384 sha;
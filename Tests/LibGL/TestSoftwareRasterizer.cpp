@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/Random.h>
+#include <LibGL/SoftwareRasterizer.h>
+
+// Large enough for a few rows and columns of tiles, with partial tiles at the right and bottom edges.
+static Gfx::IntSize const framebuffer_size { 200, 150 };
+static FloatVector4 const clear_color { 0.25f, 0.5f, 0.75f, 1.0f };
+
+static float random_float()
+{
+    return get_random<u32>() / static_cast<float>(NumericLimits<u32>::max());
+}
+
+static GL::GLTriangle random_triangle()
+{
+    GL::GLTriangle triangle;
+    // Some triangles are much larger than a tile, some poke out of the framebuffer.
+    float size = get_random_uniform(4) == 0 ? 400 : 60;
+    float center_x = random_float() * (framebuffer_size.width() + 100) - 50;
+    float center_y = random_float() * (framebuffer_size.height() + 100) - 50;
+    for (auto& vertex : triangle.vertices) {
+        vertex.x = center_x + (random_float() - 0.5f) * size;
+        vertex.y = center_y + (random_float() - 0.5f) * size;
+        vertex.z = random_float();
+        vertex.w = 1.0f;
+        vertex.r = random_float();
+        vertex.g = random_float();
+        vertex.b = random_float();
+        vertex.a = random_float();
+    }
+    return triangle;
+}
+
+static GL::GLTriangle triangle(float x0, float y0, float x1, float y1, float x2, float y2, FloatVector4 color)
+{
+    GL::GLTriangle triangle;
+    float coordinates[3][2] = { { x0, y0 }, { x1, y1 }, { x2, y2 } };
+    for (size_t i = 0; i < 3; ++i) {
+        auto& vertex = triangle.vertices[i];
+        vertex.x = coordinates[i][0];
+        vertex.y = coordinates[i][1];
+        vertex.z = 0.5f;
+        vertex.w = 1.0f;
+        vertex.r = color.x();
+        vertex.g = color.y();
+        vertex.b = color.z();
+        vertex.a = color.w();
+    }
+    return triangle;
+}
+
+static void expect_same_output(GL::SoftwareRasterizer& a, GL::SoftwareRasterizer& b)
+{
+    size_t mismatches = 0;
+    for (int y = 0; y < framebuffer_size.height(); ++y) {
+        for (int x = 0; x < framebuffer_size.width(); ++x) {
+            if (a.get_backbuffer_pixel(x, y) != b.get_backbuffer_pixel(x, y) || a.get_depthbuffer_value(x, y) != b.get_depthbuffer_value(x, y))
+                ++mismatches;
+        }
+    }
+    EXPECT_EQ(mismatches, 0u);
+}
+
+TEST_CASE(threaded_tiles_match_serial_rendering)
+{
+    GL::SoftwareRasterizer serial(framebuffer_size, 0);
+    GL::SoftwareRasterizer threaded(framebuffer_size, 3);
+
+    auto for_both = [&](auto callback) {
+        callback(serial);
+        callback(threaded);
+    };
+
+    for (size_t frame = 0; frame < 3; ++frame) {
+        for_both([](auto& rasterizer) {
+            rasterizer.clear_color(clear_color);
+            rasterizer.clear_depth(1.0f);
+        });
+
+        for (size_t i = 0; i < 300; ++i) {
+            // State changes and clears in between draws end up in the middle of the tile bins.
+            if (i % 50 == 0) {
+                GL::RasterizerOptions options;
+                options.shade_smooth = i % 100 == 0;
+                options.enable_depth_test = i % 150 != 0;
+                options.enable_blending = i % 100 == 50;
+                options.blend_source_factor = GL_SRC_ALPHA;
+                options.blend_destination_factor = GL_ONE_MINUS_SRC_ALPHA;
+                for_both([&](auto& rasterizer) { rasterizer.set_options(options); });
+            }
+            if (i == 200) {
+                auto depth = random_float();
+                for_both([&](auto& rasterizer) { rasterizer.clear_depth(depth); });
+            }
+
+            auto triangle = random_triangle();
+            for_both([&](auto& rasterizer) { rasterizer.submit_triangle(triangle); });
+        }
+
+        expect_same_output(serial, threaded);
+    }
+}
+
+TEST_CASE(triangles_across_tile_borders)
+{
+    GL::SoftwareRasterizer rasterizer(framebuffer_size, 3);
+    rasterizer.clear_color(clear_color);
+    rasterizer.clear_depth(1.0f);
+
+    // A square of two triangles that straddles the corner of four tiles.
+    FloatVector4 white { 1, 1, 1, 1 };
+    rasterizer.submit_triangle(triangle(40, 40, 90, 90, 90, 40, white));
+    rasterizer.submit_triangle(triangle(40, 40, 40, 90, 90, 90, white));
+
+    auto white_pixel = rasterizer.get_backbuffer_pixel(65, 65);
+    auto clear_pixel = rasterizer.get_backbuffer_pixel(0, 0);
+    EXPECT_NE(white_pixel, clear_pixel);
+
+    size_t mismatches = 0;
+    for (int y = 0; y < framebuffer_size.height(); ++y) {
+        for (int x = 0; x < framebuffer_size.width(); ++x) {
+            // Leave the pixels right on the edges to the fill convention.
+            if (x == 40 || x == 90 || y == 40 || y == 90)
+                continue;
+            bool inside = x > 40 && x < 90 && y > 40 && y < 90;
+            if (rasterizer.get_backbuffer_pixel(x, y) != (inside ? white_pixel : clear_pixel))
+                ++mismatches;
+        }
+    }
+    EXPECT_EQ(mismatches, 0u);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+
+static constexpr auto dispatch_heavy_source = R"~~~(
+    var sum = 0;
+    for (var i = 0; i < 200000; ++i) {
+        var x = i * 3;
+        if (x % 2 === 0)
+            sum = sum + (x >> 1);
+        else
+            sum = sum - (x & 7);
+    }
+)~~~"sv;
+
+static void run_with_dispatch_mode(JS::Bytecode::Interpreter::DispatchMode dispatch_mode)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+
+    auto parser = JS::Parser(JS::Lexer(dispatch_heavy_source));
+    auto program = parser.parse_program();
+    EXPECT(!parser.has_errors());
+
+    auto executable = JS::Bytecode::Generator::generate(*program);
+    JS::Bytecode::Interpreter bytecode_interpreter(interpreter->global_object());
+    bytecode_interpreter.set_dispatch_mode(dispatch_mode);
+    bytecode_interpreter.run(executable);
+    EXPECT(!vm->exception());
+}
+
+BENCHMARK_CASE(switch_dispatch)
+{
+    run_with_dispatch_mode(JS::Bytecode::Interpreter::DispatchMode::Switch);
+}
+
+#if JS_BYTECODE_HAS_THREADED_DISPATCH
+BENCHMARK_CASE(threaded_dispatch)
+{
+    run_with_dispatch_mode(JS::Bytecode::Interpreter::DispatchMode::Threaded);
+}
+#endif
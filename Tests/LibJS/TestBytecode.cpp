@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Bytecode/Generator.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/PassManager.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/OrdinaryFunctionObject.h>
+
+using InstructionCounts = HashMap<UnderlyingType<JS::Bytecode::Instruction::Type>, size_t>;
+
+enum class FoldConstants {
+    No,
+    Yes,
+};
+
+// Everything a bytecode run leaves behind, so that its globals, the executables of its functions
+// and the instructions that were generated for it can be looked at.
+struct Run {
+    NonnullRefPtr<JS::VM> vm;
+    NonnullOwnPtr<JS::Interpreter> interpreter;
+    NonnullRefPtr<JS::Program> program;
+    InstructionCounts instruction_counts;
+
+    JS::Value get(char const* name) { return interpreter->global_object().get(name); }
+    JS::Value result() { return get("result"); }
+    JS::OrdinaryFunctionObject& function(char const* name) { return verify_cast<JS::OrdinaryFunctionObject>(get(name).as_object()); }
+    size_t count(JS::Bytecode::Instruction::Type type) const { return instruction_counts.get(to_underlying(type)).value_or(0); }
+};
+
+// Runs the top level of the source through the bytecode interpreter, optionally folding its constants first.
+static Run run_bytecode(StringView source, FoldConstants fold_constants = FoldConstants::No)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+
+    auto parser = JS::Parser(JS::Lexer(source));
+    auto program = parser.parse_program();
+    EXPECT(!parser.has_errors());
+
+    auto executable = JS::Bytecode::Generator::generate(*program);
+    if (fold_constants == FoldConstants::Yes) {
+        JS::Bytecode::PassManager passes;
+        passes.add<JS::Bytecode::Passes::FoldConstants>();
+        passes.perform(executable);
+    }
+
+    InstructionCounts instruction_counts;
+    for (auto& block : executable.basic_blocks) {
+        JS::Bytecode::InstructionStreamIterator it { block.instruction_stream() };
+        while (!it.at_end()) {
+            instruction_counts.ensure(to_underlying((*it).type()))++;
+            ++it;
+        }
+    }
+
+    JS::Bytecode::Interpreter bytecode_interpreter(interpreter->global_object());
+    bytecode_interpreter.run(executable);
+    EXPECT(!vm->exception());
+    vm->clear_exception();
+
+    return { move(vm), move(interpreter), move(program), move(instruction_counts) };
+}
+
+// Folding must never change what the program computes.
+static Run expect_same_result_with_and_without_folding(StringView source, JS::Value expected)
+{
+    EXPECT_EQ(run_bytecode(source).result(), expected);
+    auto folded = run_bytecode(source, FoldConstants::Yes);
+    EXPECT_EQ(folded.result(), expected);
+    return folded;
+}
+
+// Constant folding
+
+TEST_CASE(folds_arithmetic_on_number_literals)
+{
+    auto run = expect_same_result_with_and_without_folding("result = 1 + 2 * 3;"sv, JS::Value(7));
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Add), 0u);
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Mul), 0u);
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Store), 0u);
+}
+
+TEST_CASE(folds_nested_expressions_and_unary_operators)
+{
+    auto run = expect_same_result_with_and_without_folding("result = -((1 + 2) * (3 - 4)) / 2;"sv, JS::Value(1.5));
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Add), 0u);
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Sub), 0u);
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Mul), 0u);
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Div), 0u);
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::UnaryMinus), 0u);
+}
+
+TEST_CASE(folds_comparisons)
+{
+    auto run = expect_same_result_with_and_without_folding("result = 1 < 2 === 3 >= 4;"sv, JS::Value(false));
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::LessThan), 0u);
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::GreaterThanEquals), 0u);
+}
+
+TEST_CASE(does_not_fold_operations_on_other_types)
+{
+    auto run = expect_same_result_with_and_without_folding("result = 1 + 2 + 'a' === '3a';"sv, JS::Value(true));
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Add), 1u);
+}
+
+TEST_CASE(does_not_fold_bitwise_operations_on_doubles)
+{
+    auto run = expect_same_result_with_and_without_folding("result = (1.5 | 2) + (6 & 3);"sv, JS::Value(5));
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::BitwiseOr), 1u);
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::BitwiseAnd), 0u);
+}
+
+TEST_CASE(does_not_fold_operations_on_variables)
+{
+    auto run = expect_same_result_with_and_without_folding(R"(
+        var x = 2;
+        var y = 3;
+        result = (1 + 2) * x + (5 - 1) * y;
+    )"sv,
+        JS::Value(18));
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Mul), 2u);
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Add), 1u);
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::Sub), 0u);
+}
+
+TEST_CASE(reused_registers_are_written_before_they_are_read)
+{
+    // The temporaries of the folded operations are handed out again to the expressions after them,
+    // and the switch discriminant is compared against folded values.
+    auto run = expect_same_result_with_and_without_folding(R"(
+        var a = 2;
+        var b = 10;
+        var x = (1 + 2) + a;
+        var y = (3 + 4) * b;
+        switch (x) {
+        case 1 + 1:
+            result = -1;
+            break;
+        case 2 + 3:
+            result = x * 100 + y;
+            break;
+        }
+    )"sv,
+        JS::Value(570));
+    EXPECT_EQ(run.count(JS::Bytecode::Instruction::Type::TypedEquals), 2u);
+}
+
+// Block-scoped locals in registers
+
+TEST_CASE(block_let_shadows_outer_let)
+{
+    auto run = run_bytecode(R"(
+        function f() {
+            let x = 1;
+            { let x = 2; }
+            return x;
+        }
+        result = f();
+    )"sv);
+    EXPECT_EQ(run.result(), JS::Value(1));
+}
+
+TEST_CASE(assignment_in_block_goes_to_shadowing_let)
+{
+    auto run = run_bytecode(R"(
+        function f() {
+            let x = 1;
+            let inner;
+            { let x; x = 2; inner = x; }
+            return inner * 10 + x;
+        }
+        result = f();
+    )"sv);
+    EXPECT_EQ(run.result(), JS::Value(21));
+}
+
+TEST_CASE(loop_body_let_shadows_parameter)
+{
+    auto run = run_bytecode(R"(
+        function f(a) {
+            for (let i = 0; i < 3; i++) { let a = i; }
+            return a;
+        }
+        result = f(5);
+    )"sv);
+    EXPECT_EQ(run.result(), JS::Value(5));
+}
+
+TEST_CASE(loop_head_let_shadows_parameter)
+{
+    auto run = run_bytecode(R"(
+        function f(i) {
+            let sum = 0;
+            for (let i = 0; i < 3; i++) sum += i;
+            return sum * 10 + i;
+        }
+        result = f(7);
+    )"sv);
+    EXPECT_EQ(run.result(), JS::Value(37));
+}
+
+TEST_CASE(nested_blocks_shadow_each_other)
+{
+    auto run = run_bytecode(R"(
+        function f() {
+            let x = 1;
+            let seen = 0;
+            {
+                let x = 2;
+                seen = x;
+                { let x = 3; seen = seen * 10 + x; }
+            }
+            return seen * 10 + x;
+        }
+        result = f();
+    )"sv);
+    EXPECT_EQ(run.result(), JS::Value(231));
+}
+
+TEST_CASE(locals_survive_garbage_collection)
+{
+    auto run = run_bytecode(R"(
+        function f() {
+            let o = { a: [1, 2, 3] };
+            gc();
+            return o.a.length;
+        }
+        result = f();
+    )"sv);
+    EXPECT_EQ(run.result(), JS::Value(3));
+}
+
+TEST_CASE(temporaries_survive_garbage_collection)
+{
+    auto run = run_bytecode(R"(
+        function f() {
+            return [1, 2].concat((gc(), [3])).length;
+        }
+        result = f();
+    )"sv);
+    EXPECT_EQ(run.result(), JS::Value(3));
+}
+
+// Register windows
+
+TEST_CASE(deep_recursion_crosses_register_stack_chunks)
+{
+    // With a register for each of the 16 locals, a few hundred frames need several register stack
+    // chunks, and returning through them must give every frame its own registers back. The recursion
+    // is run twice so that the second one reuses the chunks the first one left behind.
+    auto run = run_bytecode(R"(
+        function sum(n) {
+            let a = n, b = n + 1, c = n + 2, d = n + 3, e = n + 4, f = n + 5, g = n + 6, h = n + 7;
+            let i = n + 8, j = n + 9, k = n + 10, l = n + 11, m = n + 12, o = n + 13, p = n + 14, q = n + 15;
+            if (n === 0)
+                return 0;
+            let rest = sum(n - 1);
+            return rest + a + b + c + d + e + f + g + h + i + j + k + l + m + o + p + q;
+        }
+        result = sum(400) === 1331200 && sum(400) === 1331200;
+    )"sv);
+    EXPECT_EQ(run.result(), JS::Value(true));
+}
+
+TEST_CASE(garbage_collection_during_deep_recursion)
+{
+    // The objects are only held in the registers of frames that live in older chunks than the one
+    // that is running when the collections happen.
+    auto run = run_bytecode(R"(
+        function sum(n) {
+            let a = { n }, b = { n }, c = { n }, d = { n }, e = { n }, f = { n }, g = { n }, h = { n };
+            let i = { n }, j = { n }, k = { n }, l = { n }, m = { n }, o = { n }, p = { n }, q = { n };
+            if (n === 0) {
+                gc();
+                return 0;
+            }
+            if (n === 200)
+                gc();
+            let rest = sum(n - 1);
+            return rest + a.n + b.n + c.n + d.n + e.n + f.n + g.n + h.n + i.n + j.n + k.n + l.n + m.n + o.n + p.n + q.n;
+        }
+        result = sum(400);
+    )"sv);
+    EXPECT_EQ(run.result(), JS::Value(1283200));
+}
+
+// Function executables
+
+TEST_CASE(functions_are_compiled_on_first_call)
+{
+    auto run = run_bytecode(R"(
+        function called() { return 1; }
+        function not_called() { return 2; }
+        called();
+    )"sv);
+
+    EXPECT_NE(run.function("called").bytecode_executable(), nullptr);
+    EXPECT_EQ(run.function("not_called").bytecode_executable(), nullptr);
+}
+
+TEST_CASE(closures_share_the_executable_of_their_body)
+{
+    auto run = run_bytecode(R"(
+        function make_counter(start) {
+            let count = start;
+            return function() { return ++count; };
+        }
+        a = make_counter(10);
+        b = make_counter(20);
+        a();
+        b();
+        result = a() * 100 + b();
+    )"sv);
+
+    // The shared bytecode must still see the environment of the closure it runs for.
+    EXPECT_EQ(run.get("result"), JS::Value(1222));
+
+    auto* executable = run.function("a").bytecode_executable();
+    EXPECT_NE(executable, nullptr);
+    EXPECT_EQ(run.function("b").bytecode_executable(), executable);
+}
+
+TEST_CASE(closures_share_the_executable_when_created_after_the_first_call)
+{
+    auto run = run_bytecode(R"(
+        function make() { return function() { return 1; }; }
+        a = make();
+        a();
+        b = make();
+        b();
+    )"sv);
+
+    auto* executable = run.function("a").bytecode_executable();
+    EXPECT_NE(executable, nullptr);
+    EXPECT_EQ(run.function("b").bytecode_executable(), executable);
+}
+
+TEST_CASE(different_bodies_have_different_executables)
+{
+    auto run = run_bytecode(R"(
+        a = function() { return 1; };
+        b = function() { return 1; };
+        result = a() + b();
+    )"sv);
+
+    EXPECT_EQ(run.get("result"), JS::Value(2));
+    EXPECT_NE(run.function("a").bytecode_executable(), nullptr);
+    EXPECT_NE(run.function("a").bytecode_executable(), run.function("b").bytecode_executable());
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibJS/Heap/Heap.h>
+#include <LibJS/Heap/HeapBlock.h>
+#include <LibJS/Interpreter.h>
+#include <LibJS/Lexer.h>
+#include <LibJS/Parser.h>
+#include <LibJS/Runtime/GlobalObject.h>
+#include <LibJS/Runtime/WeakRef.h>
+#include <LibJS/Runtime/WeakSet.h>
+
+static void run_source(JS::Interpreter& interpreter, StringView source)
+{
+    auto parser = JS::Parser(JS::Lexer(source));
+    auto program = parser.parse_program();
+    EXPECT(!parser.has_errors());
+
+    interpreter.run(interpreter.global_object(), *program);
+    EXPECT(!interpreter.vm().exception());
+}
+
+TEST_CASE(allocation_budget_grows_with_live_heap)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto& heap = vm->heap();
+
+    heap.collect_garbage();
+    EXPECT_EQ(heap.max_allocations_between_gc(), JS::Heap::min_allocations_between_gc);
+
+    run_source(*interpreter, "globalThis.kept = []; for (let i = 0; i < 50000; ++i) kept.push({ i });"sv);
+    heap.collect_garbage();
+    EXPECT(heap.max_allocations_between_gc() >= 50000u);
+
+    run_source(*interpreter, "globalThis.kept = null;"sv);
+    heap.collect_garbage();
+    EXPECT_EQ(heap.max_allocations_between_gc(), JS::Heap::min_allocations_between_gc);
+}
+
+TEST_CASE(allocation_budget_survives_collections_triggered_by_allocation)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto& heap = vm->heap();
+
+    // Every collection in here is triggered by running out of budget, and each of them has to
+    // find the whole live array again.
+    run_source(*interpreter, R"(
+        globalThis.kept = [];
+        for (let i = 0; i < 50000; ++i) kept.push({ i });
+        for (let i = 0; i < 200000; ++i) ({ i });
+    )"sv);
+    EXPECT(heap.max_allocations_between_gc() >= 50000u);
+
+    run_source(*interpreter, "if (kept.length !== 50000 || kept[49999].i !== 49999) throw new Error();"sv);
+}
+
+TEST_CASE(cleared_weak_refs_do_not_hide_other_weak_containers)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto& heap = vm->heap();
+
+    // The WeakRef lets go of its target once the script is done, and drops out of the list of
+    // weak containers while the heap is going through it. The WeakSet comes after it in that list.
+    run_source(*interpreter, R"(
+        globalThis.ref = new WeakRef({});
+        globalThis.set = new WeakSet();
+        (function () {
+            for (let i = 0; i < 100; ++i) set.add({});
+        })();
+    )"sv);
+    heap.collect_garbage();
+
+    auto& global_object = interpreter->global_object();
+    EXPECT(verify_cast<JS::WeakRef>(global_object.get("ref").as_object()).value() == nullptr);
+    EXPECT_EQ(verify_cast<JS::WeakSet>(global_object.get("set").as_object()).values().size(), 0u);
+}
+
+TEST_CASE(pointers_into_the_middle_of_a_cell_find_that_cell)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+
+    run_source(*interpreter, "globalThis.object = {};"sv);
+    auto& object = interpreter->global_object().get("object").as_object();
+    auto* block = JS::HeapBlock::from_cell(&object);
+    auto address = reinterpret_cast<FlatPtr>(&object);
+
+    EXPECT_EQ(block->cell_from_possible_pointer(address), &object);
+    EXPECT_EQ(block->cell_from_possible_pointer(address + sizeof(FlatPtr)), &object);
+    EXPECT_EQ(block->cell_from_possible_pointer(address + block->cell_size() - 1), &object);
+    EXPECT_NE(block->cell_from_possible_pointer(address + block->cell_size()), &object);
+}
+
+static NEVER_INLINE FlatPtr interior_pointer_to_global(JS::Interpreter& interpreter, char const* name)
+{
+    auto& cell = interpreter.global_object().get(name).as_object();
+    return reinterpret_cast<FlatPtr>(&cell) + sizeof(FlatPtr);
+}
+
+TEST_CASE(interior_pointers_on_the_stack_keep_cells_alive)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+    auto& heap = vm->heap();
+
+    // The WeakSet tells us whether the object survived, once nothing but the stack points at it.
+    run_source(*interpreter, "globalThis.object = {}; globalThis.set = new WeakSet(); set.add(object);"sv);
+    volatile FlatPtr interior_pointer = interior_pointer_to_global(*interpreter, "object");
+    run_source(*interpreter, "delete globalThis.object;"sv);
+    heap.collect_garbage();
+
+    EXPECT_EQ(verify_cast<JS::WeakSet>(interpreter->global_object().get("set").as_object()).values().size(), 1u);
+    (void)interior_pointer;
+}
+
+BENCHMARK_CASE(allocate_temporaries_with_large_live_heap)
+{
+    auto vm = JS::VM::create();
+    auto interpreter = JS::Interpreter::create<JS::GlobalObject>(*vm);
+
+    run_source(*interpreter, R"(
+        globalThis.kept = [];
+        for (let i = 0; i < 200000; ++i) kept.push({ i });
+        for (let i = 0; i < 1000000; ++i) ({ i });
+    )"sv);
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <AK/BitCast.h>
+#include <LibJS/Runtime/IndexedProperties.h>
+
+// The bit pattern double storage reserves for holes.
+static constexpr u64 hole_bits = 0x7ff4'dead'0000'0001;
+
+TEST_CASE(initial_nans_are_not_mistaken_for_holes)
+{
+    auto nan_with_hole_bits = JS::Value(bit_cast<double>(hole_bits));
+    JS::IndexedProperties properties({ nan_with_hole_bits, JS::Value(1.5), {} });
+
+    EXPECT_EQ(properties.array_like_size(), 3u);
+    EXPECT(properties.has_index(0));
+    EXPECT(properties.get(0)->value.is_nan());
+    EXPECT_EQ(properties.get(1)->value, JS::Value(1.5));
+    EXPECT(!properties.has_index(2));
+}
+
+TEST_CASE(stored_nans_are_not_mistaken_for_holes)
+{
+    JS::IndexedProperties properties({ JS::Value(1.5), JS::Value(2.5) });
+    properties.put(1, JS::Value(bit_cast<double>(hole_bits)));
+
+    EXPECT(properties.has_index(1));
+    EXPECT(properties.get(1)->value.is_nan());
+}
@@ -768,8 +768,87 @@ TEST_CASE(extremely_long_fork_chain)
     EXPECT_EQ(result.success, true);
 }
 
+TEST_CASE(nested_quantifiers_do_not_backtrack_exponentially)
+{
+    {
+        Regex<ECMA262> re("(a+)+b");
+        auto result = re.match(String::repeated('a', 5'000));
+        EXPECT_EQ(result.success, false);
+    }
+    {
+        Regex<ECMA262> re("^(\\w+\\s?)*$");
+        auto result = re.match(String::formatted("{}!", String::repeated("abc ", 1'000)));
+        EXPECT_EQ(result.success, false);
+    }
+    {
+        Regex<PosixExtended> re("(a|aa)+c", PosixFlags::Global);
+        auto subject = String::formatted("{}c{}c", String::repeated('a', 2'000), String::repeated('a', 3));
+        auto result = re.match(subject);
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.count, 2u);
+        EXPECT_EQ(result.matches.at(0).view.length(), 2'001u);
+        EXPECT_EQ(result.matches.at(1).view, "aaac");
+        EXPECT_EQ(result.capture_group_matches.at(1).at(0).view, "a");
+    }
+}
+
+TEST_CASE(search_skips_to_possible_match_starts)
+{
+    {
+        Regex<ECMA262> re("needle[0-9]+");
+        RegexResult result;
+        auto haystack = String::formatted("{}needle{}needle42", String::repeated("hay ", 100), String::repeated("hay ", 100));
+        EXPECT_EQ(re.search(haystack.view(), result), true);
+        EXPECT_EQ(result.count, 1u);
+        EXPECT_EQ(result.matches.at(0).view, "needle42");
+        EXPECT_EQ(result.matches.at(0).column, 806u);
+    }
+    {
+        Regex<PosixExtended> re("(cat|dog|[x-z]+)s");
+        RegexResult result;
+        EXPECT_EQ(re.search("a dog; cats and zzs, DOGS", result), true);
+        EXPECT_EQ(result.count, 2u);
+        EXPECT_EQ(result.matches.at(0).view, "cats");
+        EXPECT_EQ(result.matches.at(1).view, "zzs");
+        EXPECT_EQ(re.search("a dog; cats and zzs, DOGS", result, PosixFlags::Insensitive), true);
+        EXPECT_EQ(result.count, 3u);
+        EXPECT_EQ(result.matches.at(2).view, "DOGS");
+    }
+    {
+        Regex<PosixExtended> re("^abc");
+        RegexResult result;
+        EXPECT_EQ(re.search("xabc abc", result), false);
+        EXPECT_EQ(re.search("abc abc", result), true);
+        EXPECT_EQ(result.count, 1u);
+    }
+    {
+        Regex<ECMA262> re("b+c");
+        Vector<u16> data;
+        for (auto ch : "aabbbcbc"sv)
+            data.append(ch);
+        auto result = re.search(Utf16View { data });
+        EXPECT_EQ(result.success, true);
+        EXPECT_EQ(result.matches.at(0).column, 2u);
+    }
+}
+
 static auto g_lots_of_a_s = String::repeated('a', 10'000'000);
 
+TEST_CASE(recompiled_patterns_match_the_same)
+{
+    auto match = [] {
+        // Named groups and references refer to the pattern's text, which must stay alive after the first instance is gone.
+        Regex<ECMA262> re(String::formatted("(?<{}>[a-z]+)-\\k<word>", "word"));
+        RegexResult result;
+        EXPECT_EQ(re.match("ab-ab", result), true);
+        EXPECT_EQ(result.count, 1u);
+        EXPECT_EQ(result.named_capture_group_matches.at(0).ensure("word").view, "ab");
+        EXPECT_EQ(re.match("ab-ba", result), false);
+    };
+    match();
+    match();
+}
+
 BENCHMARK_CASE(fork_performance)
 {
     Regex<ECMA262> re("(?:aa)*");
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCore/DateTime.h>
+#include <LibTLS/TLSv12.h>
+#include <LibTest/TestCase.h>
+#include <unistd.h>
+
+// Every test case uses hosts of its own, as they all share the process-wide cache.
+static TLS::Session make_session(u8 tag, time_t lifetime = 60)
+{
+    TLS::Session session;
+    session.cipher = TLS::CipherSuite::RSA_WITH_AES_128_GCM_SHA256;
+    memset(session.session_id, tag, sizeof(session.session_id));
+    session.session_id_size = sizeof(session.session_id);
+    session.master_key = ByteBuffer::create_zeroed(48);
+    session.master_key.bytes().fill(tag);
+    session.ticket = ByteBuffer::copy("ticket", 6);
+    session.expiry_timestamp = Core::DateTime::now().timestamp() + lifetime;
+    return session;
+}
+
+TEST_CASE(stored_sessions_are_found)
+{
+    auto& cache = TLS::SessionCache::the();
+    cache.store("stored.example", 443, make_session(1));
+
+    auto session = cache.find("stored.example", 443);
+    EXPECT(session.has_value());
+    EXPECT_EQ(session->cipher, TLS::CipherSuite::RSA_WITH_AES_128_GCM_SHA256);
+    EXPECT_EQ(session->session_id_size, 32);
+    EXPECT_EQ(session->session_id[31], 1);
+    EXPECT_EQ(session->master_key, make_session(1).master_key);
+    EXPECT_EQ(session->ticket, ByteBuffer::copy("ticket", 6));
+}
+
+TEST_CASE(storing_a_session_again_replaces_it)
+{
+    auto& cache = TLS::SessionCache::the();
+    cache.store("replaced.example", 443, make_session(1));
+    cache.store("replaced.example", 443, make_session(2));
+
+    auto session = cache.find("replaced.example", 443);
+    EXPECT(session.has_value());
+    EXPECT_EQ(session->master_key, make_session(2).master_key);
+}
+
+TEST_CASE(sessions_are_keyed_by_host_and_port)
+{
+    auto& cache = TLS::SessionCache::the();
+    cache.store("keyed.example", 443, make_session(1));
+    cache.store("keyed.example", 8443, make_session(2));
+
+    EXPECT_EQ(cache.find("keyed.example", 443)->master_key, make_session(1).master_key);
+    EXPECT_EQ(cache.find("keyed.example", 8443)->master_key, make_session(2).master_key);
+    EXPECT(!cache.find("keyed.example", 80).has_value());
+    EXPECT(!cache.find("other.keyed.example", 443).has_value());
+    // The host and port are kept apart in the key, so they can't run into each other.
+    EXPECT(!cache.find("keyed.example:44", 3).has_value());
+}
+
+TEST_CASE(removed_sessions_are_forgotten)
+{
+    auto& cache = TLS::SessionCache::the();
+    cache.store("removed.example", 443, make_session(1));
+    cache.store("removed.example", 8443, make_session(2));
+    cache.remove("removed.example", 443);
+
+    EXPECT(!cache.find("removed.example", 443).has_value());
+    EXPECT(cache.find("removed.example", 8443).has_value());
+
+    // Removing a session that isn't there is fine.
+    cache.remove("removed.example", 443);
+}
+
+TEST_CASE(expired_sessions_are_not_stored)
+{
+    auto& cache = TLS::SessionCache::the();
+    cache.store("expired.example", 443, make_session(1, 0));
+    EXPECT(!cache.find("expired.example", 443).has_value());
+}
+
+TEST_CASE(sessions_expire)
+{
+    auto& cache = TLS::SessionCache::the();
+    cache.store("expiring.example", 443, make_session(1, 1));
+    EXPECT(cache.find("expiring.example", 443).has_value());
+
+    sleep(2);
+    EXPECT(!cache.find("expiring.example", 443).has_value());
+}
+
+TEST_CASE(full_cache_makes_room_for_new_sessions)
+{
+    auto& cache = TLS::SessionCache::the();
+    for (size_t i = 0; i <= TLS::SessionCache::max_session_count; ++i)
+        cache.store(String::formatted("full{}.example", i), 443, make_session(1));
+
+    size_t found_sessions = 0;
+    for (size_t i = 0; i <= TLS::SessionCache::max_session_count; ++i) {
+        if (cache.find(String::formatted("full{}.example", i), 443).has_value())
+            ++found_sessions;
+    }
+    EXPECT(found_sessions < TLS::SessionCache::max_session_count + 1);
+    EXPECT(cache.find(String::formatted("full{}.example", TLS::SessionCache::max_session_count), 443).has_value());
+}
+
+TEST_CASE(parse_new_session_ticket)
+{
+    // length (3), lifetime hint (4), ticket length (2), ticket
+    u8 message[] = { 0x00, 0x00, 0x0a, 0x00, 0x00, 0x1c, 0x20, 0x00, 0x04, 0xde, 0xad, 0xbe, 0xef };
+    TLS::SessionTicket ticket;
+    EXPECT_EQ(TLS::TLSv12::parse_new_session_ticket({ message, sizeof(message) }, ticket), (ssize_t)sizeof(message));
+    EXPECT_EQ(ticket.lifetime_hint, 7200u);
+    u8 expected_ticket[] = { 0xde, 0xad, 0xbe, 0xef };
+    EXPECT_EQ(ticket.ticket, ByteBuffer::copy(expected_ticket, sizeof(expected_ticket)));
+}
+
+TEST_CASE(parse_new_session_ticket_without_ticket)
+{
+    // The server may change its mind and send an empty ticket instead.
+    u8 message[] = { 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    TLS::SessionTicket ticket { 3600, ByteBuffer::copy("stale", 5) };
+    EXPECT_EQ(TLS::TLSv12::parse_new_session_ticket({ message, sizeof(message) }, ticket), (ssize_t)sizeof(message));
+    EXPECT_EQ(ticket.lifetime_hint, 0u);
+    EXPECT(ticket.ticket.is_empty());
+}
+
+TEST_CASE(parse_truncated_new_session_ticket)
+{
+    u8 message[] = { 0x00, 0x00, 0x0a, 0x00, 0x00, 0x1c, 0x20, 0x00, 0x04, 0xde, 0xad, 0xbe, 0xef };
+    TLS::SessionTicket ticket;
+    EXPECT_EQ(TLS::TLSv12::parse_new_session_ticket({ message, 2 }, ticket), (i8)TLS::Error::NeedMoreData);
+    EXPECT_EQ(TLS::TLSv12::parse_new_session_ticket({ message, sizeof(message) - 1 }, ticket), (i8)TLS::Error::NeedMoreData);
+}
+
+TEST_CASE(parse_malformed_new_session_ticket)
+{
+    TLS::SessionTicket ticket;
+
+    // Too short to hold the lifetime hint and ticket length.
+    u8 too_short[] = { 0x00, 0x00, 0x05, 0x00, 0x00, 0x1c, 0x20, 0x00 };
+    EXPECT_EQ(TLS::TLSv12::parse_new_session_ticket({ too_short, sizeof(too_short) }, ticket), (i8)TLS::Error::BrokenPacket);
+
+    // The ticket claims to be longer than the message.
+    u8 long_ticket[] = { 0x00, 0x00, 0x08, 0x00, 0x00, 0x1c, 0x20, 0x00, 0x04, 0xde, 0xad };
+    EXPECT_EQ(TLS::TLSv12::parse_new_session_ticket({ long_ticket, sizeof(long_ticket) }, ticket), (i8)TLS::Error::BrokenPacket);
+
+    // There's something after the ticket.
+    u8 trailing_data[] = { 0x00, 0x00, 0x08, 0x00, 0x00, 0x1c, 0x20, 0x00, 0x01, 0xde, 0xad };
+    EXPECT_EQ(TLS::TLSv12::parse_new_session_ticket({ trailing_data, sizeof(trailing_data) }, ticket), (i8)TLS::Error::BrokenPacket);
+}
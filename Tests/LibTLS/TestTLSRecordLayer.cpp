@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Endian.h>
+#include <LibCore/EventLoop.h>
+#include <LibCrypto/Authentication/HMAC.h>
+#include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Hash/SHA2.h>
+#include <LibTLS/TLSv12.h>
+#include <LibTest/TestCase.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// The records are decrypted here with keys derived independently of LibTLS,
+// so that a record that's sealed wrongly (or out of order) can't go unnoticed.
+
+struct Record {
+    u8 type { 0 };
+    ByteBuffer plaintext;
+};
+
+struct Connection {
+    NonnullRefPtr<TLS::TLSv12> tls;
+    int peer_fd { -1 };
+    ByteBuffer received;
+};
+
+static u8 client_random[32];
+static u8 server_random[32];
+static u8 master_key[48];
+
+// RFC 5246 section 5: P_SHA256(secret, label + seed)
+static ByteBuffer prf_sha256(ReadonlyBytes secret, StringView label, ReadonlyBytes seed, size_t length)
+{
+    Crypto::Authentication::HMAC<Crypto::Hash::SHA256> hmac(secret);
+    auto label_and_seed = ByteBuffer::copy(label.bytes());
+    label_and_seed.append(seed.data(), seed.size());
+
+    ByteBuffer output;
+    auto a = hmac.process(label_and_seed.data(), label_and_seed.size());
+    while (output.size() < length) {
+        hmac.update(a.immutable_data(), a.data_length());
+        hmac.update(label_and_seed.data(), label_and_seed.size());
+        auto block = hmac.digest();
+        output.append(block.immutable_data(), min(block.data_length(), length - output.size()));
+        a = hmac.process(a.immutable_data(), a.data_length());
+    }
+    return output;
+}
+
+static ByteBuffer client_key_block()
+{
+    u8 seed[64];
+    memcpy(seed, server_random, 32);
+    memcpy(seed + 32, client_random, 32);
+    return prf_sha256({ master_key, sizeof(master_key) }, "key expansion"sv, { seed, sizeof(seed) }, 192);
+}
+
+static Connection establish(TLS::CipherSuite cipher)
+{
+    for (size_t i = 0; i < 32; ++i) {
+        client_random[i] = i;
+        server_random[i] = 0x80 + i;
+    }
+    for (size_t i = 0; i < 48; ++i)
+        master_key[i] = 0x40 + i;
+
+    int fds[2];
+    VERIFY(socketpair(AF_LOCAL, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+
+    auto tls = TLS::TLSv12::construct(nullptr);
+    EXPECT(tls->establish_for_testing(fds[0], cipher, { master_key, sizeof(master_key) }, { client_random, sizeof(client_random) }, { server_random, sizeof(server_random) }));
+    return { move(tls), fds[1], {} };
+}
+
+static void receive_available(Connection& connection)
+{
+    u8 buffer[4096];
+    for (;;) {
+        auto nread = read(connection.peer_fd, buffer, sizeof(buffer));
+        if (nread <= 0)
+            break;
+        connection.received.append(buffer, nread);
+    }
+}
+
+// Lets the event loop flush whatever was written, and reads it from the other end of the socket.
+static void receive(Core::EventLoop& loop, Connection& connection)
+{
+    do {
+        loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+        receive_available(connection);
+    } while (connection.tls->has_pending_writes());
+}
+
+static Vector<Record> decrypt_gcm_records(ReadonlyBytes stream)
+{
+    auto key_block = client_key_block();
+    Crypto::Cipher::AESCipher::GCMMode gcm(key_block.bytes().slice(0, 16), 128, Crypto::Cipher::Intent::Decryption);
+    auto implicit_iv = key_block.bytes().slice(32, 4);
+
+    Vector<Record> records;
+    u64 sequence_number = 0;
+    while (!stream.is_empty()) {
+        VERIFY(stream.size() >= 5);
+        size_t length = AK::convert_between_host_and_network_endian(ByteReader::load16(stream.offset_pointer(3)));
+        VERIFY(stream.size() >= 5 + length && length >= 8 + 16);
+        auto payload = stream.slice(5, length);
+        auto plaintext_length = length - 8 - 16;
+
+        u8 iv[16] {};
+        implicit_iv.copy_to({ iv, 4 });
+        payload.slice(0, 8).copy_to({ iv + 4, 8 });
+
+        u8 aad[13];
+        u64 big_endian_sequence_number = AK::convert_between_host_and_network_endian(sequence_number++);
+        memcpy(aad, &big_endian_sequence_number, 8);
+        memcpy(aad + 8, stream.data(), 3);
+        u16 big_endian_length = AK::convert_between_host_and_network_endian((u16)plaintext_length);
+        memcpy(aad + 11, &big_endian_length, 2);
+
+        Record record { stream[0], ByteBuffer::create_uninitialized(plaintext_length) };
+        auto consistency = gcm.decrypt(payload.slice(8, plaintext_length), record.plaintext, { iv, 16 }, { aad, 13 }, payload.slice(8 + plaintext_length));
+        EXPECT_EQ(consistency, Crypto::VerificationConsistency::Consistent);
+        records.append(move(record));
+        stream = stream.slice(5 + length);
+    }
+    return records;
+}
+
+static Vector<Record> decrypt_cbc_records(ReadonlyBytes stream)
+{
+    // TLS_RSA_WITH_AES_128_CBC_SHA256: 32 byte MAC keys, 16 byte AES keys.
+    auto key_block = client_key_block();
+    auto mac_key = key_block.bytes().slice(0, 32);
+    Crypto::Cipher::AESCipher::CBCMode cbc(key_block.bytes().slice(64, 16), 128, Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+
+    Vector<Record> records;
+    u64 sequence_number = 0;
+    while (!stream.is_empty()) {
+        VERIFY(stream.size() >= 5);
+        size_t length = AK::convert_between_host_and_network_endian(ByteReader::load16(stream.offset_pointer(3)));
+        VERIFY(stream.size() >= 5 + length && length >= 16 + 32);
+        auto payload = stream.slice(5, length);
+
+        auto decrypted = cbc.create_aligned_buffer(length - 16);
+        Bytes decrypted_span = decrypted;
+        cbc.decrypt(payload.slice(16), decrypted_span, payload.slice(0, 16));
+        VERIFY(decrypted_span.size() >= 32);
+        auto plaintext_length = decrypted_span.size() - 32;
+
+        u8 mac_header[13];
+        u64 big_endian_sequence_number = AK::convert_between_host_and_network_endian(sequence_number++);
+        memcpy(mac_header, &big_endian_sequence_number, 8);
+        memcpy(mac_header + 8, stream.data(), 3);
+        u16 big_endian_length = AK::convert_between_host_and_network_endian((u16)plaintext_length);
+        memcpy(mac_header + 11, &big_endian_length, 2);
+
+        Crypto::Authentication::HMAC<Crypto::Hash::SHA256> hmac(mac_key);
+        hmac.update(mac_header, sizeof(mac_header));
+        hmac.update(decrypted_span.data(), plaintext_length);
+        auto mac = hmac.digest();
+        EXPECT_EQ(ReadonlyBytes(mac.immutable_data(), mac.data_length()), decrypted_span.slice(plaintext_length, 32));
+
+        records.append({ stream[0], ByteBuffer::copy(decrypted_span.data(), plaintext_length) });
+        stream = stream.slice(5 + length);
+    }
+    return records;
+}
+
+static Vector<Record> decrypt_records(TLS::CipherSuite cipher, ReadonlyBytes stream)
+{
+    if (cipher == TLS::CipherSuite::RSA_WITH_AES_128_GCM_SHA256)
+        return decrypt_gcm_records(stream);
+    return decrypt_cbc_records(stream);
+}
+
+static ByteBuffer pattern(size_t size)
+{
+    auto buffer = ByteBuffer::create_uninitialized(size);
+    for (size_t i = 0; i < size; ++i)
+        buffer[i] = i * 7 + i / 251;
+    return buffer;
+}
+
+static void test_records_round_trip(TLS::CipherSuite cipher)
+{
+    Core::EventLoop loop;
+    auto connection = establish(cipher);
+
+    // Small writes coalesce into one record.
+    EXPECT(connection.tls->write("hello"sv.bytes()));
+    EXPECT(connection.tls->write(" friends"sv.bytes()));
+    receive(loop, connection);
+
+    // Large writes are split into records of the maximum size.
+    auto large_data = pattern(2 * TLS::MaximumRecordPlaintextSize + 1000);
+    EXPECT(connection.tls->write(large_data));
+    receive(loop, connection);
+
+    auto records = decrypt_records(cipher, connection.received);
+    EXPECT_EQ(records.size(), 4u);
+    if (records.size() != 4)
+        return;
+    for (auto& record : records)
+        EXPECT_EQ(record.type, (u8)TLS::MessageType::ApplicationData);
+    EXPECT_EQ(StringView { records[0].plaintext }, "hello friends"sv);
+    EXPECT_EQ(records[1].plaintext.size(), TLS::MaximumRecordPlaintextSize);
+    EXPECT_EQ(records[2].plaintext.size(), TLS::MaximumRecordPlaintextSize);
+    EXPECT_EQ(records[3].plaintext.size(), 1000u);
+
+    ByteBuffer reassembled;
+    for (size_t i = 1; i < records.size(); ++i)
+        reassembled.append(records[i].plaintext);
+    EXPECT_EQ(reassembled, large_data);
+
+    close(connection.peer_fd);
+}
+
+TEST_CASE(gcm_records_round_trip)
+{
+    test_records_round_trip(TLS::CipherSuite::RSA_WITH_AES_128_GCM_SHA256);
+}
+
+TEST_CASE(cbc_records_round_trip)
+{
+    test_records_round_trip(TLS::CipherSuite::RSA_WITH_AES_128_CBC_SHA256);
+}
+
+static void test_alert_after_open_record(TLS::CipherSuite cipher)
+{
+    Core::EventLoop loop;
+    auto connection = establish(cipher);
+
+    // The alert is built while application data sits in the open record, which has to go out first.
+    EXPECT(connection.tls->write("before"sv.bytes()));
+    connection.tls->alert(TLS::AlertLevel::Warning, TLS::AlertDescription::CloseNotify);
+    EXPECT(connection.tls->write("after"sv.bytes()));
+    receive(loop, connection);
+
+    // Every record is checked against the sequence number of its position in the stream.
+    auto records = decrypt_records(cipher, connection.received);
+    EXPECT_EQ(records.size(), 3u);
+    if (records.size() != 3)
+        return;
+    EXPECT_EQ(records[0].type, (u8)TLS::MessageType::ApplicationData);
+    EXPECT_EQ(StringView { records[0].plaintext }, "before"sv);
+    EXPECT_EQ(records[1].type, (u8)TLS::MessageType::Alert);
+    EXPECT_EQ(records[1].plaintext.size(), 2u);
+    EXPECT_EQ(records[1].plaintext[1], (u8)TLS::AlertDescription::CloseNotify);
+    EXPECT_EQ(records[2].type, (u8)TLS::MessageType::ApplicationData);
+    EXPECT_EQ(StringView { records[2].plaintext }, "after"sv);
+
+    close(connection.peer_fd);
+}
+
+TEST_CASE(gcm_alert_keeps_records_in_order)
+{
+    test_alert_after_open_record(TLS::CipherSuite::RSA_WITH_AES_128_GCM_SHA256);
+}
+
+TEST_CASE(cbc_alert_keeps_records_in_order)
+{
+    test_alert_after_open_record(TLS::CipherSuite::RSA_WITH_AES_128_CBC_SHA256);
+}
+
+TEST_CASE(records_survive_a_full_socket)
+{
+    Core::EventLoop loop;
+    auto cipher = TLS::CipherSuite::RSA_WITH_AES_128_GCM_SHA256;
+    auto connection = establish(cipher);
+
+    // Nobody reads from the other end for a while, so writev() only takes part of the records
+    // (often stopping in the middle of one) and the ring has to grow to hold the rest.
+    Vector<ByteBuffer> chunks;
+    for (size_t i = 0; i < 64; ++i) {
+        chunks.append(pattern(TLS::MaximumRecordPlaintextSize / 2 + i));
+        EXPECT(connection.tls->write(chunks.last()));
+        loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+    }
+    EXPECT(connection.tls->has_pending_writes());
+
+    receive(loop, connection);
+
+    ByteBuffer expected_data;
+    for (auto& chunk : chunks)
+        expected_data.append(chunk);
+
+    ByteBuffer received_data;
+    for (auto& record : decrypt_records(cipher, connection.received)) {
+        EXPECT_EQ(record.type, (u8)TLS::MessageType::ApplicationData);
+        EXPECT(record.plaintext.size() <= TLS::MaximumRecordPlaintextSize);
+        received_data.append(record.plaintext);
+    }
+    EXPECT_EQ(received_data, expected_data);
+
+    close(connection.peer_fd);
+}
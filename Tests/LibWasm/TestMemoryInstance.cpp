@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTest/TestCase.h>
+
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+
+static constexpr auto page_size = Wasm::Constants::page_size;
+
+TEST_CASE(growing_a_page_at_a_time_zeroes_new_pages_and_keeps_old_data)
+{
+    Wasm::MemoryType type { Wasm::Limits(1) };
+    Wasm::MemoryInstance memory(type);
+    EXPECT_EQ(memory.size(), page_size);
+
+    for (size_t pages = 1; pages < 64; ++pages) {
+        auto old_size = memory.size();
+        memory.data()[old_size - 1] = static_cast<u8>(pages);
+        EXPECT(memory.grow(page_size));
+        EXPECT_EQ(memory.size(), old_size + page_size);
+
+        for (size_t page = 1; page <= pages; ++page)
+            EXPECT_EQ(memory.data()[page * page_size - 1], static_cast<u8>(page));
+        for (size_t offset = old_size; offset < memory.size(); ++offset) {
+            if (memory.data()[offset] != 0) {
+                FAIL(String::formatted("Byte {} of a new page is not zero", offset));
+                return;
+            }
+        }
+    }
+}
+
+TEST_CASE(growing_does_not_over_allocate_large_memories)
+{
+    Wasm::MemoryType type { Wasm::Limits(0) };
+    Wasm::MemoryInstance memory(type);
+
+    auto large_size = 4 * Wasm::MemoryInstance::maximum_extra_capacity_on_grow;
+    EXPECT(memory.grow(large_size));
+    EXPECT(memory.grow(page_size));
+    EXPECT(memory.data().capacity() <= large_size + page_size + Wasm::MemoryInstance::maximum_extra_capacity_on_grow);
+}
+
+TEST_CASE(growing_past_the_maximum_fails)
+{
+    Wasm::MemoryType type { Wasm::Limits(1, 2) };
+    Wasm::MemoryInstance memory(type);
+
+    EXPECT(memory.grow(page_size));
+    EXPECT(!memory.grow(page_size));
+    EXPECT_EQ(memory.size(), 2 * page_size);
+    EXPECT(memory.data().capacity() <= 2 * page_size);
+}
@@ -22,6 +22,7 @@ public:
 
     virtual JS::Value internal_get(JS::PropertyName const&, JS::Value receiver) const override;
     virtual bool internal_set(JS::PropertyName const&, JS::Value value, JS::Value receiver) override;
+    virtual bool has_exotic_property_access() const override { return true; }
 
     Optional<JS::Value> debugger_to_js(const Debug::DebugInfo::VariableInfo&) const;
     Optional<u32> js_to_debugger(JS::Value value, const Debug::DebugInfo::VariableInfo&) const;
@@ -8,39 +8,27 @@
 #include <AK/Array.h>
 #include <AK/Assertions.h>
 #include <AK/BinaryHeap.h>
-#include <AK/BinarySearch.h>
 #include <AK/MemoryStream.h>
+#include <AK/NonnullOwnPtr.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <LibCompress/Deflate.h>
+#include <LibThreading/Thread.h>
 
 namespace Compress {
 
 const CanonicalCode& CanonicalCode::fixed_literal_codes()
 {
-    static CanonicalCode code;
-    static bool initialized = false;
-
-    if (initialized)
-        return code;
-
-    code = CanonicalCode::from_bytes(fixed_literal_bit_lengths).value();
-    initialized = true;
-
+    // This is also used by ParallelDeflateCompressor's threads, so let the compiler guard the initialization
+    static const CanonicalCode code = CanonicalCode::from_bytes(fixed_literal_bit_lengths).value();
     return code;
 }
 
 const CanonicalCode& CanonicalCode::fixed_distance_codes()
 {
-    static CanonicalCode code;
-    static bool initialized = false;
-
-    if (initialized)
-        return code;
-
-    code = CanonicalCode::from_bytes(fixed_distance_bit_lengths).value();
-    initialized = true;
-
+    // This is also used by ParallelDeflateCompressor's threads, so let the compiler guard the initialization
+    static const CanonicalCode code = CanonicalCode::from_bytes(fixed_distance_bit_lengths).value();
     return code;
 }
 
@@ -59,10 +47,9 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         }
     }
     if (non_zero_symbols == 1) { // special case - only 1 symbol
-        code.m_symbol_codes.append(0b10);
-        code.m_symbol_values.append(last_non_zero);
         code.m_bit_codes[last_non_zero] = 0;
         code.m_bit_code_lengths[last_non_zero] = 1;
+        code.build_decode_table();
         return code;
     }
 
@@ -78,8 +65,6 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
             if (next_code > start_bit)
                 return {};
 
-            code.m_symbol_codes.append(start_bit | next_code);
-            code.m_symbol_values.append(symbol);
             code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
             code.m_bit_code_lengths[symbol] = code_length;
 
@@ -91,24 +76,66 @@ Optional<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         return {};
     }
 
+    code.build_decode_table();
     return code;
 }
 
+void CanonicalCode::build_decode_table()
+{
+    // Codes that don't fit into the primary table get a subtable for their first primary_table_bits bits, which is as large as the longest of them needs
+    Array<u8, 1 << primary_table_bits> subtable_bits {};
+    for (size_t symbol = 0; symbol < m_bit_code_lengths.size(); ++symbol) {
+        auto code_length = m_bit_code_lengths[symbol];
+        if (code_length > primary_table_bits) {
+            auto& bits = subtable_bits[m_bit_codes[symbol] & primary_table_mask];
+            bits = max<u8>(bits, code_length - primary_table_bits);
+        }
+    }
+
+    m_decode_table.resize(1 << primary_table_bits);
+    for (size_t prefix = 0; prefix < subtable_bits.size(); ++prefix) {
+        if (subtable_bits[prefix] == 0)
+            continue;
+        m_decode_table[prefix] = subtable_flag | subtable_bits[prefix] << 16 | m_decode_table.size();
+        m_decode_table.resize(m_decode_table.size() + (1 << subtable_bits[prefix]));
+    }
+
+    // Every entry whose index starts with a code's bits decodes to that code's symbol
+    for (size_t symbol = 0; symbol < m_bit_code_lengths.size(); ++symbol) {
+        u32 code_length = m_bit_code_lengths[symbol];
+        if (code_length == 0)
+            continue;
+        u32 entry = symbol | code_length << 16;
+        u32 bits = m_bit_codes[symbol];
+
+        if (code_length <= primary_table_bits) {
+            for (u32 index = bits; index < (1u << primary_table_bits); index += 1 << code_length)
+                m_decode_table[index] = entry;
+            continue;
+        }
+
+        auto link = m_decode_table[bits & primary_table_mask];
+        auto subtable_offset = link & 0xffff;
+        auto subtable_size = 1u << ((link >> 16) & 0xff);
+        for (u32 index = bits >> primary_table_bits; index < subtable_size; index += 1 << (code_length - primary_table_bits))
+            m_decode_table[subtable_offset + index] = entry;
+    }
+}
+
 u32 CanonicalCode::read_symbol(InputBitStream& stream) const
 {
-    u32 code_bits = 1;
+    // InputBitStream can't look ahead, so read one bit at a time until we have all of the code they start with
+    u32 code_bits = 0;
+    for (size_t bit_count = 1; bit_count <= 15; ++bit_count) {
+        code_bits |= stream.read_bits(1) << (bit_count - 1);
 
-    for (;;) {
-        code_bits = code_bits << 1 | stream.read_bits(1);
-        if (code_bits >= (1 << 16))
-            return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
-
-        // FIXME: This is very inefficient and could greatly be improved by implementing this
-        //        algorithm: https://www.hanshq.net/zip.html#huffdec
-        size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
-            return m_symbol_values[index];
+        auto decoded = decode(code_bits);
+        if (decoded.code_length == 0)
+            break;
+        if (decoded.code_length <= bit_count)
+            return decoded.symbol;
     }
+    return UINT32_MAX; // the maximum symbol in deflate is 288, so we use UINT32_MAX (an impossible value) to indicate an error
 }
 
 void CanonicalCode::write_symbol(OutputBitStream& stream, u32 symbol) const
@@ -128,45 +155,50 @@ bool DeflateDecompressor::CompressedBlock::try_read_more()
     if (m_eof == true)
         return false;
 
-    const auto symbol = m_literal_codes.read_symbol(m_decompressor.m_input_stream);
+    auto& output_stream = m_decompressor.m_output_stream;
 
-    if (symbol >= 286) { // invalid deflate literal/length symbol
-        m_decompressor.set_fatal_error();
-        return false;
-    }
+    // Decode symbols for as long as the output buffer has room for the longest back reference
+    constexpr size_t max_back_reference_length = 258;
+    while (output_stream.remaining_space() >= max_back_reference_length) {
+        const auto symbol = m_decompressor.read_symbol(m_literal_codes);
 
-    if (symbol < 256) {
-        m_decompressor.m_output_stream << static_cast<u8>(symbol);
-        return true;
-    } else if (symbol == 256) {
-        m_eof = true;
-        return false;
-    } else {
-        if (!m_distance_codes.has_value()) {
+        if (symbol >= 286) { // invalid deflate literal/length symbol
             m_decompressor.set_fatal_error();
             return false;
         }
 
-        const auto length = m_decompressor.decode_length(symbol);
-        const auto distance_symbol = m_distance_codes.value().read_symbol(m_decompressor.m_input_stream);
-        if (distance_symbol >= 30) { // invalid deflate distance symbol
-            m_decompressor.set_fatal_error();
-            return false;
-        }
-        const auto distance = m_decompressor.decode_distance(distance_symbol);
+        if (symbol < 256) {
+            output_stream << static_cast<u8>(symbol);
+        } else if (symbol == 256) {
+            // Whatever we decoded before this still has to be read, so we only report the end of the block on the next call
+            m_eof = true;
+            break;
+        } else {
+            if (!m_distance_codes.has_value()) {
+                m_decompressor.set_fatal_error();
+                return false;
+            }
 
-        for (size_t idx = 0; idx < length; ++idx) {
-            u8 byte = 0;
-            m_decompressor.m_output_stream.read({ &byte, sizeof(byte) }, distance);
-            if (m_decompressor.m_output_stream.handle_any_error()) {
+            const auto length = m_decompressor.decode_length(symbol);
+            const auto distance_symbol = m_decompressor.read_symbol(m_distance_codes.value());
+            if (distance_symbol >= 30) { // invalid deflate distance symbol
+                m_decompressor.set_fatal_error();
+                return false;
+            }
+            const auto distance = m_decompressor.decode_distance(distance_symbol);
+
+            if (!output_stream.copy_from_seekback(distance, length)) {
+                output_stream.handle_any_error();
                 m_decompressor.set_fatal_error();
                 return false; // a back reference was requested that was too far back (outside our current sliding window)
             }
-            m_decompressor.m_output_stream << byte;
         }
 
-        return true;
+        if (m_decompressor.has_any_error())
+            return false;
     }
+
+    return true;
 }
 
 DeflateDecompressor::UncompressedBlock::UncompressedBlock(DeflateDecompressor& decompressor, size_t length)
@@ -214,8 +246,8 @@ size_t DeflateDecompressor::read(Bytes bytes)
             if (m_read_final_bock)
                 break;
 
-            m_read_final_bock = m_input_stream.read_bit();
-            const auto block_type = m_input_stream.read_bits(2);
+            m_read_final_bock = read_bits(1);
+            const auto block_type = read_bits(2);
 
             if (m_input_stream.has_any_error()) {
                 set_fatal_error();
@@ -223,7 +255,7 @@ size_t DeflateDecompressor::read(Bytes bytes)
             }
 
             if (block_type == 0b00) {
-                m_input_stream.align_to_byte_boundary();
+                align_to_byte_boundary();
 
                 LittleEndian<u16> length, negated_length;
                 m_input_stream >> length >> negated_length;
@@ -373,6 +405,64 @@ Optional<ByteBuffer> DeflateDecompressor::decompress_all(ReadonlyBytes bytes)
     return output_stream.copy_into_contiguous_buffer();
 }
 
+bool DeflateDecompressor::fill_bits(size_t count)
+{
+    VERIFY(count <= 64 - 8);
+    if (m_bit_count >= count)
+        return true;
+
+    u8 bytes[8];
+    auto byte_count = (count - m_bit_count + 7) / 8;
+    if (!m_input_stream.read_or_error({ bytes, byte_count })) {
+        set_fatal_error();
+        return false;
+    }
+    for (size_t i = 0; i < byte_count; ++i) {
+        m_bit_buffer |= static_cast<u64>(bytes[i]) << m_bit_count;
+        m_bit_count += 8;
+    }
+    return true;
+}
+
+u32 DeflateDecompressor::read_bits(size_t count)
+{
+    VERIFY(count <= 32);
+    if (!fill_bits(count))
+        return 0;
+
+    u32 bits = m_bit_buffer & ((1ull << count) - 1);
+    m_bit_buffer >>= count;
+    m_bit_count -= count;
+    return bits;
+}
+
+u32 DeflateDecompressor::read_symbol(const CanonicalCode& code)
+{
+    // Bits we haven't read yet are 0 in the buffer, and any code that fits into the ones we have is the right one (no code is a prefix of another)
+    for (;;) {
+        auto decoded = code.decode(m_bit_buffer);
+        if (decoded.code_length == 0)
+            return UINT32_MAX;
+
+        if (decoded.code_length <= m_bit_count) {
+            m_bit_buffer >>= decoded.code_length;
+            m_bit_count -= decoded.code_length;
+            return decoded.symbol;
+        }
+
+        if (!fill_bits(m_bit_count + 1))
+            return UINT32_MAX;
+    }
+}
+
+void DeflateDecompressor::align_to_byte_boundary()
+{
+    // We never read more bytes than we need, so only the rest of the current byte can be left
+    VERIFY(m_bit_count < 8);
+    m_bit_buffer = 0;
+    m_bit_count = 0;
+}
+
 u32 DeflateDecompressor::decode_length(u32 symbol)
 {
     // FIXME: I can't quite follow the algorithm here, but it seems to work.
@@ -382,7 +472,7 @@ u32 DeflateDecompressor::decode_length(u32 symbol)
 
     if (symbol <= 284) {
         auto extra_bits = (symbol - 261) / 4;
-        return (((symbol - 265) % 4 + 4) << extra_bits) + 3 + m_input_stream.read_bits(extra_bits);
+        return (((symbol - 265) % 4 + 4) << extra_bits) + 3 + read_bits(extra_bits);
     }
 
     if (symbol == 285)
@@ -400,7 +490,7 @@ u32 DeflateDecompressor::decode_distance(u32 symbol)
 
     if (symbol <= 29) {
         auto extra_bits = (symbol / 2) - 1;
-        return ((symbol % 2 + 2) << extra_bits) + 1 + m_input_stream.read_bits(extra_bits);
+        return ((symbol % 2 + 2) << extra_bits) + 1 + read_bits(extra_bits);
     }
 
     VERIFY_NOT_REACHED();
@@ -408,16 +498,16 @@ u32 DeflateDecompressor::decode_distance(u32 symbol)
 
 void DeflateDecompressor::decode_codes(CanonicalCode& literal_code, Optional<CanonicalCode>& distance_code)
 {
-    auto literal_code_count = m_input_stream.read_bits(5) + 257;
-    auto distance_code_count = m_input_stream.read_bits(5) + 1;
-    auto code_length_count = m_input_stream.read_bits(4) + 4;
+    auto literal_code_count = read_bits(5) + 257;
+    auto distance_code_count = read_bits(5) + 1;
+    auto code_length_count = read_bits(4) + 4;
 
     // First we have to extract the code lengths of the code that was used to encode the code lengths of
     // the code that was used to encode the block.
 
     u8 code_lengths_code_lengths[19] = { 0 };
     for (size_t i = 0; i < code_length_count; ++i) {
-        code_lengths_code_lengths[code_lengths_code_lengths_order[i]] = m_input_stream.read_bits(3);
+        code_lengths_code_lengths[code_lengths_code_lengths_order[i]] = read_bits(3);
     }
 
     // Now we can extract the code that was used to encode the code lengths of the code that was used to
@@ -434,7 +524,7 @@ void DeflateDecompressor::decode_codes(CanonicalCode& literal_code, Optional<Can
 
     Vector<u8> code_lengths;
     while (code_lengths.size() < literal_code_count + distance_code_count) {
-        auto symbol = code_length_code.read_symbol(m_input_stream);
+        auto symbol = read_symbol(code_length_code);
 
         if (symbol == UINT32_MAX) {
             set_fatal_error();
@@ -445,12 +535,12 @@ void DeflateDecompressor::decode_codes(CanonicalCode& literal_code, Optional<Can
             code_lengths.append(static_cast<u8>(symbol));
             continue;
         } else if (symbol == DeflateSpecialCodeLengths::ZEROS) {
-            auto nrepeat = 3 + m_input_stream.read_bits(3);
+            auto nrepeat = 3 + read_bits(3);
             for (size_t j = 0; j < nrepeat; ++j)
                 code_lengths.append(0);
             continue;
         } else if (symbol == DeflateSpecialCodeLengths::LONG_ZEROS) {
-            auto nrepeat = 11 + m_input_stream.read_bits(7);
+            auto nrepeat = 11 + read_bits(7);
             for (size_t j = 0; j < nrepeat; ++j)
                 code_lengths.append(0);
             continue;
@@ -462,7 +552,7 @@ void DeflateDecompressor::decode_codes(CanonicalCode& literal_code, Optional<Can
                 return;
             }
 
-            auto nrepeat = 3 + m_input_stream.read_bits(2);
+            auto nrepeat = 3 + read_bits(2);
             for (size_t j = 0; j < nrepeat; ++j)
                 code_lengths.append(code_lengths.last());
         }
@@ -510,11 +600,14 @@ DeflateCompressor::DeflateCompressor(OutputStream& stream, CompressionLevel comp
 {
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
+    for (auto& slot : m_hash_head)
+        slot = empty_slot;
 }
 
 DeflateCompressor::~DeflateCompressor()
 {
-    VERIFY(m_finished);
+    // Unless the stream was ended, everything written must at least have been sync flushed
+    VERIFY(m_finished || m_pending_block_size == 0);
 }
 
 size_t DeflateCompressor::write(ReadonlyBytes bytes)
@@ -550,23 +643,41 @@ u16 DeflateCompressor::hash_sequence(const u8* bytes)
     return ((bytes[0] | bytes[1] << 8 | bytes[2] << 16 | bytes[3] << 24) * knuth_constant) >> (32 - hash_bits);
 }
 
+void DeflateCompressor::insert_hash(size_t position, u16 hash)
+{
+    auto window_position = position % window_size;
+    m_hash_prev[window_position] = m_hash_head[hash];
+    m_hash_head[hash] = window_position;
+}
+
 size_t DeflateCompressor::compare_match_candidate(size_t start, size_t candidate, size_t previous_match_length, size_t maximum_match_length)
 {
     VERIFY(previous_match_length < maximum_match_length);
 
-    // We firstly check that the match is at least (prev_match_length + 1) long, we check backwards as there's a higher chance the end mismatches
-    for (ssize_t i = previous_match_length; i >= 0; i--) {
-        if (m_rolling_window[start + i] != m_rolling_window[candidate + i])
-            return 0;
+    // The match has to be at least (prev_match_length + 1) long, and there's a higher chance of it mismatching at the end, so check that byte first
+    if (m_rolling_window[start + previous_match_length] != m_rolling_window[candidate + previous_match_length])
+        return 0;
+
+    // Find the actual length, comparing 8 bytes at a time until they differ; the lowest set bit of their xor is in the first differing byte
+    size_t match_length = 0;
+    while (match_length + sizeof(u64) <= maximum_match_length) {
+        u64 start_bytes;
+        u64 candidate_bytes;
+        memcpy(&start_bytes, &m_rolling_window[start + match_length], sizeof(u64));
+        memcpy(&candidate_bytes, &m_rolling_window[candidate + match_length], sizeof(u64));
+        auto difference = AK::convert_between_host_and_little_endian(start_bytes ^ candidate_bytes);
+        if (difference != 0) {
+            match_length += __builtin_ctzll(difference) / 8;
+            return match_length > previous_match_length ? match_length : 0;
+        }
+        match_length += sizeof(u64);
     }
-
-    // Find the actual length
-    auto match_length = previous_match_length + 1;
     while (match_length < maximum_match_length && m_rolling_window[start + match_length] == m_rolling_window[candidate + match_length]) {
         match_length++;
     }
 
-    VERIFY(match_length > previous_match_length);
+    if (match_length <= previous_match_length)
+        return 0;
     VERIFY(match_length <= maximum_match_length);
     return match_length;
 }
@@ -590,7 +701,7 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
             break; // no remaining candidates
 
         VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        if (start - candidate > max_distance)
             break; // outside the window
 
         auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
@@ -690,16 +801,6 @@ void DeflateCompressor::generate_huffman_lengths(Array<u8, Size>& lengths, const
 
 void DeflateCompressor::lz77_compress_block()
 {
-    for (auto& slot : m_hash_head) { // initialize chained hash table
-        slot = empty_slot;
-    }
-
-    auto insert_hash = [&](auto pos, auto hash) {
-        auto window_pos = pos % window_size;
-        m_hash_prev[window_pos] = m_hash_head[hash];
-        m_hash_head[hash] = window_pos;
-    };
-
     auto emit_literal = [&](auto literal) {
         VERIFY(m_pending_symbol_size <= block_size + 1);
         auto index = m_pending_symbol_size++;
@@ -1037,12 +1138,33 @@ void DeflateCompressor::flush()
         m_output_stream.align_to_byte_boundary();
 
     // reset all block specific members
+    if (!m_finished)
+        slide_window(m_pending_block_size);
     m_pending_block_size = 0;
     m_pending_symbol_size = 0;
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
-    // On the final block this copy will potentially produce an invalid search window, but since its the final block we dont care
-    pending_block().copy_trimmed_to({ m_rolling_window, block_size });
+}
+
+// Moves the window back by distance bytes, so that the end of the block we just compressed lines up with the start of the next one
+void DeflateCompressor::slide_window(size_t distance)
+{
+    VERIFY(distance <= block_size);
+    memmove(m_rolling_window, m_rolling_window + distance, block_size);
+
+    // Positions that fall off the start of the window (and empty slots) wrap around to at least empty_slot - distance
+    u16 first_invalid = empty_slot - distance;
+    auto slide = [&](u16& slot) {
+        u16 slid = slot - distance;
+        slot = slid >= first_invalid ? empty_slot : slid;
+    };
+    for (auto& slot : m_hash_head)
+        slide(slot);
+    // Only positions in the first half of the window can be in a chain now, so that's all we have to keep
+    for (size_t i = 0; i < block_size; i++) {
+        m_hash_prev[i] = m_hash_prev[i + distance];
+        slide(m_hash_prev[i]);
+    }
 }
 
 void DeflateCompressor::final_flush()
@@ -1052,6 +1174,36 @@ void DeflateCompressor::final_flush()
     flush();
 }
 
+void DeflateCompressor::set_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(!m_finished);
+    VERIFY(m_pending_block_size == 0);
+
+    if (dictionary.size() > block_size)
+        dictionary = dictionary.slice(dictionary.size() - block_size);
+
+    auto start = block_size - dictionary.size();
+    dictionary.copy_to({ m_rolling_window + start, dictionary.size() });
+    for (size_t position = start; position + min_match_length <= block_size; position++)
+        insert_hash(position, hash_sequence(&m_rolling_window[position]));
+}
+
+void DeflateCompressor::sync_flush()
+{
+    VERIFY(!m_finished);
+
+    if (m_pending_block_size != 0)
+        flush();
+
+    // An empty stored block ends on a byte boundary
+    m_output_stream.write_bit(false);
+    m_output_stream.write_bits(0b00, 2);
+    m_output_stream.align_to_byte_boundary();
+    LittleEndian<u16> len = 0;
+    LittleEndian<u16> nlen = 0xffff;
+    m_output_stream << len << nlen;
+}
+
 Optional<ByteBuffer> DeflateCompressor::compress_all(const ReadonlyBytes& bytes, CompressionLevel compression_level)
 {
     DuplexMemoryStream output_stream;
@@ -1067,4 +1219,135 @@ Optional<ByteBuffer> DeflateCompressor::compress_all(const ReadonlyBytes& bytes,
     return output_stream.copy_into_contiguous_buffer();
 }
 
+ParallelDeflateCompressor::ParallelDeflateCompressor(OutputStream& stream, DeflateCompressor::CompressionLevel compression_level, size_t thread_count)
+    : m_compression_level(compression_level)
+    , m_thread_count(thread_count)
+    , m_output_stream(stream)
+{
+    if (m_thread_count == 0) {
+        auto online_processors = sysconf(_SC_NPROCESSORS_ONLN);
+        m_thread_count = online_processors > 0 ? online_processors : 1;
+    }
+}
+
+ParallelDeflateCompressor::~ParallelDeflateCompressor()
+{
+    VERIFY(m_finished);
+}
+
+size_t ParallelDeflateCompressor::write(ReadonlyBytes bytes)
+{
+    VERIFY(!m_finished);
+
+    auto batch_size = chunk_size * m_thread_count;
+    size_t total_written = 0;
+    while (total_written < bytes.size() && !has_any_error()) {
+        auto n_written = min(bytes.size() - total_written, batch_size - m_pending_input.size());
+        m_pending_input.append(bytes.slice(total_written, n_written));
+        total_written += n_written;
+
+        if (m_pending_input.size() == batch_size)
+            compress_pending_chunks();
+    }
+
+    return total_written;
+}
+
+bool ParallelDeflateCompressor::write_or_error(ReadonlyBytes bytes)
+{
+    if (write(bytes) < bytes.size()) {
+        set_fatal_error();
+        return false;
+    }
+
+    return true;
+}
+
+struct ChunkCompression {
+    ReadonlyBytes dictionary;
+    ReadonlyBytes input;
+    bool is_final { false };
+    DeflateCompressor::CompressionLevel compression_level;
+    Optional<ByteBuffer> output;
+};
+
+static void compress_chunk(ChunkCompression& chunk)
+{
+    DuplexMemoryStream output_stream;
+    auto deflate_stream = make<DeflateCompressor>(output_stream, chunk.compression_level);
+    deflate_stream->set_dictionary(chunk.dictionary);
+    deflate_stream->write_or_error(chunk.input);
+    if (chunk.is_final)
+        deflate_stream->final_flush();
+    else
+        deflate_stream->sync_flush();
+
+    if (!deflate_stream->handle_any_error())
+        chunk.output = output_stream.copy_into_contiguous_buffer();
+}
+
+void ParallelDeflateCompressor::compress_pending_chunks()
+{
+    Vector<ChunkCompression> chunks;
+    auto dictionary = m_dictionary.bytes();
+    // The final batch always has at least one (possibly empty) chunk, as that's what ends the stream
+    for (size_t offset = 0; offset < m_pending_input.size() || (m_finished && chunks.is_empty()); offset += chunk_size) {
+        auto input = m_pending_input.bytes().slice(offset, min(chunk_size, m_pending_input.size() - offset));
+        chunks.append({ dictionary, input, false, m_compression_level, {} });
+        dictionary = input;
+    }
+    if (m_finished)
+        chunks.last().is_final = true;
+
+    // The first chunk is compressed on this thread while the rest get one of their own
+    Vector<NonnullRefPtr<Threading::Thread>> threads;
+    for (size_t i = 1; i < chunks.size(); i++) {
+        auto compress = [&chunk = chunks[i]]() -> intptr_t {
+            compress_chunk(chunk);
+            return 0;
+        };
+        auto thread = Threading::Thread::construct(move(compress), "Deflate"sv);
+        thread->start();
+        threads.append(move(thread));
+    }
+    compress_chunk(chunks[0]);
+    for (auto& thread : threads)
+        [[maybe_unused]] auto result = thread->join();
+
+    for (auto& chunk : chunks) {
+        if (!chunk.output.has_value() || !m_output_stream.write_or_error(chunk.output.value())) {
+            set_fatal_error();
+            break;
+        }
+    }
+
+    if (!m_finished) {
+        auto input = m_pending_input.bytes();
+        m_dictionary = ByteBuffer::copy(input.slice(input.size() - min(input.size(), DeflateCompressor::block_size)));
+    }
+    m_pending_input.clear();
+}
+
+void ParallelDeflateCompressor::final_flush()
+{
+    VERIFY(!m_finished);
+    m_finished = true;
+    compress_pending_chunks();
+}
+
+Optional<ByteBuffer> ParallelDeflateCompressor::compress_all(const ReadonlyBytes& bytes, DeflateCompressor::CompressionLevel compression_level, size_t thread_count)
+{
+    DuplexMemoryStream output_stream;
+    ParallelDeflateCompressor deflate_stream { output_stream, compression_level, thread_count };
+
+    deflate_stream.write_or_error(bytes);
+
+    deflate_stream.final_flush();
+
+    if (deflate_stream.handle_any_error())
+        return {};
+
+    return output_stream.copy_into_contiguous_buffer();
+}
+
 }
@@ -18,19 +18,41 @@ namespace Compress {
 
 class CanonicalCode {
 public:
+    struct DecodedSymbol {
+        u32 symbol;
+        size_t code_length; // 0 if the bits don't start any code
+    };
+
     CanonicalCode() = default;
     u32 read_symbol(InputBitStream&) const;
     void write_symbol(OutputBitStream&, u32) const;
 
+    // Finds the symbol whose code the given (lsb-first) bits start with, only the first code_length of them have to be valid
+    ALWAYS_INLINE DecodedSymbol decode(u32 bits) const
+    {
+        auto entry = m_decode_table[bits & primary_table_mask];
+        if (entry & subtable_flag) {
+            auto subtable_bits = (entry >> 16) & 0xff;
+            entry = m_decode_table[(entry & 0xffff) + ((bits >> primary_table_bits) & ((1u << subtable_bits) - 1))];
+        }
+        return { entry & 0xffff, entry >> 16 };
+    }
+
     static const CanonicalCode& fixed_literal_codes();
     static const CanonicalCode& fixed_distance_codes();
 
     static Optional<CanonicalCode> from_bytes(ReadonlyBytes);
 
 private:
-    // Decompression - indexed by code
-    Vector<u16> m_symbol_codes;
-    Vector<u16> m_symbol_values;
+    static constexpr size_t primary_table_bits = 9;
+    static constexpr u32 primary_table_mask = (1 << primary_table_bits) - 1;
+    static constexpr u32 subtable_flag = 1u << 31;
+
+    void build_decode_table();
+
+    // Decompression - indexed by the next primary_table_bits bits of input. Entries hold a symbol and its code length (which is 0 for invalid codes),
+    // or for longer codes the offset and bit count of a subtable that is indexed by the bits following those.
+    Vector<u32> m_decode_table;
 
     // Compression - indexed by symbol
     Array<u16, 288> m_bit_codes {}; // deflate uses a maximum of 288 symbols (maximum of 32 for distances)
@@ -87,6 +109,13 @@ public:
     static Optional<ByteBuffer> decompress_all(ReadonlyBytes);
 
 private:
+    // Bits are read lsb-first, and only as many bytes are read from the input as the bits we need take up,
+    // since whatever comes after the deflate data (e.g. a gzip member's trailer) has to be left for the caller.
+    bool fill_bits(size_t count);
+    u32 read_bits(size_t count);
+    u32 read_symbol(const CanonicalCode&);
+    void align_to_byte_boundary();
+
     u32 decode_length(u32);
     u32 decode_distance(u32);
     void decode_codes(CanonicalCode& literal_code, Optional<CanonicalCode>& distance_code);
@@ -99,7 +128,9 @@ private:
         UncompressedBlock m_uncompressed_block;
     };
 
-    InputBitStream m_input_stream;
+    InputStream& m_input_stream;
+    u64 m_bit_buffer { 0 };
+    size_t m_bit_count { 0 };
     CircularDuplexStream<32 * KiB> m_output_stream;
 };
 
@@ -113,11 +144,12 @@ class DeflateCompressor final : public OutputStream {
 public:
     static constexpr size_t block_size = 32 * KiB - 1; // TODO: this can theoretically be increased to 64 KiB - 2
     static constexpr size_t window_size = block_size * 2;
-    static constexpr size_t hash_bits = 15;
+    static constexpr size_t hash_bits = 16;
     static constexpr size_t max_huffman_literals = 288;
     static constexpr size_t max_huffman_distances = 32;
     static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
     static constexpr size_t max_match_length = 258; // matches longer than these cannot be encoded using huffman codes
+    static constexpr size_t max_distance = 32 * KiB; // back references cannot reach further back than this
     static constexpr u16 empty_slot = UINT16_MAX;
 
     struct CompressionConstants {
@@ -151,6 +183,11 @@ public:
     bool write_or_error(ReadonlyBytes) override;
     void final_flush();
 
+    // Lets the first block reference the end of the given data as if it had been compressed right before it, must be called before anything is written
+    void set_dictionary(ReadonlyBytes);
+    // Compresses everything written so far without ending the stream, and pads the output to a byte boundary so that other deflate data can be appended to it
+    void sync_flush();
+
     static Optional<ByteBuffer> compress_all(const ReadonlyBytes& bytes, CompressionLevel = CompressionLevel::GOOD);
 
 private:
@@ -158,6 +195,8 @@ private:
 
     // LZ77 Compression
     static u16 hash_sequence(const u8* bytes);
+    void insert_hash(size_t position, u16 hash);
+    void slide_window(size_t distance);
     size_t compare_match_candidate(size_t start, size_t candidate, size_t prev_match_length, size_t max_match_length);
     size_t find_back_match(size_t start, u16 hash, size_t previous_match_length, size_t max_match_length, size_t& match_position);
     void lz77_compress_block();
@@ -200,9 +239,39 @@ private:
     Array<u16, max_huffman_literals> m_symbol_frequencies;    // there are 286 valid symbol values (symbols 286-287 never occur)
     Array<u16, max_huffman_distances> m_distance_frequencies; // there are 30 valid distance values (distances 30-31 never occur)
 
-    // LZ77 Chained hash table
+    // LZ77 Chained hash table, which is kept across blocks so that matches can reach into the previous one
     u16 m_hash_head[1 << hash_bits];
     u16 m_hash_prev[window_size];
 };
 
+// Compresses its input in independent chunks on multiple threads (in the style of pigz), each of which is primed with the end of the chunk before it.
+// The chunks are joined with empty stored blocks, so the result is a single regular deflate stream.
+class ParallelDeflateCompressor final : public OutputStream {
+public:
+    static constexpr size_t chunk_size = 128 * KiB;
+
+    // A thread count of 0 uses one thread per online processor
+    ParallelDeflateCompressor(OutputStream&, DeflateCompressor::CompressionLevel = DeflateCompressor::CompressionLevel::GOOD, size_t thread_count = 0);
+    ~ParallelDeflateCompressor();
+
+    size_t write(ReadonlyBytes) override;
+    bool write_or_error(ReadonlyBytes) override;
+    void final_flush();
+
+    static Optional<ByteBuffer> compress_all(const ReadonlyBytes& bytes, DeflateCompressor::CompressionLevel = DeflateCompressor::CompressionLevel::GOOD, size_t thread_count = 0);
+
+private:
+    void compress_pending_chunks();
+
+    bool m_finished { false };
+    DeflateCompressor::CompressionLevel m_compression_level;
+    size_t m_thread_count;
+    OutputStream& m_output_stream;
+
+    // Up to one chunk per thread is collected before they're all compressed at once
+    ByteBuffer m_pending_input;
+    // The end of the previously compressed input, which the next chunk is primed with
+    ByteBuffer m_dictionary;
+};
+
 }
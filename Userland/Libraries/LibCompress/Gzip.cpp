@@ -220,8 +220,9 @@ bool GzipDecompressor::handle_any_error()
     return Stream::handle_any_error() || handled_errors;
 }
 
-GzipCompressor::GzipCompressor(OutputStream& stream)
+GzipCompressor::GzipCompressor(OutputStream& stream, size_t thread_count)
     : m_output_stream(stream)
+    , m_thread_count(thread_count)
 {
 }
 
@@ -240,9 +241,15 @@ size_t GzipCompressor::write(ReadonlyBytes bytes)
     header.extra_flags = 3;      // DEFLATE sets 2 for maximum compression and 4 for minimum compression
     header.operating_system = 3; // unix
     m_output_stream << Bytes { &header, sizeof(header) };
-    DeflateCompressor compressed_stream { m_output_stream };
-    VERIFY(compressed_stream.write_or_error(bytes));
-    compressed_stream.final_flush();
+    if (m_thread_count == 1) {
+        DeflateCompressor compressed_stream { m_output_stream };
+        VERIFY(compressed_stream.write_or_error(bytes));
+        compressed_stream.final_flush();
+    } else {
+        ParallelDeflateCompressor compressed_stream { m_output_stream, DeflateCompressor::CompressionLevel::GOOD, m_thread_count };
+        VERIFY(compressed_stream.write_or_error(bytes));
+        compressed_stream.final_flush();
+    }
     Crypto::Checksum::CRC32 crc32;
     crc32.update(bytes);
     LittleEndian<u32> digest = crc32.digest();
@@ -261,10 +268,10 @@ bool GzipCompressor::write_or_error(ReadonlyBytes bytes)
     return true;
 }
 
-Optional<ByteBuffer> GzipCompressor::compress_all(const ReadonlyBytes& bytes)
+Optional<ByteBuffer> GzipCompressor::compress_all(const ReadonlyBytes& bytes, size_t thread_count)
 {
     DuplexMemoryStream output_stream;
-    GzipCompressor gzip_stream { output_stream };
+    GzipCompressor gzip_stream { output_stream, thread_count };
 
     gzip_stream.write_or_error(bytes);
 
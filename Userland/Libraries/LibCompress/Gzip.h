@@ -81,16 +81,18 @@ private:
 
 class GzipCompressor final : public OutputStream {
 public:
-    GzipCompressor(OutputStream&);
+    // Any thread count other than 1 compresses with a ParallelDeflateCompressor, where 0 uses one thread per online processor
+    GzipCompressor(OutputStream&, size_t thread_count = 1);
     ~GzipCompressor();
 
     size_t write(ReadonlyBytes) override;
     bool write_or_error(ReadonlyBytes) override;
 
-    static Optional<ByteBuffer> compress_all(const ReadonlyBytes& bytes);
+    static Optional<ByteBuffer> compress_all(const ReadonlyBytes& bytes, size_t thread_count = 1);
 
 private:
     OutputStream& m_output_stream;
+    size_t m_thread_count;
 };
 
 }
@@ -40,6 +40,7 @@ public:
         for (size_t i = 0; i < 16; i += 4) {
             m_key[i / 4] = AK::convert_between_host_and_big_endian(ByteReader::load32(key.offset(i)));
         }
+        prepare_hardware_key_powers(key);
     }
 
     constexpr static size_t digest_size() { return TagType::Size; }
@@ -50,8 +51,14 @@ public:
 
 private:
     inline void transform(ReadonlyBytes, ReadonlyBytes);
+    void prepare_hardware_key_powers(ReadonlyBytes key);
 
     u32 m_key[4];
+
+    // H, H^2, H^3 and H^4 for the PCLMULQDQ code path, which folds four blocks into the tag at a time.
+    // Only filled in when the CPU supports that path.
+    bool m_has_hardware_key_powers { false };
+    alignas(16) u8 m_hardware_key_powers[4][16];
 };
 
 }
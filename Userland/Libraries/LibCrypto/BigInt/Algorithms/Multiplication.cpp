@@ -9,38 +9,181 @@
 
 namespace Crypto {
 
+using Word = UnsignedBigInteger::Word;
+using DoubleWord = u64;
+static_assert(sizeof(DoubleWord) == 2 * sizeof(Word));
+
+// Below this many words, the bookkeeping of Karatsuba costs more than the multiplications it saves.
+static constexpr size_t karatsuba_threshold = 48;
+
+/**
+ * Complexity: O(N*M) where N and M are the lengths of the operands
+ * output[0 .. left_length + right_length) = left * right
+ */
+static void schoolbook_multiply(Word const* left, size_t left_length, Word const* right, size_t right_length, Word* output)
+{
+    __builtin_memset(output, 0, right_length * sizeof(Word));
+    for (size_t i = 0; i < left_length; ++i) {
+        DoubleWord carry = 0;
+        DoubleWord left_word = left[i];
+        for (size_t j = 0; j < right_length; ++j) {
+            DoubleWord product = left_word * right[j] + output[i + j] + carry;
+            output[i + j] = static_cast<Word>(product);
+            carry = product >> UnsignedBigInteger::BITS_IN_WORD;
+        }
+        output[i + right_length] = static_cast<Word>(carry);
+    }
+}
+
+// accumulator[0 .. accumulator_length) -= value[0 .. value_length), the result must not be negative.
+static void subtract_words_in_place(Word* accumulator, size_t accumulator_length, Word const* value, size_t value_length)
+{
+    Word borrow = 0;
+    size_t i = 0;
+    for (; i < value_length; ++i) {
+        DoubleWord difference = static_cast<DoubleWord>(accumulator[i]) - value[i] - borrow;
+        accumulator[i] = static_cast<Word>(difference);
+        borrow = static_cast<Word>(difference >> UnsignedBigInteger::BITS_IN_WORD) & 1;
+    }
+    for (; borrow && i < accumulator_length; ++i)
+        borrow = accumulator[i]-- == 0;
+    VERIFY(!borrow);
+}
+
+// accumulator[0 .. accumulator_length) += value[0 .. value_length), the result must fit.
+static void add_words_in_place(Word* accumulator, size_t accumulator_length, Word const* value, size_t value_length)
+{
+    Word carry = 0;
+    size_t i = 0;
+    for (; i < value_length; ++i) {
+        DoubleWord sum = static_cast<DoubleWord>(accumulator[i]) + value[i] + carry;
+        accumulator[i] = static_cast<Word>(sum);
+        carry = static_cast<Word>(sum >> UnsignedBigInteger::BITS_IN_WORD);
+    }
+    for (; carry && i < accumulator_length; ++i)
+        carry = ++accumulator[i] == 0;
+    VERIFY(!carry);
+}
+
+// How many words of scratch space karatsuba_multiply() needs for operands of the given length.
+static size_t karatsuba_scratch_size(size_t length)
+{
+    if (length < karatsuba_threshold)
+        return 0;
+    auto sum_length = length - length / 2 + 1;
+    return 4 * sum_length + karatsuba_scratch_size(sum_length);
+}
+
 /**
- * Complexity: O(N^2) where N is the number of words in the larger number
- * Multiplication method:
- * An integer is equal to the sum of the powers of two
- * according to the indices of its 'on' bits.
- * So to multiple x*y, we go over each '1' bit in x (say the i'th bit),
- * and add y<<i to the result.
+ * Complexity: O(N^log2(3)) where N is the length of both operands
+ * output[0 .. 2 * length) = left * right
+ * Splitting both operands into halves, left = l1 * B + l0 and right = r1 * B + r0, gives
+ * left * right = l1 * r1 * B^2 + ((l0 + l1) * (r0 + r1) - l0 * r0 - l1 * r1) * B + l0 * r0,
+ * which only takes three multiplications of half the size.
+ */
+static void karatsuba_multiply(Word const* left, Word const* right, size_t length, Word* output, Word* scratch)
+{
+    if (length < karatsuba_threshold) {
+        schoolbook_multiply(left, length, right, length, output);
+        return;
+    }
+
+    auto low_length = length / 2;
+    auto high_length = length - low_length;
+    auto sum_length = high_length + 1;
+
+    // l0 * r0 goes to the bottom of the output, l1 * r1 to the top.
+    karatsuba_multiply(left, right, low_length, output, scratch);
+    karatsuba_multiply(left + low_length, right + low_length, high_length, output + 2 * low_length, scratch);
+
+    auto* left_sum = scratch;
+    auto* right_sum = left_sum + sum_length;
+    auto* middle = right_sum + sum_length;
+    auto* next_scratch = middle + 2 * sum_length;
+
+    // The high halves are at least as long as the low ones; pad the low ones with a zero word.
+    left_sum[high_length] = 0;
+    right_sum[high_length] = 0;
+    __builtin_memcpy(left_sum, left + low_length, high_length * sizeof(Word));
+    __builtin_memcpy(right_sum, right + low_length, high_length * sizeof(Word));
+    add_words_in_place(left_sum, sum_length, left, low_length);
+    add_words_in_place(right_sum, sum_length, right, low_length);
+
+    karatsuba_multiply(left_sum, right_sum, sum_length, middle, next_scratch);
+    subtract_words_in_place(middle, 2 * sum_length, output, 2 * low_length);
+    subtract_words_in_place(middle, 2 * sum_length, output + 2 * low_length, 2 * high_length);
+
+    // The middle term can't overflow the output, so its leading words are zero.
+    auto middle_length = 2 * sum_length;
+    while (middle_length > 0 && middle[middle_length - 1] == 0)
+        --middle_length;
+    add_words_in_place(output + low_length, 2 * length - low_length, middle, middle_length);
+}
+
+// How many words of scratch space multiply_words() needs for operands of the given lengths.
+static size_t multiply_scratch_size(size_t left_length, size_t right_length)
+{
+    if (right_length < karatsuba_threshold)
+        return 0;
+    auto size = karatsuba_scratch_size(right_length);
+    if (auto remainder = left_length % right_length; remainder != 0)
+        size = max(size, multiply_scratch_size(right_length, remainder));
+    return 2 * right_length + size;
+}
+
+/**
+ * output[0 .. left_length + right_length) = left * right, with left_length >= right_length.
+ * Operands of very different lengths are multiplied in right_length-sized slices of the longer one.
+ */
+static void multiply_words(Word const* left, size_t left_length, Word const* right, size_t right_length, Word* output, Word* scratch)
+{
+    if (right_length < karatsuba_threshold) {
+        schoolbook_multiply(right, right_length, left, left_length, output);
+        return;
+    }
+
+    __builtin_memset(output, 0, (left_length + right_length) * sizeof(Word));
+    auto* product = scratch;
+    auto* next_scratch = product + 2 * right_length;
+    for (size_t offset = 0; offset < left_length; offset += right_length) {
+        auto slice_length = min(right_length, left_length - offset);
+        if (slice_length == right_length)
+            karatsuba_multiply(left + offset, right, right_length, product, next_scratch);
+        else
+            multiply_words(right, right_length, left + offset, slice_length, product, next_scratch);
+        add_words_in_place(output + offset, left_length + right_length - offset, product, slice_length + right_length);
+    }
+}
+
+/**
+ * Complexity: O(N^2) for small numbers, O(N^log2(3)) once both operands are longer than karatsuba_threshold words
  */
 FLATTEN void UnsignedBigIntegerAlgorithms::multiply_without_allocation(
     UnsignedBigInteger const& left,
     UnsignedBigInteger const& right,
-    UnsignedBigInteger& temp_shift_result,
-    UnsignedBigInteger& temp_shift_plus,
-    UnsignedBigInteger& temp_shift,
+    UnsignedBigInteger& temp_scratch,
     UnsignedBigInteger& output)
 {
+    auto const* longer = &left;
+    auto const* shorter = &right;
+    if (longer->trimmed_length() < shorter->trimmed_length())
+        swap(longer, shorter);
+
+    auto longer_length = longer->trimmed_length();
+    auto shorter_length = shorter->trimmed_length();
+
     output.set_to_0();
+    if (shorter_length == 0)
+        return;
 
-    // iterate all bits
-    for (size_t word_index = 0; word_index < left.length(); ++word_index) {
-        for (size_t bit_index = 0; bit_index < UnsignedBigInteger::BITS_IN_WORD; ++bit_index) {
-            // If the bit is off - skip over it
-            if (!(left.m_words[word_index] & (1 << bit_index)))
-                continue;
+    output.m_words.resize_and_keep_capacity(longer_length + shorter_length);
 
-            size_t shift_amount = word_index * UnsignedBigInteger::BITS_IN_WORD + bit_index;
+    temp_scratch.m_words.resize_and_keep_capacity(multiply_scratch_size(longer_length, shorter_length));
+    temp_scratch.m_cached_trimmed_length = {};
+    temp_scratch.m_cached_hash = 0;
 
-            // output += (right << shift_amount);
-            shift_left_without_allocation(right, shift_amount, temp_shift_result, temp_shift_plus, temp_shift);
-            add_into_accumulator_without_allocation(output, temp_shift);
-        }
-    }
+    multiply_words(longer->m_words.data(), longer_length, shorter->m_words.data(), shorter_length, output.m_words.data(), temp_scratch.m_words.data());
+    output.clamp_to_trimmed_length();
 }
 
 }
@@ -66,6 +66,10 @@ void UnsignedBigIntegerAlgorithms::add_into_accumulator_without_allocation(Unsig
         // Note : The accumulator couldn't add the carry directly, so we reached its end
         accumulator.m_words.append(last_carry_for_word);
     }
+
+    // The words were changed in place, so whatever was cached about the old value is stale now.
+    accumulator.m_cached_trimmed_length = {};
+    accumulator.m_cached_hash = 0;
 }
 
 /**
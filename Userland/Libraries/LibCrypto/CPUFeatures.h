@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Platform.h>
+#include <AK/Types.h>
+
+// The kernel is built without SSE, so it always uses the portable implementations.
+#if (ARCH(I386) || ARCH(X86_64)) && !defined(KERNEL)
+#    define CRYPTO_HAS_X86_ACCELERATION
+#    include <cpuid.h>
+#endif
+
+namespace Crypto {
+
+struct CPUFeatures {
+    bool aes { false };
+    bool pclmul { false };
+    bool ssse3 { false };
+};
+
+inline CPUFeatures const& cpu_features()
+{
+    static CPUFeatures const features = [] {
+        CPUFeatures features;
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+        unsigned eax, ebx, ecx, edx;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            features.aes = (ecx & bit_AES) != 0;
+            features.pclmul = (ecx & bit_PCLMUL) != 0;
+            features.ssse3 = (ecx & bit_SSSE3) != 0;
+        }
+#endif
+        return features;
+    }();
+    return features;
+}
+
+}
@@ -5,11 +5,77 @@
  */
 
 #include <AK/StringBuilder.h>
+#include <LibCrypto/CPUFeatures.h>
 #include <LibCrypto/Cipher/AES.h>
 
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+namespace AESNI {
+
+// Decryption uses the "equivalent inverse cipher" key schedule that expand_decrypt_key() produces,
+// which is exactly what AESDEC expects.
+[[gnu::target("aes")]] static void encrypt_block(const u8* round_key_bytes, size_t rounds, const u8* in, u8* out)
+{
+    auto* round_keys = reinterpret_cast<const __m128i*>(round_key_bytes);
+    auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), _mm_load_si128(round_keys));
+    for (size_t i = 1; i < rounds; ++i)
+        state = _mm_aesenc_si128(state, _mm_load_si128(round_keys + i));
+    state = _mm_aesenclast_si128(state, _mm_load_si128(round_keys + rounds));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+
+[[gnu::target("aes")]] static void decrypt_block(const u8* round_key_bytes, size_t rounds, const u8* in, u8* out)
+{
+    auto* round_keys = reinterpret_cast<const __m128i*>(round_key_bytes);
+    auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), _mm_load_si128(round_keys));
+    for (size_t i = 1; i < rounds; ++i)
+        state = _mm_aesdec_si128(state, _mm_load_si128(round_keys + i));
+    state = _mm_aesdeclast_si128(state, _mm_load_si128(round_keys + rounds));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+
+// AESENC has a latency of several cycles but can start a new operation every cycle,
+// so independent blocks are pushed through the rounds four at a time.
+[[gnu::target("aes")]] static void encrypt_blocks(const u8* round_key_bytes, size_t rounds, const u8* in, u8* out, size_t count)
+{
+    auto* round_keys = reinterpret_cast<const __m128i*>(round_key_bytes);
+    auto* input = reinterpret_cast<const __m128i*>(in);
+    auto* output = reinterpret_cast<__m128i*>(out);
+
+    size_t block = 0;
+    for (; block + 4 <= count; block += 4) {
+        auto round_key = _mm_load_si128(round_keys);
+        auto state0 = _mm_xor_si128(_mm_loadu_si128(input + block + 0), round_key);
+        auto state1 = _mm_xor_si128(_mm_loadu_si128(input + block + 1), round_key);
+        auto state2 = _mm_xor_si128(_mm_loadu_si128(input + block + 2), round_key);
+        auto state3 = _mm_xor_si128(_mm_loadu_si128(input + block + 3), round_key);
+        for (size_t i = 1; i < rounds; ++i) {
+            round_key = _mm_load_si128(round_keys + i);
+            state0 = _mm_aesenc_si128(state0, round_key);
+            state1 = _mm_aesenc_si128(state1, round_key);
+            state2 = _mm_aesenc_si128(state2, round_key);
+            state3 = _mm_aesenc_si128(state3, round_key);
+        }
+        round_key = _mm_load_si128(round_keys + rounds);
+        _mm_storeu_si128(output + block + 0, _mm_aesenclast_si128(state0, round_key));
+        _mm_storeu_si128(output + block + 1, _mm_aesenclast_si128(state1, round_key));
+        _mm_storeu_si128(output + block + 2, _mm_aesenclast_si128(state2, round_key));
+        _mm_storeu_si128(output + block + 3, _mm_aesenclast_si128(state3, round_key));
+    }
+
+    for (; block < count; ++block)
+        encrypt_block(round_key_bytes, rounds, in + block * 16, out + block * 16);
+}
+
+}
+#endif
+
 template<typename T>
 constexpr u32 get_key(T pt)
 {
@@ -150,6 +216,23 @@ void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
     }
 }
 
+void AESCipherKey::update_hardware_round_keys()
+{
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+    m_has_hardware_round_keys = cpu_features().aes;
+    if (!m_has_hardware_round_keys)
+        return;
+
+    for (size_t i = 0; i < (rounds() + 1) * 4; ++i) {
+        auto word = m_rd_keys[i];
+        m_hardware_round_keys[i * 4 + 0] = word >> 24;
+        m_hardware_round_keys[i * 4 + 1] = word >> 16;
+        m_hardware_round_keys[i * 4 + 2] = word >> 8;
+        m_hardware_round_keys[i * 4 + 3] = word;
+    }
+#endif
+}
+
 void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
 {
     u32* round_key;
@@ -196,6 +279,13 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
 
 void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 {
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+    if (m_key.has_hardware_round_keys()) {
+        AESNI::encrypt_block(m_key.hardware_round_keys(), m_key.rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -288,6 +378,13 @@ void AESCipher::encrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 
 void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
 {
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+    if (m_key.has_hardware_round_keys()) {
+        AESNI::decrypt_block(m_key.hardware_round_keys(), m_key.rounds(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -375,6 +472,20 @@ void AESCipher::decrypt_block(const AESCipherBlock& in, AESCipherBlock& out)
     // clang-format on
 }
 
+void AESCipher::encrypt_blocks(ReadonlyBytes in, Bytes out)
+{
+#ifdef CRYPTO_HAS_X86_ACCELERATION
+    if (m_key.has_hardware_round_keys()) {
+        VERIFY(in.size() % block_size() == 0);
+        VERIFY(out.size() >= in.size());
+        AESNI::encrypt_blocks(m_key.hardware_round_keys(), m_key.rounds(), in.data(), out.data(), in.size() / block_size());
+        return;
+    }
+#endif
+
+    Cipher::encrypt_blocks(in, out);
+}
+
 void AESCipherBlock::overwrite(ReadonlyBytes bytes)
 {
     auto data = bytes.data();
@@ -69,6 +69,7 @@ struct AESCipherKey : public CipherKey {
             expand_encrypt_key(user_key, key_bits);
         else
             expand_decrypt_key(user_key, key_bits);
+        update_hardware_round_keys();
     }
 
     virtual ~AESCipherKey() override { }
@@ -76,6 +77,11 @@ struct AESCipherKey : public CipherKey {
     size_t rounds() const { return m_rounds; }
     size_t length() const { return m_bits / 8; }
 
+    // The round keys in memory byte order, as the AES-NI instructions expect them.
+    // Only available when the CPU supports those instructions.
+    bool has_hardware_round_keys() const { return m_has_hardware_round_keys; }
+    const u8* hardware_round_keys() const { return m_hardware_round_keys; }
+
 protected:
     u32* round_keys()
     {
@@ -83,8 +89,12 @@ protected:
     }
 
 private:
+    void update_hardware_round_keys();
+
     static constexpr size_t MAX_ROUND_COUNT = 14;
     u32 m_rd_keys[(MAX_ROUND_COUNT + 1) * 4] { 0 };
+    alignas(16) u8 m_hardware_round_keys[(MAX_ROUND_COUNT + 1) * 16] { 0 };
+    bool m_has_hardware_round_keys { false };
     size_t m_rounds;
     size_t m_bits;
 };
@@ -108,6 +118,7 @@ public:
 
     virtual void encrypt_block(const BlockType& in, BlockType& out) override;
     virtual void decrypt_block(const BlockType& in, BlockType& out) override;
+    virtual void encrypt_blocks(ReadonlyBytes in, Bytes out) override;
 
     virtual String class_name() const override { return "AES"; }
 
@@ -111,6 +111,20 @@ public:
     virtual void encrypt_block(const BlockType& in, BlockType& out) = 0;
     virtual void decrypt_block(const BlockType& in, BlockType& out) = 0;
 
+    // Encrypts a run of whole blocks. Ciphers that can work on several independent blocks at once should override this.
+    virtual void encrypt_blocks(ReadonlyBytes in, Bytes out)
+    {
+        VERIFY(in.size() % block_size() == 0);
+        VERIFY(out.size() >= in.size());
+
+        BlockType block;
+        for (size_t offset = 0; offset < in.size(); offset += block_size()) {
+            block.overwrite(in.slice(offset, block_size()));
+            encrypt_block(block, block);
+            block.bytes().copy_to(out.slice(offset));
+        }
+    }
+
     virtual String class_name() const = 0;
 
 protected:
@@ -131,9 +131,11 @@ public:
 
 private:
     u8 m_ivec_storage[IVSizeInBits / 8];
-    typename T::BlockType m_cipher_block {};
 
 protected:
+    // How many counter blocks are encrypted together, so that ciphers which can work on several blocks at once get to do so.
+    constexpr static size_t BlocksPerBatch = 8;
+
     constexpr static IncrementFunctionType increment {};
 
     void encrypt_or_stream(const ReadonlyBytes* in, Bytes& out, ReadonlyBytes ivec, Bytes* ivec_out = nullptr)
@@ -155,27 +157,34 @@ protected:
         VERIFY(!ivec.is_empty());
         VERIFY(ivec.size() >= IV_length());
 
-        m_cipher_block.set_padding_mode(cipher.padding_mode());
-
         __builtin_memcpy(m_ivec_storage, ivec.data(), IV_length());
         Bytes iv { m_ivec_storage, IV_length() };
 
         size_t offset { 0 };
-        auto block_size = cipher.block_size();
+        constexpr auto block_size = T::block_size();
+        u8 counter_blocks[BlocksPerBatch * block_size];
+        u8 key_stream[BlocksPerBatch * block_size];
 
         while (length > 0) {
-            m_cipher_block.overwrite(iv.slice(0, block_size));
-
-            cipher.encrypt_block(m_cipher_block, m_cipher_block);
-            if (in) {
-                m_cipher_block.apply_initialization_vector(in->slice(offset));
+            auto block_count = min(BlocksPerBatch, (length + block_size - 1) / block_size);
+            for (size_t i = 0; i < block_count; ++i) {
+                __builtin_memcpy(counter_blocks + i * block_size, iv.data(), block_size);
+                increment(iv);
             }
-            auto write_size = min(block_size, length);
 
+            cipher.encrypt_blocks({ counter_blocks, block_count * block_size }, { key_stream, block_count * block_size });
+
+            auto write_size = min(block_count * block_size, length);
             VERIFY(offset + write_size <= out.size());
-            __builtin_memcpy(out.offset(offset), m_cipher_block.bytes().data(), write_size);
+            if (in) {
+                auto* input = in->offset(offset);
+                auto* output = out.offset(offset);
+                for (size_t i = 0; i < write_size; ++i)
+                    output[i] = input[i] ^ key_stream[i];
+            } else {
+                __builtin_memcpy(out.offset(offset), key_stream, write_size);
+            }
 
-            increment(iv);
             length -= write_size;
             offset += write_size;
         }
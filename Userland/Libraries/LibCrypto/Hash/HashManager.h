@@ -162,11 +162,16 @@ public:
             m_pre_init_buffer.clear();
     }
 
+    // NOTE: The hashes finish their state in place to produce a digest, so we let a copy do it
+    //       and keep going with the original. TLS relies on this for the running handshake hash.
     virtual DigestType peek() override
     {
         return m_algorithm.visit(
             [&](Empty&) -> DigestType { VERIFY_NOT_REACHED(); },
-            [&](auto& hash) -> DigestType { return hash.peek(); });
+            [&](auto& hash) -> DigestType {
+                auto copy = hash;
+                return copy.peek();
+            });
     }
 
     virtual DigestType digest() override
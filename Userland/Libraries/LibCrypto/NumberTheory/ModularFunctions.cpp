@@ -16,6 +16,19 @@ UnsignedBigInteger ModularInverse(const UnsignedBigInteger& a_, const UnsignedBi
     if (b == 1)
         return { 1 };
 
+    // The binary algorithm below only works for an odd modulus, and with a value that is already reduced.
+    if (!(a_ < b))
+        return ModularInverse(a_.divided_by(b).remainder, b);
+
+    if (!b.is_odd()) {
+        // a has to be odd to be invertible here, so go the other way around:
+        // with t = b^-1 mod a, b * t = 1 + k * a, and a * (b - k) = 1 mod b.
+        if (a_ == 1)
+            return { 1 };
+        auto t = ModularInverse(b.divided_by(a_).remainder, a_);
+        return b.minus(b.multiplied_by(t).minus(1).divided_by(a_).quotient);
+    }
+
     UnsignedBigInteger temp_1;
     UnsignedBigInteger temp_2;
     UnsignedBigInteger temp_3;
@@ -106,7 +119,7 @@ UnsignedBigInteger LCM(const UnsignedBigInteger& a, const UnsignedBigInteger& b)
 
     // output = (a / gcd_output) * b
     UnsignedBigIntegerAlgorithms::divide_without_allocation(a, gcd_output, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
-    UnsignedBigIntegerAlgorithms::multiply_without_allocation(temp_quotient, b, temp_1, temp_2, temp_3, output);
+    UnsignedBigIntegerAlgorithms::multiply_without_allocation(temp_quotient, b, temp_1, output);
 
     dbgln_if(NT_DEBUG, "quot: {} rem: {} out: {}", temp_quotient, temp_remainder, output);
 
@@ -153,9 +153,26 @@ RSA::KeyPairType RSA::parse_rsa_key(ReadonlyBytes der)
             }
             auto private_exponent = private_exponent_result.release_value();
 
-            // Drop the rest of the fields on the floor, we don't use them.
-            // FIXME: Actually use them...
-            keypair.private_key = { modulus, move(private_exponent), public_exponent };
+            // The rest of the fields let us use the Chinese remainder theorem for private key operations.
+            // They're only an optimization, so a key that lacks them (or has broken ones) is still usable.
+            Vector<UnsignedBigInteger, 5> crt_parameters;
+            for (size_t i = 0; i < 5; ++i) {
+                auto parameter_result = decoder.read<UnsignedBigInteger>();
+                if (parameter_result.is_error()) {
+                    dbgln_if(RSA_PARSE_DEBUG, "RSA PKCS#1 private key CRT parameters parse failed: {}", parameter_result.error());
+                    break;
+                }
+                crt_parameters.append(parameter_result.release_value());
+            }
+
+            if (crt_parameters.size() == 5) {
+                keypair.private_key = {
+                    modulus, move(private_exponent), public_exponent,
+                    move(crt_parameters[0]), move(crt_parameters[1]), move(crt_parameters[2]), move(crt_parameters[3]), move(crt_parameters[4])
+                };
+            } else {
+                keypair.private_key = { modulus, move(private_exponent), public_exponent };
+            }
             keypair.public_key = { move(modulus), move(public_exponent) };
 
             return keypair;
@@ -223,12 +240,31 @@ void RSA::encrypt(ReadonlyBytes in, Bytes& out)
     }
 }
 
-void RSA::decrypt(ReadonlyBytes in, Bytes& out)
+// value^d % n. With the factors of n at hand, this is computed as two exponentiations
+// with half-size exponents and moduli, whose results are combined with Garner's formula.
+static UnsignedBigInteger private_key_power(RSA::PrivateKeyType const& key, UnsignedBigInteger const& value)
 {
-    // FIXME: Actually use the private key properly
+    if (!key.has_crt_parameters())
+        return NumberTheory::ModularPower(value, key.private_exponent(), key.modulus());
+
+    auto const& p = key.prime_1();
+    auto const& q = key.prime_2();
+    auto m1 = NumberTheory::ModularPower(value, key.exponent_1(), p);
+    auto m2 = NumberTheory::ModularPower(value, key.exponent_2(), q);
 
+    // h = qinv * (m1 - m2) % p
+    auto m2_mod_p = m2 < p ? m2 : m2.divided_by(p).remainder;
+    auto difference = m1 >= m2_mod_p ? m1.minus(m2_mod_p) : m1.plus(p).minus(m2_mod_p);
+    auto h = key.coefficient().multiplied_by(difference).divided_by(p).remainder;
+
+    // m = m2 + h * q
+    return m2.plus(h.multiplied_by(q));
+}
+
+void RSA::decrypt(ReadonlyBytes in, Bytes& out)
+{
     auto in_integer = UnsignedBigInteger::import_data(in.data(), in.size());
-    auto exp = NumberTheory::ModularPower(in_integer, m_private_key.private_exponent(), m_private_key.modulus());
+    auto exp = private_key_power(m_private_key, in_integer);
     auto size = exp.export_data(out);
 
     auto align = m_private_key.length();
@@ -242,7 +278,7 @@ void RSA::decrypt(ReadonlyBytes in, Bytes& out)
 void RSA::sign(ReadonlyBytes in, Bytes& out)
 {
     auto in_integer = UnsignedBigInteger::import_data(in.data(), in.size());
-    auto exp = NumberTheory::ModularPower(in_integer, m_private_key.private_exponent(), m_private_key.modulus());
+    auto exp = private_key_power(m_private_key, in_integer);
     auto size = exp.export_data(out);
     out = out.slice(out.size() - size, size);
 }
@@ -60,6 +60,20 @@ public:
     {
     }
 
+    RSAPrivateKey(Integer n, Integer d, Integer e, Integer p, Integer q, Integer dp, Integer dq, Integer qinv)
+        : m_modulus(move(n))
+        , m_private_exponent(move(d))
+        , m_public_exponent(move(e))
+        , m_prime_1(move(p))
+        , m_prime_2(move(q))
+        , m_exponent_1(move(dp))
+        , m_exponent_2(move(dq))
+        , m_coefficient(move(qinv))
+        , m_length(m_modulus.trimmed_length() * sizeof(u32))
+        , m_has_crt_parameters(true)
+    {
+    }
+
     RSAPrivateKey()
     {
     }
@@ -70,19 +84,35 @@ public:
     size_t length() const { return m_length; }
     void set_length(size_t length) { m_length = length; }
 
+    // The factors of the modulus and the values derived from them (PKCS#1 calls them prime1, prime2,
+    // exponent1, exponent2 and coefficient), which let private key operations use the Chinese remainder theorem.
+    bool has_crt_parameters() const { return m_has_crt_parameters; }
+    const Integer& prime_1() const { return m_prime_1; }
+    const Integer& prime_2() const { return m_prime_2; }
+    const Integer& exponent_1() const { return m_exponent_1; }
+    const Integer& exponent_2() const { return m_exponent_2; }
+    const Integer& coefficient() const { return m_coefficient; }
+
     void set(Integer n, Integer d, Integer e)
     {
         m_modulus = move(n);
         m_private_exponent = move(d);
         m_public_exponent = move(e);
         m_length = m_modulus.trimmed_length() * sizeof(u32);
+        m_has_crt_parameters = false;
     }
 
 private:
     Integer m_modulus;
     Integer m_private_exponent;
     Integer m_public_exponent;
+    Integer m_prime_1;
+    Integer m_prime_2;
+    Integer m_exponent_1;
+    Integer m_exponent_2;
+    Integer m_coefficient;
     size_t m_length { 0 };
+    bool m_has_crt_parameters { false };
 };
 
 template<typename PubKey, typename PrivKey>
@@ -117,9 +147,12 @@ public:
 
         auto d = NumberTheory::ModularInverse(e, lambda);
         dbgln("Your keys are Pub(n={}, e={}) and Priv(n={}, d={})", n, e, n, d);
+        auto dp = d.divided_by(p.minus(1)).remainder;
+        auto dq = d.divided_by(q.minus(1)).remainder;
+        auto qinv = NumberTheory::ModularInverse(q, p);
         RSAKeyPair<PublicKeyType, PrivateKeyType> keys {
             { n, e },
-            { n, d, e }
+            { n, d, e, p, q, move(dp), move(dq), move(qinv) }
         };
         keys.public_key.set_length(bits / 2 / 8);
         keys.private_key.set_length(bits / 2 / 8);
@@ -33,4 +33,14 @@ void DepthBuffer::clear(float depth)
     }
 }
 
+void DepthBuffer::clear(Gfx::IntRect const& rect, float depth)
+{
+    VERIFY(Gfx::IntRect({}, m_size).contains(rect));
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        auto* depth_values = &m_data[y * m_size.width() + rect.left()];
+        for (int x = 0; x < rect.width(); ++x)
+            depth_values[x] = depth;
+    }
+}
+
 }
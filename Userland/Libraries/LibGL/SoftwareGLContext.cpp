@@ -711,6 +711,9 @@ void SoftwareGLContext::gl_tex_image_2d(GLenum target, GLint level, GLint intern
     RETURN_WITH_ERROR_IF((width & 2) != 0 || (height & 2) != 0, GL_INVALID_VALUE);
     RETURN_WITH_ERROR_IF(border < 0 || border > 1, GL_INVALID_VALUE);
 
+    // Triangles that are still queued in the rasterizer might sample from this texture
+    m_rasterizer.wait_for_all_threads();
+
     m_active_texture_unit->bound_texture_2d()->upload_texture_data(target, level, internal_format, width, height, border, format, type, data);
 }
 
@@ -805,14 +808,15 @@ void SoftwareGLContext::gl_flush()
 {
     RETURN_WITH_ERROR_IF(m_in_draw_state, GL_INVALID_OPERATION);
 
-    // No-op since SoftwareGLContext is completely synchronous at the moment
+    // The rasterizer only renders queued triangles on demand, so make sure they are done
+    m_rasterizer.wait_for_all_threads();
 }
 
 void SoftwareGLContext::gl_finish()
 {
     RETURN_WITH_ERROR_IF(m_in_draw_state, GL_INVALID_OPERATION);
 
-    // No-op since SoftwareGLContext is completely synchronous at the moment
+    m_rasterizer.wait_for_all_threads();
 }
 
 void SoftwareGLContext::gl_blend_func(GLenum src_factor, GLenum dst_factor)
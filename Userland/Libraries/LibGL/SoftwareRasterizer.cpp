@@ -6,9 +6,11 @@
 
 #include "SoftwareRasterizer.h"
 #include <AK/Function.h>
+#include <AK/Memory.h>
 #include <LibGfx/Painter.h>
 #include <LibGfx/Vector2.h>
 #include <LibGfx/Vector3.h>
+#include <unistd.h>
 
 namespace GL {
 
@@ -17,6 +19,14 @@ using IntVector3 = Gfx::Vector3<int>;
 
 static constexpr int RASTERIZER_BLOCK_SIZE = 16;
 
+// A 64x64 tile keeps 16 KiB of color and 16 KiB of depth values busy, which fits comfortably into the caches
+static constexpr int RASTERIZER_TILE_SIZE = 64;
+static_assert(RASTERIZER_TILE_SIZE % RASTERIZER_BLOCK_SIZE == 0, "RASTERIZER_TILE_SIZE must be a multiple of RASTERIZER_BLOCK_SIZE");
+
+// Render the queued commands once this many have piled up, so applications that never look at
+// their results don't make us buffer an unbounded amount of work.
+static constexpr size_t RASTERIZER_MAX_QUEUED_COMMANDS = 16384;
+
 constexpr static int edge_function(const IntVector2& a, const IntVector2& b, const IntVector2& c)
 {
     return ((c.x() - a.x()) * (b.y() - a.y()) - (c.y() - a.y()) * (b.x() - a.x()));
@@ -99,13 +109,18 @@ static constexpr void setup_blend_factors(GLenum mode, FloatVector4& constant, f
 }
 
 template<typename PS>
-static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& render_target, DepthBuffer& depth_buffer, const GLTriangle& triangle, PS pixel_shader)
+static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& render_target, DepthBuffer& depth_buffer, const Gfx::IntRect& tile_rect, const GLTriangle& triangle, PS pixel_shader)
 {
     // Since the algorithm is based on blocks of uniform size, we need
     // to ensure that our render_target size is actually a multiple of the block size
     VERIFY((render_target.width() % RASTERIZER_BLOCK_SIZE) == 0);
     VERIFY((render_target.height() % RASTERIZER_BLOCK_SIZE) == 0);
 
+    // The same goes for the tile we're restricted to, which also has to lie within the render_target
+    VERIFY((tile_rect.x() % RASTERIZER_BLOCK_SIZE) == 0 && (tile_rect.width() % RASTERIZER_BLOCK_SIZE) == 0);
+    VERIFY((tile_rect.y() % RASTERIZER_BLOCK_SIZE) == 0 && (tile_rect.height() % RASTERIZER_BLOCK_SIZE) == 0);
+    VERIFY(render_target.rect().contains(tile_rect));
+
     // Calculate area of the triangle for later tests
     IntVector2 v0 { (int)triangle.vertices[0].x, (int)triangle.vertices[0].y };
     IntVector2 v1 { (int)triangle.vertices[1].x, (int)triangle.vertices[1].y };
@@ -176,12 +191,12 @@ static void rasterize_triangle(const RasterizerOptions& options, Gfx::Bitmap& re
             && edges.z() >= zero.z();
     };
 
-    // Calculate block-based bounds
+    // Calculate block-based bounds within the tile
     // clang-format off
-    const int bx0 = max(0,                      min(min(v0.x(), v1.x()), v2.x())                            ) / RASTERIZER_BLOCK_SIZE;
-    const int bx1 = min(render_target.width(),  max(max(v0.x(), v1.x()), v2.x()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
-    const int by0 = max(0,                      min(min(v0.y(), v1.y()), v2.y())                            ) / RASTERIZER_BLOCK_SIZE;
-    const int by1 = min(render_target.height(), max(max(v0.y(), v1.y()), v2.y()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
+    const int bx0 = max(tile_rect.left(),       min(min(v0.x(), v1.x()), v2.x())                            ) / RASTERIZER_BLOCK_SIZE;
+    const int bx1 = min(tile_rect.right() + 1,  max(max(v0.x(), v1.x()), v2.x()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
+    const int by0 = max(tile_rect.top(),        min(min(v0.y(), v1.y()), v2.y())                            ) / RASTERIZER_BLOCK_SIZE;
+    const int by1 = min(tile_rect.bottom() + 1, max(max(v0.y(), v1.y()), v2.y()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
     // clang-format on
 
     static_assert(RASTERIZER_BLOCK_SIZE < sizeof(int) * 8, "RASTERIZER_BLOCK_SIZE must be smaller than the pixel_mask's width in bits");
@@ -408,38 +423,222 @@ static Gfx::IntSize closest_multiple(const Gfx::IntSize& min_size, size_t step)
     return { width, height };
 }
 
-SoftwareRasterizer::SoftwareRasterizer(const Gfx::IntSize& min_size)
+static bool are_same_textures(const Vector<NonnullRefPtr<Texture2D>>& a, const Vector<NonnullRefPtr<Texture2D>>& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].ptr() != b[i].ptr())
+            return false;
+    }
+
+    return true;
+}
+
+SoftwareRasterizer::SoftwareRasterizer(const Gfx::IntSize& min_size, Optional<size_t> render_thread_count)
     : m_render_target { Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, closest_multiple(min_size, RASTERIZER_BLOCK_SIZE)) }
     , m_depth_buffer { adopt_own(*new DepthBuffer(closest_multiple(min_size, RASTERIZER_BLOCK_SIZE))) }
+    , m_render_thread_count(render_thread_count)
+{
+    setup_tiles();
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
 {
+    pthread_mutex_lock(&m_render_threads_mutex);
+    m_render_threads_should_exit = true;
+    pthread_cond_broadcast(&m_work_available);
+    pthread_mutex_unlock(&m_render_threads_mutex);
+
+    for (auto& thread : m_render_threads)
+        [[maybe_unused]] auto result = thread->join();
+
+    pthread_cond_destroy(&m_work_done);
+    pthread_cond_destroy(&m_work_available);
+    pthread_mutex_destroy(&m_render_threads_mutex);
+}
+
+void SoftwareRasterizer::setup_tiles()
+{
+    m_tile_columns = (m_render_target->width() + RASTERIZER_TILE_SIZE - 1) / RASTERIZER_TILE_SIZE;
+    m_tile_rows = (m_render_target->height() + RASTERIZER_TILE_SIZE - 1) / RASTERIZER_TILE_SIZE;
+
+    m_tiles.clear();
+    m_tiles.ensure_capacity(m_tile_columns * m_tile_rows);
+    for (int row = 0; row < m_tile_rows; row++) {
+        for (int column = 0; column < m_tile_columns; column++) {
+            // Tiles at the right and bottom edges get cut off by the render target, which still leaves them a multiple of the block size
+            Gfx::IntRect rect { column * RASTERIZER_TILE_SIZE, row * RASTERIZER_TILE_SIZE, RASTERIZER_TILE_SIZE, RASTERIZER_TILE_SIZE };
+            m_tiles.append({ rect.intersected(m_render_target->rect()), {} });
+        }
+    }
 }
 
 void SoftwareRasterizer::submit_triangle(const GLTriangle& triangle)
 {
-    rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, triangle, [](const FloatVector2&, const FloatVector4& color) -> FloatVector4 {
-        return color;
-    });
+    enqueue_triangle(triangle, {});
 }
 
 void SoftwareRasterizer::submit_triangle(const GLTriangle& triangle, const Array<TextureUnit, 32>& texture_units)
 {
-    rasterize_triangle(m_options, *m_render_target, *m_depth_buffer, triangle, [&texture_units](const FloatVector2& uv, const FloatVector4& color) -> FloatVector4 {
-        // TODO: We'd do some kind of multitexturing/blending here
-        // Construct a vector for the texel we want to sample
-        FloatVector4 texel = color;
+    // Remember which textures are bound right now, since the triangle is rendered later on
+    Vector<NonnullRefPtr<Texture2D>> textures;
+    for (const auto& texture_unit : texture_units) {
 
-        for (const auto& texture_unit : texture_units) {
+        // No texture is bound to this texture unit
+        if (!texture_unit.is_bound())
+            continue;
 
-            // No texture is bound to this texture unit
-            if (!texture_unit.is_bound())
-                continue;
+        // FIXME: Don't assume Texture2D
+        textures.append(*static_ptr_cast<Texture2D>(texture_unit.bound_texture()));
+    }
+
+    enqueue_triangle(triangle, move(textures));
+}
+
+void SoftwareRasterizer::enqueue_triangle(const GLTriangle& triangle, Vector<NonnullRefPtr<Texture2D>>&& textures)
+{
+    IntVector2 v0 { (int)triangle.vertices[0].x, (int)triangle.vertices[0].y };
+    IntVector2 v1 { (int)triangle.vertices[1].x, (int)triangle.vertices[1].y };
+    IntVector2 v2 { (int)triangle.vertices[2].x, (int)triangle.vertices[2].y };
+
+    if (edge_function(v0, v1, v2) == 0)
+        return;
+
+    // Same block-based bounds as rasterize_triangle() uses, so every block it would touch ends up in one of the tiles
+    // clang-format off
+    const int bx0 = max(0,                         min(min(v0.x(), v1.x()), v2.x())                            ) / RASTERIZER_BLOCK_SIZE;
+    const int bx1 = min(m_render_target->width(),  max(max(v0.x(), v1.x()), v2.x()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
+    const int by0 = max(0,                         min(min(v0.y(), v1.y()), v2.y())                            ) / RASTERIZER_BLOCK_SIZE;
+    const int by1 = min(m_render_target->height(), max(max(v0.y(), v1.y()), v2.y()) + RASTERIZER_BLOCK_SIZE - 1) / RASTERIZER_BLOCK_SIZE;
+    // clang-format on
+
+    if (bx0 >= bx1 || by0 >= by1)
+        return;
+
+    constexpr int blocks_per_tile = RASTERIZER_TILE_SIZE / RASTERIZER_BLOCK_SIZE;
+
+    // Consecutive triangles usually share their state, so only store it when it changes
+    if (m_options_changed || m_queued_options.is_empty()) {
+        m_queued_options.append(m_options);
+        m_options_changed = false;
+    }
+    if (m_queued_textures.is_empty() || !are_same_textures(m_queued_textures.last(), textures))
+        m_queued_textures.append(move(textures));
+
+    Command command { Command::Type::DrawTriangle, triangle };
+    command.options_index = m_queued_options.size() - 1;
+    command.textures_index = m_queued_textures.size() - 1;
+    enqueue_command(move(command), bx0 / blocks_per_tile, (bx1 - 1) / blocks_per_tile, by0 / blocks_per_tile, (by1 - 1) / blocks_per_tile);
+}
+
+void SoftwareRasterizer::enqueue_command(Command&& command, int first_tile_column, int last_tile_column, int first_tile_row, int last_tile_row)
+{
+    u32 command_index = m_commands.size();
+    m_commands.append(move(command));
+
+    for (int row = first_tile_row; row <= last_tile_row; row++) {
+        for (int column = first_tile_column; column <= last_tile_column; column++) {
+            size_t tile_index = row * m_tile_columns + column;
+            auto& tile = m_tiles[tile_index];
+            if (tile.commands.is_empty())
+                m_queued_tiles.append(tile_index);
+            tile.commands.append(command_index);
+        }
+    }
 
-            // FIXME: Don't assume Texture2D, _and_ work out how we blend/do multitexturing properly.....
-            texel = texel * static_ptr_cast<Texture2D>(texture_unit.bound_texture())->sample_texel(uv);
+    if (m_commands.size() >= RASTERIZER_MAX_QUEUED_COMMANDS)
+        wait_for_all_threads();
+}
+
+void SoftwareRasterizer::render_tile(Tile& tile)
+{
+    auto& rect = tile.rect;
+
+    for (auto command_index : tile.commands) {
+        auto& command = m_commands[command_index];
+
+        switch (command.type) {
+        case Command::Type::ClearColor:
+            for (int y = rect.top(); y <= rect.bottom(); y++)
+                fast_u32_fill(&m_render_target->scanline(y)[rect.left()], command.clear_color, rect.width());
+            break;
+        case Command::Type::ClearDepth:
+            m_depth_buffer->clear(rect, command.clear_depth);
+            break;
+        case Command::Type::DrawTriangle: {
+            auto& textures = m_queued_textures[command.textures_index];
+            rasterize_triangle(m_queued_options[command.options_index], *m_render_target, *m_depth_buffer, rect, command.triangle, [&textures](const FloatVector2& uv, const FloatVector4& color) -> FloatVector4 {
+                // TODO: We'd do some kind of multitexturing/blending here
+                // Construct a vector for the texel we want to sample
+                FloatVector4 texel = color;
+
+                // FIXME: Work out how we blend/do multitexturing properly.....
+                for (auto& texture : textures)
+                    texel = texel * texture->sample_texel(uv);
+
+                return texel;
+            });
+            break;
         }
+        }
+    }
+
+    tile.commands.clear_with_capacity();
+}
+
+void SoftwareRasterizer::render_queued_tiles()
+{
+    // Tiles are handed out one at a time, so threads that got cheap tiles simply pick up more of them
+    for (;;) {
+        size_t index = m_next_queued_tile.fetch_add(1, AK::memory_order_relaxed);
+        if (index >= m_queued_tiles.size())
+            return;
+        render_tile(m_tiles[m_queued_tiles[index]]);
+    }
+}
+
+void SoftwareRasterizer::start_render_threads()
+{
+    m_render_threads_started = true;
+
+    // The thread waiting for the results renders tiles as well, so we only need helpers for the remaining processors
+    if (!m_render_thread_count.has_value()) {
+        auto processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+        m_render_thread_count = processor_count > 1 ? processor_count - 1 : 0;
+    }
+    for (size_t i = 0; i < *m_render_thread_count; i++) {
+        auto thread = Threading::Thread::construct([this] { return render_thread_main(); }, "GL Rasterizer"sv);
+        thread->start();
+        m_render_threads.append(move(thread));
+    }
+}
+
+intptr_t SoftwareRasterizer::render_thread_main()
+{
+    u64 seen_generation = 0;
+
+    pthread_mutex_lock(&m_render_threads_mutex);
+    for (;;) {
+        while (m_work_generation == seen_generation && !m_render_threads_should_exit)
+            pthread_cond_wait(&m_work_available, &m_render_threads_mutex);
+
+        if (m_render_threads_should_exit)
+            break;
+
+        seen_generation = m_work_generation;
+        pthread_mutex_unlock(&m_render_threads_mutex);
 
-        return texel;
-    });
+        render_queued_tiles();
+
+        pthread_mutex_lock(&m_render_threads_mutex);
+        if (--m_busy_render_threads == 0)
+            pthread_cond_signal(&m_work_done);
+    }
+    pthread_mutex_unlock(&m_render_threads_mutex);
+
+    return 0;
 }
 
 void SoftwareRasterizer::resize(const Gfx::IntSize& min_size)
@@ -448,25 +647,26 @@ void SoftwareRasterizer::resize(const Gfx::IntSize& min_size)
 
     m_render_target = Gfx::Bitmap::try_create(Gfx::BitmapFormat::BGRA8888, closest_multiple(min_size, RASTERIZER_BLOCK_SIZE));
     m_depth_buffer = adopt_own(*new DepthBuffer(m_render_target->size()));
+    setup_tiles();
 }
 
 void SoftwareRasterizer::clear_color(const FloatVector4& color)
 {
-    wait_for_all_threads();
-
     uint8_t r = static_cast<uint8_t>(clamp(color.x(), 0.0f, 1.0f) * 255);
     uint8_t g = static_cast<uint8_t>(clamp(color.y(), 0.0f, 1.0f) * 255);
     uint8_t b = static_cast<uint8_t>(clamp(color.z(), 0.0f, 1.0f) * 255);
     uint8_t a = static_cast<uint8_t>(clamp(color.w(), 0.0f, 1.0f) * 255);
 
-    m_render_target->fill(Gfx::Color(r, g, b, a));
+    Command command { Command::Type::ClearColor, {} };
+    command.clear_color = Gfx::Color(r, g, b, a).value();
+    enqueue_command(move(command), 0, m_tile_columns - 1, 0, m_tile_rows - 1);
 }
 
 void SoftwareRasterizer::clear_depth(float depth)
 {
-    wait_for_all_threads();
-
-    m_depth_buffer->clear(depth);
+    Command command { Command::Type::ClearDepth, {} };
+    command.clear_depth = depth;
+    enqueue_command(move(command), 0, m_tile_columns - 1, 0, m_tile_rows - 1);
 }
 
 void SoftwareRasterizer::blit_to(Gfx::Bitmap& target)
@@ -477,22 +677,52 @@ void SoftwareRasterizer::blit_to(Gfx::Bitmap& target)
     painter.blit({ 0, 0 }, *m_render_target, m_render_target->rect(), 1.0f, false);
 }
 
-void SoftwareRasterizer::wait_for_all_threads() const
+void SoftwareRasterizer::wait_for_all_threads()
 {
-    // FIXME: Wait for all render threads to finish when multithreading is being implemented
+    if (m_queued_tiles.is_empty())
+        return;
+
+    m_next_queued_tile = 0;
+
+    // A single tile is not worth waking up any other threads for
+    if (m_queued_tiles.size() > 1 && !m_render_threads_started)
+        start_render_threads();
+
+    if (m_queued_tiles.size() > 1 && !m_render_threads.is_empty()) {
+        pthread_mutex_lock(&m_render_threads_mutex);
+        m_busy_render_threads = m_render_threads.size();
+        m_work_generation++;
+        pthread_cond_broadcast(&m_work_available);
+        pthread_mutex_unlock(&m_render_threads_mutex);
+
+        render_queued_tiles();
+
+        pthread_mutex_lock(&m_render_threads_mutex);
+        while (m_busy_render_threads > 0)
+            pthread_cond_wait(&m_work_done, &m_render_threads_mutex);
+        pthread_mutex_unlock(&m_render_threads_mutex);
+    } else {
+        render_queued_tiles();
+    }
+
+    m_queued_tiles.clear_with_capacity();
+    m_commands.clear_with_capacity();
+    m_queued_options.clear_with_capacity();
+    m_queued_textures.clear_with_capacity();
+    m_options_changed = true;
 }
 
 void SoftwareRasterizer::set_options(const RasterizerOptions& options)
 {
-    wait_for_all_threads();
-
+    // Queued triangles keep the options they were submitted with, so there's no need to render them first
     m_options = options;
-
-    // FIXME: Recreate or reinitialize render threads here when multithreading is being implemented
+    m_options_changed = true;
 }
 
 Gfx::RGBA32 SoftwareRasterizer::get_backbuffer_pixel(int x, int y)
 {
+    wait_for_all_threads();
+
     // FIXME: Reading individual pixels is very slow, rewrite this to transfer whole blocks
     if (x < 0 || y < 0 || x >= m_render_target->width() || y >= m_render_target->height())
         return 0;
@@ -502,6 +732,8 @@ Gfx::RGBA32 SoftwareRasterizer::get_backbuffer_pixel(int x, int y)
 
 float SoftwareRasterizer::get_depthbuffer_value(int x, int y)
 {
+    wait_for_all_threads();
+
     // FIXME: Reading individual pixels is very slow, rewrite this to transfer whole blocks
     if (x < 0 || y < 0 || x >= m_render_target->width() || y >= m_render_target->height())
         return 1.0f;
@@ -12,9 +12,16 @@
 #include "Tex/Texture2D.h"
 #include "Tex/TextureUnit.h"
 #include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
 #include <AK/OwnPtr.h>
+#include <AK/Vector.h>
 #include <LibGfx/Bitmap.h>
 #include <LibGfx/Vector4.h>
+#include <LibThreading/Thread.h>
+#include <pthread.h>
 
 namespace GL {
 
@@ -29,9 +36,17 @@ struct RasterizerOptions {
     GLenum blend_destination_factor { GL_ONE };
 };
 
+// Triangles and clears are not rendered right away, but sorted into bins of the screen tiles they
+// touch. Once the results are needed, each tile works through its own bin while its part of the
+// color and depth buffers stays in cache, and separate tiles are rendered on separate threads.
 class SoftwareRasterizer final {
+    AK_MAKE_NONCOPYABLE(SoftwareRasterizer);
+    AK_MAKE_NONMOVABLE(SoftwareRasterizer);
+
 public:
-    SoftwareRasterizer(const Gfx::IntSize& min_size);
+    // Without an explicit count, a render thread is started for every processor but the first one.
+    SoftwareRasterizer(const Gfx::IntSize& min_size, Optional<size_t> render_thread_count = {});
+    ~SoftwareRasterizer();
 
     void submit_triangle(const GLTriangle& triangle, const Array<TextureUnit, 32>& texture_units);
     void submit_triangle(const GLTriangle& triangle);
@@ -39,16 +54,64 @@ public:
     void clear_color(const FloatVector4&);
     void clear_depth(float);
     void blit_to(Gfx::Bitmap&);
-    void wait_for_all_threads() const;
+    void wait_for_all_threads();
     void set_options(const RasterizerOptions&);
     RasterizerOptions options() const { return m_options; }
     Gfx::RGBA32 get_backbuffer_pixel(int x, int y);
     float get_depthbuffer_value(int x, int y);
 
 private:
+    struct Command {
+        enum class Type {
+            DrawTriangle,
+            ClearColor,
+            ClearDepth,
+        };
+
+        Type type;
+        GLTriangle triangle;
+        size_t options_index { 0 };
+        size_t textures_index { 0 };
+        Gfx::RGBA32 clear_color { 0 };
+        float clear_depth { 0 };
+    };
+
+    struct Tile {
+        Gfx::IntRect rect;
+        Vector<u32> commands;
+    };
+
+    void setup_tiles();
+    void enqueue_triangle(const GLTriangle&, Vector<NonnullRefPtr<Texture2D>>&& textures);
+    void enqueue_command(Command&&, int first_tile_column, int last_tile_column, int first_tile_row, int last_tile_row);
+    void render_queued_tiles();
+    void render_tile(Tile&);
+    void start_render_threads();
+    intptr_t render_thread_main();
+
     RefPtr<Gfx::Bitmap> m_render_target;
     OwnPtr<DepthBuffer> m_depth_buffer;
     RasterizerOptions m_options;
+    bool m_options_changed { true };
+
+    Vector<Tile> m_tiles;
+    int m_tile_columns { 0 };
+    int m_tile_rows { 0 };
+    Vector<size_t> m_queued_tiles;
+    Atomic<size_t> m_next_queued_tile { 0 };
+    Vector<Command> m_commands;
+    Vector<RasterizerOptions> m_queued_options;
+    Vector<Vector<NonnullRefPtr<Texture2D>>> m_queued_textures;
+
+    Optional<size_t> m_render_thread_count;
+    Vector<NonnullRefPtr<Threading::Thread>> m_render_threads;
+    bool m_render_threads_started { false };
+    pthread_mutex_t m_render_threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t m_work_available = PTHREAD_COND_INITIALIZER;
+    pthread_cond_t m_work_done = PTHREAD_COND_INITIALIZER;
+    u64 m_work_generation { 0 };
+    size_t m_busy_render_threads { 0 };
+    bool m_render_threads_should_exit { false };
 };
 
 }
@@ -13,6 +13,7 @@
 #include <AK/TemporaryChange.h>
 #include <LibCrypto/BigInt/SignedBigInteger.h>
 #include <LibJS/AST.h>
+#include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/AbstractOperations.h>
 #include <LibJS/Runtime/Accessor.h>
@@ -2420,6 +2421,22 @@ Value DebuggerStatement::execute(Interpreter& interpreter, GlobalObject&) const
     return {};
 }
 
+ScopeNode::ScopeNode(SourceRange source_range)
+    : Statement(source_range)
+{
+}
+
+ScopeNode::~ScopeNode()
+{
+}
+
+Bytecode::Executable const& ScopeNode::set_bytecode_executable(NonnullOwnPtr<Bytecode::Executable> executable) const
+{
+    VERIFY(!m_bytecode_executable);
+    m_bytecode_executable = move(executable);
+    return *m_bytecode_executable;
+}
+
 void ScopeNode::add_variables(NonnullRefPtrVector<VariableDeclaration> variables)
 {
     m_variables.extend(move(variables));
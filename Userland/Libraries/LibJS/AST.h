@@ -9,6 +9,7 @@
 
 #include <AK/FlyString.h>
 #include <AK/HashMap.h>
+#include <AK/HashTable.h>
 #include <AK/NonnullRefPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/RefPtr.h>
@@ -151,11 +152,23 @@ public:
     NonnullRefPtrVector<FunctionDeclaration> const& functions() const { return m_functions; }
     NonnullRefPtrVector<FunctionDeclaration> const& hoisted_functions() const { return m_hoisted_functions; }
 
-protected:
-    explicit ScopeNode(SourceRange source_range)
-        : Statement(source_range)
+    // Filled in by the parser for function bodies.
+    void set_variable_access_info(HashTable<FlyString> names_referenced_by_nested_functions, bool has_dynamic_variable_access)
     {
+        m_names_referenced_by_nested_functions = move(names_referenced_by_nested_functions);
+        m_has_dynamic_variable_access = has_dynamic_variable_access;
     }
+    HashTable<FlyString> const& names_referenced_by_nested_functions() const { return m_names_referenced_by_nested_functions; }
+    bool has_dynamic_variable_access() const { return m_has_dynamic_variable_access; }
+
+    // The bytecode for a function body is generated when it's first called, and then shared
+    // by every function object created from the same body.
+    Bytecode::Executable const* bytecode_executable() const { return m_bytecode_executable.ptr(); }
+    Bytecode::Executable const& set_bytecode_executable(NonnullOwnPtr<Bytecode::Executable>) const;
+
+protected:
+    explicit ScopeNode(SourceRange);
+    virtual ~ScopeNode() override;
 
 private:
     virtual bool is_scope_node() const final { return true; }
@@ -164,6 +177,9 @@ private:
     NonnullRefPtrVector<VariableDeclaration> m_variables;
     NonnullRefPtrVector<FunctionDeclaration> m_functions;
     NonnullRefPtrVector<FunctionDeclaration> m_hoisted_functions;
+    HashTable<FlyString> m_names_referenced_by_nested_functions;
+    bool m_has_dynamic_variable_access { true };
+    mutable OwnPtr<Bytecode::Executable> m_bytecode_executable;
 };
 
 class Program final : public ScopeNode {
@@ -26,9 +26,25 @@ void ASTNode::generate_bytecode(Bytecode::Generator&) const
 
 void ScopeNode::generate_bytecode(Bytecode::Generator& generator) const
 {
+    bool is_nested_scope = !generator.is_function_body(*this);
+    if (is_nested_scope) {
+        generator.begin_lexical_scope();
+        for (auto& function : functions())
+            generator.declare_lexical_binding(function.name());
+        for (auto& declaration : variables()) {
+            for (auto& declarator : declaration.declarations()) {
+                declarator.target().visit(
+                    [&](NonnullRefPtr<Identifier> const& id) { generator.declare_lexical_binding(id->string()); },
+                    [&](NonnullRefPtr<BindingPattern> const& binding) {
+                        binding->for_each_bound_name([&](auto const& name) { generator.declare_lexical_binding(name); });
+                    });
+            }
+        }
+    }
+
     for (auto& function : functions()) {
         generator.emit<Bytecode::Op::NewFunction>(function);
-        generator.emit<Bytecode::Op::SetVariable>(generator.intern_string(function.name()));
+        generator.emit_set_variable(function.name());
     }
 
     HashMap<u32, Variable> scope_variables_with_declaration_kind;
@@ -49,13 +65,19 @@ void ScopeNode::generate_bytecode(Bytecode::Generator& generator) const
                         });
                     });
             } else {
+                auto declare = [&](FlyString const& name) {
+                    // Local variables live in registers, so there's nothing to put in the environment.
+                    if (generator.is_local_variable(name))
+                        return;
+                    scope_variables_with_declaration_kind.set((size_t)generator.intern_string(name).value(), { js_undefined(), declaration.declaration_kind() });
+                };
                 declarator.target().visit(
                     [&](const NonnullRefPtr<Identifier>& id) {
-                        scope_variables_with_declaration_kind.set((size_t)generator.intern_string(id->string()).value(), { js_undefined(), declaration.declaration_kind() });
+                        declare(id->string());
                     },
                     [&](const NonnullRefPtr<BindingPattern>& binding) {
                         binding->for_each_bound_name([&](const auto& name) {
-                            scope_variables_with_declaration_kind.set((size_t)generator.intern_string(name).value(), { js_undefined(), declaration.declaration_kind() });
+                            declare(name);
                         });
                     });
             }
@@ -71,6 +93,9 @@ void ScopeNode::generate_bytecode(Bytecode::Generator& generator) const
         if (generator.is_current_block_terminated())
             break;
     }
+
+    if (is_nested_scope)
+        generator.end_lexical_scope();
 }
 
 void EmptyStatement::generate_bytecode(Bytecode::Generator&) const
@@ -160,6 +185,8 @@ void BinaryExpression::generate_bytecode(Bytecode::Generator& generator) const
     default:
         VERIFY_NOT_REACHED();
     }
+
+    generator.free_register(lhs_reg);
 }
 
 void LogicalExpression::generate_bytecode(Bytecode::Generator& generator) const
@@ -267,7 +294,7 @@ void RegExpLiteral::generate_bytecode(Bytecode::Generator& generator) const
 
 void Identifier::generate_bytecode(Bytecode::Generator& generator) const
 {
-    generator.emit<Bytecode::Op::GetVariable>(generator.intern_string(m_string));
+    generator.emit_get_variable(m_string);
 }
 
 void AssignmentExpression::generate_bytecode(Bytecode::Generator& generator) const
@@ -279,7 +306,7 @@ void AssignmentExpression::generate_bytecode(Bytecode::Generator& generator) con
 
         if (m_op == AssignmentOp::Assignment) {
             m_rhs->generate_bytecode(generator);
-            generator.emit<Bytecode::Op::SetVariable>(generator.intern_string(identifier.string()));
+            generator.emit_set_variable(identifier.string());
             return;
         }
 
@@ -366,7 +393,9 @@ void AssignmentExpression::generate_bytecode(Bytecode::Generator& generator) con
             TODO();
         }
 
-        generator.emit<Bytecode::Op::SetVariable>(generator.intern_string(identifier.string()));
+        generator.free_register(lhs_reg);
+
+        generator.emit_set_variable(identifier.string());
 
         if (end_block_ptr) {
             generator.emit<Bytecode::Op::Jump>().set_targets(
@@ -508,6 +537,18 @@ void ForStatement::generate_bytecode(Bytecode::Generator& generator) const
 
     auto& end_block = generator.make_block();
 
+    bool has_lexical_declaration = m_init && is<VariableDeclaration>(*m_init) && static_cast<VariableDeclaration const&>(*m_init).declaration_kind() != DeclarationKind::Var;
+    if (has_lexical_declaration) {
+        generator.begin_lexical_scope();
+        for (auto& declarator : static_cast<VariableDeclaration const&>(*m_init).declarations()) {
+            declarator.target().visit(
+                [&](NonnullRefPtr<Identifier> const& id) { generator.declare_lexical_binding(id->string()); },
+                [&](NonnullRefPtr<BindingPattern> const& binding) {
+                    binding->for_each_bound_name([&](auto const& name) { generator.declare_lexical_binding(name); });
+                });
+        }
+    }
+
     if (m_init)
         m_init->generate_bytecode(generator);
 
@@ -563,6 +604,9 @@ void ForStatement::generate_bytecode(Bytecode::Generator& generator) const
         generator.switch_to_basic_block(end_block);
         generator.emit<Bytecode::Op::Load>(result_reg);
     }
+
+    if (has_lexical_declaration)
+        generator.end_lexical_scope();
 }
 
 void ObjectExpression::generate_bytecode(Bytecode::Generator& generator) const
@@ -659,10 +703,9 @@ static void generate_object_binding_pattern_bytecode(Bytecode::Generator& genera
             VERIFY(!initializer);
 
             auto identifier = name.get<NonnullRefPtr<Identifier>>()->string();
-            auto interned_identifier = generator.intern_string(identifier);
 
             generator.emit_with_extra_register_slots<Bytecode::Op::CopyObjectExcludingProperties>(excluded_property_names.size(), value_reg, excluded_property_names);
-            generator.emit<Bytecode::Op::SetVariable>(interned_identifier);
+            generator.emit_set_variable(identifier);
 
             return;
         }
@@ -723,10 +766,10 @@ static void generate_object_binding_pattern_bytecode(Bytecode::Generator& genera
                 TODO();
             }
 
-            generator.emit<Bytecode::Op::SetVariable>(name_index);
+            generator.emit_set_variable(name.get<NonnullRefPtr<Identifier>>()->string());
         } else {
             auto& identifier = alias.get<NonnullRefPtr<Identifier>>()->string();
-            generator.emit<Bytecode::Op::SetVariable>(generator.intern_string(identifier));
+            generator.emit_set_variable(identifier);
         }
     }
 }
@@ -770,8 +813,7 @@ static void generate_array_binding_pattern_bytecode(Bytecode::Generator& generat
                 // This element is an elision
             },
             [&](NonnullRefPtr<Identifier> const& identifier) {
-                auto interned_index = generator.intern_string(identifier->string());
-                generator.emit<Bytecode::Op::SetVariable>(interned_index);
+                generator.emit_set_variable(identifier->string());
             },
             [&](NonnullRefPtr<BindingPattern> const& pattern) {
                 // Store the accumulator value in a permanent register
@@ -899,7 +941,7 @@ void VariableDeclaration::generate_bytecode(Bytecode::Generator& generator) cons
             generator.emit<Bytecode::Op::LoadImmediate>(js_undefined());
         declarator.target().visit(
             [&](NonnullRefPtr<Identifier> const& id) {
-                generator.emit<Bytecode::Op::SetVariable>(generator.intern_string(id->string()));
+                generator.emit_set_variable(id->string());
             },
             [&](NonnullRefPtr<BindingPattern> const& pattern) {
                 auto value_register = generator.allocate_register();
@@ -957,6 +999,11 @@ void CallExpression::generate_bytecode(Bytecode::Generator& generator) const
     }
 
     generator.emit_with_extra_register_slots<Bytecode::Op::Call>(argument_registers.size(), call_type, callee_reg, this_reg, argument_registers);
+
+    for (auto& argument_register : argument_registers)
+        generator.free_register(argument_register);
+    generator.free_register(this_reg);
+    generator.free_register(callee_reg);
 }
 
 void ReturnStatement::generate_bytecode(Bytecode::Generator& generator) const
@@ -1153,7 +1200,7 @@ void UpdateExpression::generate_bytecode(Bytecode::Generator& generator) const
 {
     if (is<Identifier>(*m_argument)) {
         auto& identifier = static_cast<Identifier const&>(*m_argument);
-        generator.emit<Bytecode::Op::GetVariable>(generator.intern_string(identifier.string()));
+        generator.emit_get_variable(identifier.string());
 
         Optional<Bytecode::Register> previous_value_for_postfix_reg;
         if (!m_prefixed) {
@@ -1166,7 +1213,7 @@ void UpdateExpression::generate_bytecode(Bytecode::Generator& generator) const
         else
             generator.emit<Bytecode::Op::Decrement>();
 
-        generator.emit<Bytecode::Op::SetVariable>(generator.intern_string(identifier.string()));
+        generator.emit_set_variable(identifier.string());
 
         if (!m_prefixed)
             generator.emit<Bytecode::Op::Load>(*previous_value_for_postfix_reg);
@@ -1219,7 +1266,7 @@ void TryStatement::generate_bytecode(Bytecode::Generator& generator) const
             [&](FlyString const& parameter) {
                 if (parameter.is_empty()) {
                     // FIXME: We need a separate DeclarativeEnvironment here
-                    generator.emit<Bytecode::Op::SetVariable>(generator.intern_string(parameter));
+                    generator.emit_set_variable(parameter);
                 }
             },
             [&](NonnullRefPtr<BindingPattern> const&) {
@@ -1227,7 +1274,12 @@ void TryStatement::generate_bytecode(Bytecode::Generator& generator) const
                 TODO();
             });
 
+        generator.begin_lexical_scope();
+        m_handler->parameter().visit(
+            [&](FlyString const& parameter) { generator.declare_lexical_binding(parameter); },
+            [&](NonnullRefPtr<BindingPattern> const&) {});
         m_handler->body().generate_bytecode(generator);
+        generator.end_lexical_scope();
         handler_target = Bytecode::Label { handler_block };
         if (!generator.is_current_block_terminated()) {
             if (m_finalizer) {
@@ -1313,7 +1365,7 @@ void SwitchStatement::generate_bytecode(Bytecode::Generator& generator) const
 void ClassDeclaration::generate_bytecode(Bytecode::Generator& generator) const
 {
     generator.emit<Bytecode::Op::NewClass>(m_class_expression);
-    generator.emit<Bytecode::Op::SetVariable>(generator.intern_string(m_class_expression.ptr()->name()));
+    generator.emit_set_variable(m_class_expression.ptr()->name());
 }
 
 }
@@ -64,6 +64,36 @@ void BasicBlock::grow(size_t additional_size)
     VERIFY(m_buffer_size <= m_buffer_capacity);
 }
 
+void BasicBlock::remove_instructions(size_t offset, size_t size)
+{
+    destroy_instructions(offset, size);
+    move_instructions_down(offset + size, offset);
+}
+
+void BasicBlock::forget_instructions(size_t size)
+{
+    move_instructions_down(size, 0);
+}
+
+void BasicBlock::destroy_instructions(size_t offset, size_t size)
+{
+    VERIFY(offset + size <= m_buffer_size);
+    Bytecode::InstructionStreamIterator it(instruction_stream().slice(offset, size));
+    while (!it.at_end()) {
+        auto& to_destroy = (*it);
+        ++it;
+        Instruction::destroy(const_cast<Instruction&>(to_destroy));
+    }
+}
+
+void BasicBlock::move_instructions_down(size_t from_offset, size_t to_offset)
+{
+    VERIFY(to_offset <= from_offset && from_offset <= m_buffer_size);
+    // NOTE: Instructions don't point into themselves, so it's fine to relocate them byte-wise.
+    __builtin_memmove(m_buffer + to_offset, m_buffer + from_offset, m_buffer_size - from_offset);
+    m_buffer_size -= from_offset - to_offset;
+}
+
 void InstructionStreamIterator::operator++()
 {
     VERIFY(!at_end());
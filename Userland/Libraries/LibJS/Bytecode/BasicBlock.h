@@ -60,6 +60,20 @@ public:
     bool can_grow(size_t additional_size) const { return m_buffer_size + additional_size <= m_buffer_capacity; }
     void grow(size_t additional_size);
 
+    // NOTE: These are meant for optimization passes, and invalidate any offsets into the instruction stream past `offset`.
+    void remove_instructions(size_t offset, size_t size);
+    // Drops the first `size` bytes of instructions without destroying them, for when they were copied into another block.
+    void forget_instructions(size_t size);
+    template<typename OpType, typename... Args>
+    void replace_instructions(size_t offset, size_t size, Args&&... args)
+    {
+        static_assert(!OpType::IsTerminator);
+        VERIFY(sizeof(OpType) <= size);
+        destroy_instructions(offset, size);
+        move_instructions_down(offset + size, offset + sizeof(OpType));
+        new (m_buffer + offset) OpType(forward<Args>(args)...);
+    }
+
     void terminate(Badge<Generator>) { m_is_terminated = true; }
     bool is_terminated() const { return m_is_terminated; }
 
@@ -68,6 +82,9 @@ public:
 private:
     BasicBlock(String name, size_t size);
 
+    void destroy_instructions(size_t offset, size_t size);
+    void move_instructions_down(size_t from_offset, size_t to_offset);
+
     u8* m_buffer { nullptr };
     size_t m_buffer_capacity { 0 };
     size_t m_buffer_size { 0 };
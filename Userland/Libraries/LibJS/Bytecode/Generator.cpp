@@ -25,26 +25,133 @@ Generator::~Generator()
 Executable Generator::generate(ASTNode const& node, bool is_in_generator_function)
 {
     Generator generator;
-    generator.switch_to_basic_block(generator.make_block());
+    return generator.generate_executable(node, is_in_generator_function, {});
+}
+
+Executable Generator::generate_function(ScopeNode const& body, Vector<FlyString> const& parameter_names, bool is_in_generator_function)
+{
+    Generator generator;
+    generator.allocate_local_variables(body, parameter_names);
+    return generator.generate_executable(body, is_in_generator_function, parameter_names);
+}
+
+Executable Generator::generate_executable(ASTNode const& node, bool is_in_generator_function, Vector<FlyString> const& parameter_names)
+{
+    switch_to_basic_block(make_block());
+
+    // Locals start out as undefined, except for parameters, which have already been bound in the function environment.
+    for (auto& it : m_local_variables) {
+        if (parameter_names.contains_slow(it.key))
+            continue;
+        emit<Bytecode::Op::LoadImmediate>(js_undefined());
+        emit<Bytecode::Op::Store>(it.value);
+    }
+    for (auto& name : parameter_names) {
+        auto local = m_local_variables.get(name);
+        if (!local.has_value())
+            continue;
+        emit<Bytecode::Op::GetVariable>(intern_string(name));
+        emit<Bytecode::Op::Store>(*local);
+    }
+
     if (is_in_generator_function) {
-        generator.enter_generator_context();
+        enter_generator_context();
         // Immediately yield with no value.
-        auto& start_block = generator.make_block();
-        generator.emit<Bytecode::Op::Yield>(Label { start_block });
-        generator.switch_to_basic_block(start_block);
+        auto& start_block = make_block();
+        emit<Bytecode::Op::Yield>(Label { start_block });
+        switch_to_basic_block(start_block);
     }
-    node.generate_bytecode(generator);
+    node.generate_bytecode(*this);
     if (is_in_generator_function) {
         // Terminate all unterminated blocks with yield return
-        for (auto& block : generator.m_root_basic_blocks) {
+        for (auto& block : m_root_basic_blocks) {
             if (block.is_terminated())
                 continue;
-            generator.switch_to_basic_block(block);
-            generator.emit<Bytecode::Op::LoadImmediate>(js_undefined());
-            generator.emit<Bytecode::Op::Yield>(nullptr);
+            switch_to_basic_block(block);
+            emit<Bytecode::Op::LoadImmediate>(js_undefined());
+            emit<Bytecode::Op::Yield>(nullptr);
+        }
+    }
+    return { move(m_root_basic_blocks), move(m_string_table), m_next_register };
+}
+
+void Generator::allocate_local_variables(ScopeNode const& body, Vector<FlyString> const& parameter_names)
+{
+    m_function_body = &body;
+    if (body.has_dynamic_variable_access())
+        return;
+
+    auto& captured_names = body.names_referenced_by_nested_functions();
+    auto add_local_variable = [&](FlyString const& name) {
+        if (captured_names.contains(name) || m_local_variables.contains(name))
+            return;
+        m_local_variables.set(name, allocate_register());
+    };
+
+    for (auto& name : parameter_names)
+        add_local_variable(name);
+
+    HashTable<FlyString> constants;
+    for (auto& declaration : body.variables()) {
+        for (auto& declarator : declaration.declarations()) {
+            declarator.target().visit(
+                [&](NonnullRefPtr<Identifier> const& id) {
+                    if (declaration.declaration_kind() == DeclarationKind::Const)
+                        constants.set(id->string());
+                    else
+                        add_local_variable(id->string());
+                },
+                [&](NonnullRefPtr<BindingPattern> const& binding) {
+                    binding->for_each_bound_name([&](auto const& name) {
+                        if (declaration.declaration_kind() == DeclarationKind::Const)
+                            constants.set(name);
+                        else
+                            add_local_variable(name);
+                    });
+                });
         }
     }
-    return { move(generator.m_root_basic_blocks), move(generator.m_string_table), generator.m_next_register };
+
+    // Constants stay in the environment, which knows how to reject assignments to them.
+    // Functions declared in the body are bound in the environment as well.
+    for (auto& name : constants)
+        m_local_variables.remove(name);
+    for (auto& function : body.functions())
+        m_local_variables.remove(function.name());
+}
+
+Optional<Register> Generator::local_variable(FlyString const& name) const
+{
+    for (auto& scope : m_lexical_scopes) {
+        if (scope.contains(name))
+            return {};
+    }
+    return m_local_variables.get(name);
+}
+
+void Generator::declare_lexical_binding(FlyString const& name)
+{
+    VERIFY(!m_lexical_scopes.is_empty());
+    if (m_local_variables.contains(name))
+        m_lexical_scopes.last().set(name);
+}
+
+void Generator::emit_get_variable(FlyString const& name)
+{
+    if (auto local = local_variable(name); local.has_value()) {
+        emit<Bytecode::Op::Load>(*local);
+        return;
+    }
+    emit<Bytecode::Op::GetVariable>(intern_string(name));
+}
+
+void Generator::emit_set_variable(FlyString const& name)
+{
+    if (auto local = local_variable(name); local.has_value()) {
+        emit<Bytecode::Op::Store>(*local);
+        return;
+    }
+    emit<Bytecode::Op::SetVariable>(intern_string(name));
 }
 
 void Generator::grow(size_t additional_size)
@@ -61,10 +168,18 @@ void* Generator::next_slot()
 
 Register Generator::allocate_register()
 {
+    if (!m_free_registers.is_empty())
+        return m_free_registers.take_last();
     VERIFY(m_next_register != NumericLimits<u32>::max());
     return Register { m_next_register++ };
 }
 
+void Generator::free_register(Register reg)
+{
+    VERIFY(reg.index() > Register::global_object_index && reg.index() < m_next_register);
+    m_free_registers.append(reg);
+}
+
 Label Generator::nearest_continuable_scope() const
 {
     return m_continuable_scopes.last();
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <AK/FlyString.h>
+#include <AK/HashMap.h>
 #include <AK/NonnullOwnPtrVector.h>
 #include <AK/OwnPtr.h>
 #include <AK/SinglyLinkedList.h>
@@ -29,8 +31,12 @@ struct Executable {
 class Generator {
 public:
     static Executable generate(ASTNode const&, bool is_in_generator_function = false);
+    static Executable generate_function(ScopeNode const& body, Vector<FlyString> const& parameter_names, bool is_in_generator_function);
 
     Register allocate_register();
+    // Hands a register back for reuse by a later allocate_register() call.
+    // NOTE: Only do this once no emitted instruction can read the register's current value anymore.
+    void free_register(Register);
 
     void ensure_enough_space(size_t size)
     {
@@ -109,6 +115,18 @@ public:
         return m_string_table->insert(string);
     }
 
+    // Variables that nothing outside the function can see live in registers instead of the environment.
+    void emit_get_variable(FlyString const& name);
+    void emit_set_variable(FlyString const& name);
+    bool is_local_variable(FlyString const& name) const { return local_variable(name).has_value(); }
+
+    // A binding declared in a scope nested in the function body shadows any local of the same name
+    // until the end of that scope, so it stays in the environment.
+    bool is_function_body(ScopeNode const& node) const { return &node == m_function_body; }
+    void begin_lexical_scope() { m_lexical_scopes.empend(); }
+    void declare_lexical_binding(FlyString const& name);
+    void end_lexical_scope() { m_lexical_scopes.take_last(); }
+
     bool is_in_generator_function() const { return m_is_in_generator_function; }
     void enter_generator_context() { m_is_in_generator_function = true; }
     void leave_generator_context() { m_is_in_generator_function = false; }
@@ -117,6 +135,10 @@ private:
     Generator();
     ~Generator();
 
+    Executable generate_executable(ASTNode const&, bool is_in_generator_function, Vector<FlyString> const& parameter_names);
+    void allocate_local_variables(ScopeNode const& body, Vector<FlyString> const& parameter_names);
+    Optional<Register> local_variable(FlyString const& name) const;
+
     void grow(size_t);
     void* next_slot();
 
@@ -125,6 +147,10 @@ private:
     NonnullOwnPtr<StringTable> m_string_table;
 
     u32 m_next_register { 2 };
+    Vector<Register> m_free_registers;
+    HashMap<FlyString, Register> m_local_variables;
+    ScopeNode const* m_function_body { nullptr };
+    Vector<HashTable<FlyString>> m_lexical_scopes;
     u32 m_next_block { 1 };
     bool m_is_in_generator_function { false };
     Vector<Label> m_continuable_scopes;
@@ -59,61 +59,21 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
     }
 
     auto block = entry_point ?: &executable.basic_blocks.first();
-    if (m_manually_entered_frames) {
+    // Only the run() that immediately follows enter_frame() runs in that frame, any calls it makes get their own.
+    bool runs_in_manually_entered_frame = exchange(m_has_unused_manually_entered_frame, false);
+    if (runs_in_manually_entered_frame) {
         VERIFY(registers().size() >= executable.number_of_registers);
     } else {
-        m_register_windows.append(make<RegisterWindow>());
-        registers().resize(executable.number_of_registers);
+        push_register_window(executable.number_of_registers);
         registers()[Register::global_object_index] = Value(&global_object());
     }
 
-    for (;;) {
-        Bytecode::InstructionStreamIterator pc(block->instruction_stream());
-        bool will_jump = false;
-        bool will_return = false;
-        while (!pc.at_end()) {
-            auto& instruction = *pc;
-            instruction.execute(*this);
-            if (vm().exception()) {
-                m_saved_exception = {};
-                if (m_unwind_contexts.is_empty())
-                    break;
-                auto& unwind_context = m_unwind_contexts.last();
-                if (unwind_context.handler) {
-                    block = unwind_context.handler;
-                    unwind_context.handler = nullptr;
-                    accumulator() = vm().exception()->value();
-                    vm().clear_exception();
-                    will_jump = true;
-                } else if (unwind_context.finalizer) {
-                    block = unwind_context.finalizer;
-                    m_unwind_contexts.take_last();
-                    will_jump = true;
-                    m_saved_exception = Handle<Exception>::create(vm().exception());
-                    vm().clear_exception();
-                }
-            }
-            if (m_pending_jump.has_value()) {
-                block = m_pending_jump.release_value();
-                will_jump = true;
-                break;
-            }
-            if (!m_return_value.is_empty()) {
-                will_return = true;
-                break;
-            }
-            ++pc;
-        }
-
-        if (will_return)
-            break;
-
-        if (pc.at_end() && !will_jump)
-            break;
-
-        if (vm().exception())
-            break;
-    }
+#if JS_BYTECODE_HAS_THREADED_DISPATCH
+    if (m_dispatch_mode == DispatchMode::Threaded)
+        run_threaded(block);
+    else
+#endif
+        run_switch(block);
 
     dbgln_if(JS_BYTECODE_DEBUG, "Bytecode::Interpreter did run unit {:p}", &executable);
 
@@ -130,15 +90,15 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
 
     vm().set_last_value(Badge<Interpreter> {}, accumulator());
 
-    if (!m_manually_entered_frames)
-        m_register_windows.take_last();
+    if (!runs_in_manually_entered_frame)
+        pop_register_window();
 
     auto return_value = m_return_value.value_or(js_undefined());
     m_return_value = {};
 
     // NOTE: The return value from a called function is put into $0 in the caller context.
     if (!m_register_windows.is_empty())
-        m_register_windows.last()[0] = return_value;
+        registers()[0] = return_value;
 
     if (vm().execution_context_stack().size() == 1)
         vm().pop_execution_context();
@@ -148,6 +108,177 @@ Value Interpreter::run(Executable const& executable, BasicBlock const* entry_poi
     return return_value;
 }
 
+void Interpreter::set_dispatch_mode(DispatchMode mode)
+{
+    VERIFY(mode != DispatchMode::Threaded || JS_BYTECODE_HAS_THREADED_DISPATCH);
+    m_dispatch_mode = mode;
+}
+
+ALWAYS_INLINE Interpreter::AfterInstruction Interpreter::after_instruction(BasicBlock const*& block)
+{
+    if (!vm().exception() && !m_pending_jump.has_value() && m_return_value.is_empty())
+        return AfterInstruction::ContinueInBlock;
+    return after_instruction_slow(block);
+}
+
+NEVER_INLINE Interpreter::AfterInstruction Interpreter::after_instruction_slow(BasicBlock const*& block)
+{
+    bool will_jump = false;
+    if (vm().exception()) {
+        m_saved_exception = {};
+        if (m_unwind_contexts.is_empty())
+            return AfterInstruction::Exit;
+        auto& unwind_context = m_unwind_contexts.last();
+        if (unwind_context.handler) {
+            block = unwind_context.handler;
+            unwind_context.handler = nullptr;
+            accumulator() = vm().exception()->value();
+            vm().clear_exception();
+            will_jump = true;
+        } else if (unwind_context.finalizer) {
+            block = unwind_context.finalizer;
+            m_unwind_contexts.take_last();
+            will_jump = true;
+            m_saved_exception = Handle<Exception>::create(vm().exception());
+            vm().clear_exception();
+        }
+    }
+    if (m_pending_jump.has_value()) {
+        block = m_pending_jump.release_value();
+        return AfterInstruction::JumpToBlock;
+    }
+    if (!m_return_value.is_empty())
+        return AfterInstruction::Exit;
+    if (will_jump)
+        return AfterInstruction::JumpToBlock;
+    return AfterInstruction::ContinueInBlock;
+}
+
+void Interpreter::run_switch(BasicBlock const* block)
+{
+    for (;;) {
+        Bytecode::InstructionStreamIterator pc(block->instruction_stream());
+        for (;;) {
+            // NOTE: Falling off the end of a block without jumping anywhere ends the unit.
+            if (pc.at_end())
+                return;
+            (*pc).execute(*this);
+            auto after = after_instruction(block);
+            if (after == AfterInstruction::Exit)
+                return;
+            if (after == AfterInstruction::JumpToBlock)
+                break;
+            ++pc;
+        }
+    }
+}
+
+#if JS_BYTECODE_HAS_THREADED_DISPATCH
+void Interpreter::run_threaded(BasicBlock const* block)
+{
+    // Every instruction handler ends in its own indirect jump to the next handler, instead of all of them
+    // funneling through the single indirect branch of a switch. This gives the branch predictor a lot more
+    // context to work with, as each handler tends to be followed by a handful of likely successors.
+    static void* const dispatch_table[] = {
+#    define __BYTECODE_OP(op) &&handle_##op,
+        ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+#    undef __BYTECODE_OP
+    };
+
+    Bytecode::InstructionStreamIterator pc(block->instruction_stream());
+
+#    define DISPATCH_NEXT_INSTRUCTION()                        \
+        do {                                                   \
+            if (pc.at_end())                                   \
+                return;                                        \
+            goto* dispatch_table[to_underlying((*pc).type())]; \
+        } while (0)
+
+    DISPATCH_NEXT_INSTRUCTION();
+
+#    define __BYTECODE_OP(op)                                                       \
+    handle_##op:                                                                   \
+        static_cast<Bytecode::Op::op const&>(*pc).execute_impl(*this);             \
+        switch (after_instruction(block)) {                                        \
+        case AfterInstruction::ContinueInBlock:                                    \
+            ++pc;                                                                  \
+            break;                                                                 \
+        case AfterInstruction::JumpToBlock:                                        \
+            pc = Bytecode::InstructionStreamIterator(block->instruction_stream()); \
+            break;                                                                 \
+        case AfterInstruction::Exit:                                               \
+            return;                                                                \
+        }                                                                          \
+        DISPATCH_NEXT_INSTRUCTION();
+
+    ENUMERATE_BYTECODE_OPS(__BYTECODE_OP)
+
+#    undef __BYTECODE_OP
+#    undef DISPATCH_NEXT_INSTRUCTION
+}
+#endif
+
+RegisterWindow Interpreter::snapshot_frame() const
+{
+    RegisterWindow frame;
+    frame.append(m_register_windows.last().registers.data(), m_register_windows.last().registers.size());
+    return frame;
+}
+
+void Interpreter::enter_frame(RegisterWindow const& frame)
+{
+    ++m_manually_entered_frames;
+    m_has_unused_manually_entered_frame = true;
+    auto window = push_register_window(frame.size());
+    for (size_t i = 0; i < frame.size(); ++i)
+        window[i] = frame[i];
+}
+
+Span<Value> Interpreter::push_register_window(size_t size)
+{
+    auto chunk_index = m_register_stack_chunk_index;
+    auto chunk_offset = m_register_stack_chunk_offset;
+    if (chunk_index >= m_register_stack_chunks.size() || chunk_offset + size > m_register_stack_chunks[chunk_index].size()) {
+        // This window doesn't fit into the current chunk, move on to the next one (that's big enough).
+        if (chunk_index < m_register_stack_chunks.size())
+            ++chunk_index;
+        while (chunk_index < m_register_stack_chunks.size() && m_register_stack_chunks[chunk_index].size() < size)
+            m_register_stack_chunks.remove(chunk_index);
+        if (chunk_index == m_register_stack_chunks.size())
+            m_register_stack_chunks.append(make<FixedArray<Value>>(max(size, register_stack_chunk_size)));
+        chunk_offset = 0;
+    }
+
+    auto window = m_register_stack_chunks[chunk_index].span().slice(chunk_offset, size);
+    for (auto& value : window)
+        value = {};
+
+    m_register_windows.append({ window, m_register_stack_chunk_index, m_register_stack_chunk_offset });
+    m_register_stack_chunk_index = chunk_index;
+    m_register_stack_chunk_offset = chunk_offset + size;
+    return window;
+}
+
+void Interpreter::pop_register_window()
+{
+    auto window = m_register_windows.take_last();
+    m_register_stack_chunk_index = window.chunk_index;
+    m_register_stack_chunk_offset = window.chunk_offset;
+}
+
+void Interpreter::gather_roots(Vector<Cell*>& roots)
+{
+    // Register windows live outside the JS heap, so nothing else would keep what they hold alive.
+    for (auto& window : m_register_windows) {
+        for (auto& value : window.registers) {
+            if (value.is_cell())
+                roots.append(&value.as_cell());
+        }
+    }
+    if (m_return_value.is_cell())
+        roots.append(&m_return_value.as_cell());
+}
+
 void Interpreter::enter_unwind_context(Optional<Label> handler_target, Optional<Label> finalizer_target)
 {
     m_unwind_contexts.empend(handler_target.has_value() ? &handler_target->block() : nullptr, finalizer_target.has_value() ? &finalizer_target->block() : nullptr);
@@ -181,6 +312,9 @@ Bytecode::PassManager& Interpreter::optimization_pipeline(Interpreter::Optimizat
 
     auto pm = make<PassManager>();
     if (level == OptimizationLevel::Default) {
+        pm->add<Passes::FoldConstants>();
+        pm->add<Passes::EliminateRedundantLoadsAndStores>();
+        pm->add<Passes::ThreadJumps>();
         pm->add<Passes::GenerateCFG>();
         pm->add<Passes::UnifySameBlocks>();
         pm->add<Passes::GenerateCFG>();
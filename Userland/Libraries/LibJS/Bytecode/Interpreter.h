@@ -8,6 +8,9 @@
 
 #include "Generator.h"
 #include "PassManager.h"
+#include <AK/FixedArray.h>
+#include <AK/NonnullOwnPtrVector.h>
+#include <AK/Span.h>
 #include <LibJS/Bytecode/Label.h>
 #include <LibJS/Bytecode/Register.h>
 #include <LibJS/Forward.h>
@@ -16,6 +19,13 @@
 #include <LibJS/Runtime/Exception.h>
 #include <LibJS/Runtime/Value.h>
 
+// "Labels as values" are a GNU extension, but both GCC and Clang support them.
+#ifdef __GNUC__
+#    define JS_BYTECODE_HAS_THREADED_DISPATCH 1
+#else
+#    define JS_BYTECODE_HAS_THREADED_DISPATCH 0
+#endif
+
 namespace JS::Bytecode {
 
 using RegisterWindow = Vector<Value>;
@@ -33,20 +43,26 @@ public:
 
     Value run(Bytecode::Executable const&, Bytecode::BasicBlock const* entry_point = nullptr);
 
+    enum class DispatchMode {
+        // A switch over the instruction type, via Instruction::execute().
+        Switch,
+        // Computed gotos through a table of handler labels, see run_threaded().
+        Threaded,
+    };
+    DispatchMode dispatch_mode() const { return m_dispatch_mode; }
+    void set_dispatch_mode(DispatchMode);
+
     ALWAYS_INLINE Value& accumulator() { return reg(Register::accumulator()); }
     Value& reg(Register const& r) { return registers()[r.index()]; }
-    [[nodiscard]] RegisterWindow snapshot_frame() const { return m_register_windows.last(); }
+    [[nodiscard]] RegisterWindow snapshot_frame() const;
 
-    void enter_frame(RegisterWindow const& frame)
-    {
-        ++m_manually_entered_frames;
-        m_register_windows.append(make<RegisterWindow>(frame));
-    }
+    void enter_frame(RegisterWindow const& frame);
     void leave_frame()
     {
         VERIFY(m_manually_entered_frames);
         --m_manually_entered_frames;
-        m_register_windows.take_last();
+        m_has_unused_manually_entered_frame = false;
+        pop_register_window();
     }
 
     void jump(Label const& label)
@@ -61,6 +77,8 @@ public:
 
     Executable const& current_executable() { return *m_current_executable; }
 
+    void gather_roots(Vector<Cell*>&);
+
     enum class OptimizationLevel {
         Default,
         __Count,
@@ -68,17 +86,48 @@ public:
     static Bytecode::PassManager& optimization_pipeline(OptimizationLevel = OptimizationLevel::Default);
 
 private:
-    RegisterWindow& registers() { return m_register_windows.last(); }
+    enum class AfterInstruction {
+        ContinueInBlock,
+        JumpToBlock,
+        Exit,
+    };
+    AfterInstruction after_instruction(BasicBlock const*& block);
+    AfterInstruction after_instruction_slow(BasicBlock const*& block);
+
+    void run_switch(BasicBlock const* entry_block);
+#if JS_BYTECODE_HAS_THREADED_DISPATCH
+    void run_threaded(BasicBlock const* entry_block);
+#endif
+
+    Span<Value> registers() { return m_register_windows.last().registers; }
+
+    // Register windows are carved out of a stack of fixed-size chunks, so entering a frame doesn't allocate
+    // (once the stack has grown deep enough), and windows never move while instructions hold on to a register.
+    struct RegisterWindowSlice {
+        Span<Value> registers;
+        size_t chunk_index { 0 };
+        size_t chunk_offset { 0 };
+    };
+
+    static constexpr size_t register_stack_chunk_size = 4096;
+
+    Span<Value> push_register_window(size_t size);
+    void pop_register_window();
 
     static AK::Array<OwnPtr<PassManager>, static_cast<UnderlyingType<Interpreter::OptimizationLevel>>(Interpreter::OptimizationLevel::__Count)> s_optimization_pipelines;
 
     VM& m_vm;
     GlobalObject& m_global_object;
-    NonnullOwnPtrVector<RegisterWindow> m_register_windows;
+    NonnullOwnPtrVector<FixedArray<Value>> m_register_stack_chunks;
+    Vector<RegisterWindowSlice> m_register_windows;
+    size_t m_register_stack_chunk_index { 0 };
+    size_t m_register_stack_chunk_offset { 0 };
     Optional<BasicBlock const*> m_pending_jump;
     Value m_return_value;
     size_t m_manually_entered_frames { 0 };
+    bool m_has_unused_manually_entered_frame { false };
     Executable const* m_current_executable { nullptr };
+    DispatchMode m_dispatch_mode { JS_BYTECODE_HAS_THREADED_DISPATCH ? DispatchMode::Threaded : DispatchMode::Switch };
     Vector<UnwindInfo> m_unwind_contexts;
     Handle<Exception> m_saved_exception;
 };
@@ -224,16 +224,117 @@ void SetVariable::execute_impl(Bytecode::Interpreter& interpreter) const
     interpreter.vm().set_variable(interpreter.current_executable().get_string(m_identifier), interpreter.accumulator(), interpreter.global_object());
 }
 
+static bool is_cacheable(Object const& object)
+{
+    // Unique shapes are mutated in place, so a cached offset could silently go stale.
+    return !object.has_exotic_property_access() && !object.shape().is_unique();
+}
+
+static Optional<Value> get_from_cache(PropertyLookupCache const& cache, Object const& object)
+{
+    // An exotic object may share its shape with an ordinary one, but must still go through its own [[Get]].
+    if (object.has_exotic_property_access())
+        return {};
+    auto const* shape = &object.shape();
+    for (auto& entry : cache.entries) {
+        if (entry.shape.ptr() != shape)
+            continue;
+        auto const* holder = &object;
+        if (!entry.prototype_shape.is_null()) {
+            holder = shape->prototype();
+            if (entry.prototype_shape.ptr() != &holder->shape())
+                continue;
+        }
+        auto value = holder->get_direct(entry.offset);
+        // A data property can be turned into an accessor without changing its attributes, and thus the shape.
+        if (value.is_accessor())
+            return {};
+        return value;
+    }
+    return {};
+}
+
+static void update_cache_for_get(PropertyLookupCache& cache, Object const& object, StringOrSymbol const& property_name)
+{
+    if (!is_cacheable(object))
+        return;
+
+    if (auto metadata = object.shape().lookup(property_name); metadata.has_value()) {
+        if (!object.get_direct(metadata->offset).is_accessor())
+            cache.add_entry(object.shape(), nullptr, metadata->offset);
+        return;
+    }
+
+    auto const* prototype = object.shape().prototype();
+    if (!prototype || !is_cacheable(*prototype))
+        return;
+    if (auto metadata = prototype->shape().lookup(property_name); metadata.has_value()) {
+        if (!prototype->get_direct(metadata->offset).is_accessor())
+            cache.add_entry(object.shape(), &prototype->shape(), metadata->offset);
+    }
+}
+
+static bool put_using_cache(PropertyLookupCache const& cache, Object& object, Value value)
+{
+    if (object.has_exotic_property_access())
+        return false;
+    auto const* shape = &object.shape();
+    for (auto& entry : cache.entries) {
+        if (entry.shape.ptr() != shape)
+            continue;
+        if (object.get_direct(entry.offset).is_accessor())
+            return false;
+        object.put_direct(entry.offset, value);
+        return true;
+    }
+    return false;
+}
+
+static void update_cache_for_put(PropertyLookupCache& cache, Object const& object, StringOrSymbol const& property_name)
+{
+    if (!is_cacheable(object))
+        return;
+
+    auto metadata = object.shape().lookup(property_name);
+    if (!metadata.has_value() || !metadata->attributes.is_writable())
+        return;
+    if (object.get_direct(metadata->offset).is_accessor())
+        return;
+    cache.add_entry(object.shape(), nullptr, metadata->offset);
+}
+
 void GetById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
-    if (auto* object = interpreter.accumulator().to_object(interpreter.global_object()))
-        interpreter.accumulator() = object->get(interpreter.current_executable().get_string(m_property));
+    auto* object = interpreter.accumulator().to_object(interpreter.global_object());
+    if (!object)
+        return;
+
+    if (auto cached_value = get_from_cache(m_cache, *object); cached_value.has_value()) {
+        interpreter.accumulator() = cached_value.release_value();
+        return;
+    }
+
+    auto& property_name = interpreter.current_executable().get_string(m_property);
+    interpreter.accumulator() = object->get(property_name);
+    if (interpreter.vm().exception())
+        return;
+    update_cache_for_get(m_cache, *object, property_name);
 }
 
 void PutById::execute_impl(Bytecode::Interpreter& interpreter) const
 {
-    if (auto* object = interpreter.reg(m_base).to_object(interpreter.global_object()))
-        object->set(interpreter.current_executable().get_string(m_property), interpreter.accumulator(), Object::ShouldThrowExceptions::Yes);
+    auto* object = interpreter.reg(m_base).to_object(interpreter.global_object());
+    if (!object)
+        return;
+
+    if (put_using_cache(m_cache, *object, interpreter.accumulator()))
+        return;
+
+    auto& property_name = interpreter.current_executable().get_string(m_property);
+    object->set(property_name, interpreter.accumulator(), Object::ShouldThrowExceptions::Yes);
+    if (interpreter.vm().exception())
+        return;
+    update_cache_for_put(m_cache, *object, property_name);
 }
 
 void Jump::execute_impl(Bytecode::Interpreter& interpreter) const
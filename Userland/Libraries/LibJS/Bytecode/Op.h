@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <AK/WeakPtr.h>
 #include <LibCrypto/BigInt/SignedBigInteger.h>
 #include <LibJS/Bytecode/Instruction.h>
 #include <LibJS/Bytecode/Label.h>
@@ -15,6 +16,7 @@
 #include <LibJS/Bytecode/StringTable.h>
 #include <LibJS/Heap/Cell.h>
 #include <LibJS/Runtime/Environment.h>
+#include <LibJS/Runtime/Shape.h>
 #include <LibJS/Runtime/Value.h>
 
 namespace JS::Bytecode::Op {
@@ -31,6 +33,8 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    Register src() const { return m_src; }
+
 private:
     Register m_src;
 };
@@ -47,6 +51,8 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    Value value() const { return m_value; }
+
 private:
     Value m_value;
 };
@@ -63,6 +69,8 @@ public:
     String to_string_impl(Bytecode::Executable const&) const;
     void replace_references_impl(BasicBlock const&, BasicBlock const&) { }
 
+    Register dst() const { return m_dst; }
+
 private:
     Register m_dst;
 };
@@ -104,6 +112,8 @@ private:
         String to_string_impl(Bytecode::Executable const&) const;              \
         void replace_references_impl(BasicBlock const&, BasicBlock const&) { } \
                                                                                \
+        Register lhs() const { return m_lhs_reg; }                             \
+                                                                               \
     private:                                                                   \
         Register m_lhs_reg;                                                    \
     };
@@ -311,6 +321,32 @@ private:
     StringTableIndex m_identifier;
 };
 
+// Inline cache for named property accesses, keyed on the Shape of the object being accessed.
+// Each entry remembers where in the object's storage the property was last found, either in the
+// object itself or (for GetById) in its direct prototype, whose Shape must then match as well.
+// Shapes are held weakly so that a cache entry can never outlive (and be confused by) a collected Shape.
+struct PropertyLookupCache {
+    static constexpr size_t max_entry_count = 4;
+
+    struct Entry {
+        WeakPtr<Shape> shape;
+        WeakPtr<Shape> prototype_shape;
+        u32 offset { 0 };
+    };
+
+    void add_entry(Shape const& shape, Shape const* prototype_shape, u32 offset)
+    {
+        auto& entry = entries[next_entry_to_replace];
+        entry.shape = shape;
+        entry.prototype_shape = prototype_shape;
+        entry.offset = offset;
+        next_entry_to_replace = (next_entry_to_replace + 1) % max_entry_count;
+    }
+
+    Entry entries[max_entry_count];
+    size_t next_entry_to_replace { 0 };
+};
+
 class GetById final : public Instruction {
 public:
     explicit GetById(StringTableIndex property)
@@ -325,6 +361,7 @@ public:
 
 private:
     StringTableIndex m_property;
+    mutable PropertyLookupCache m_cache;
 };
 
 class PutById final : public Instruction {
@@ -343,6 +380,7 @@ public:
 private:
     Register m_base;
     StringTableIndex m_property;
+    mutable PropertyLookupCache m_cache;
 };
 
 class GetByValue final : public Instruction {
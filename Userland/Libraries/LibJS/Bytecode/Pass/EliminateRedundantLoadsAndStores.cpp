@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// Instructions that do nothing but overwrite the accumulator, without looking at it first.
+static bool only_writes_accumulator(Instruction const& instruction)
+{
+    return instruction.type() == Instruction::Type::Load || instruction.type() == Instruction::Type::LoadImmediate;
+}
+
+// Returns whether `second` is made redundant by `first` running right before it (and can be removed).
+static bool is_redundant_after(Instruction const& first, Instruction const& second)
+{
+    // Store $x, Load $x: The accumulator already holds the value of $x.
+    if (first.type() == Instruction::Type::Store && second.type() == Instruction::Type::Load)
+        return static_cast<Op::Store const&>(first).dst().index() == static_cast<Op::Load const&>(second).src().index();
+
+    // Load $x, Store $x: $x already holds the value of the accumulator.
+    if (first.type() == Instruction::Type::Load && second.type() == Instruction::Type::Store)
+        return static_cast<Op::Load const&>(first).src().index() == static_cast<Op::Store const&>(second).dst().index();
+
+    return false;
+}
+
+static Instruction const& instruction_at(BasicBlock const& block, size_t offset)
+{
+    InstructionStreamIterator it { block.instruction_stream() };
+    it.jump(offset);
+    return *it;
+}
+
+void EliminateRedundantLoadsAndStores::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        Vector<size_t> previous_offsets;
+        size_t offset = 0;
+        while (offset < block.size()) {
+            auto& instruction = instruction_at(block, offset);
+            if (!previous_offsets.is_empty()) {
+                auto previous_offset = previous_offsets.last();
+                auto& previous_instruction = instruction_at(block, previous_offset);
+
+                if (is_redundant_after(previous_instruction, instruction)) {
+                    block.remove_instructions(offset, instruction.length());
+                    continue;
+                }
+
+                // The previous instruction's result is overwritten before anything could read it.
+                if (only_writes_accumulator(previous_instruction) && only_writes_accumulator(instruction)) {
+                    block.remove_instructions(previous_offset, previous_instruction.length());
+                    offset = previous_offsets.take_last();
+                    continue;
+                }
+            }
+
+            previous_offsets.append(offset);
+            offset += instruction.length();
+        }
+    }
+
+    finished();
+}
+
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// NOTE: This only folds operations on numbers whose result can't depend on anything but the operands,
+//       and mirrors what the corresponding runtime operation would produce for them.
+static Optional<Value> fold_binary_operation(Instruction::Type type, Value lhs, Value rhs)
+{
+    if (!lhs.is_number() || !rhs.is_number())
+        return {};
+
+    switch (type) {
+    case Instruction::Type::Add:
+        return Value(lhs.as_double() + rhs.as_double());
+    case Instruction::Type::Sub:
+        return Value(lhs.as_double() - rhs.as_double());
+    case Instruction::Type::Mul:
+        return Value(lhs.as_double() * rhs.as_double());
+    case Instruction::Type::Div:
+        return Value(lhs.as_double() / rhs.as_double());
+    case Instruction::Type::LessThan:
+        return Value(lhs.as_double() < rhs.as_double());
+    case Instruction::Type::LessThanEquals:
+        return Value(lhs.as_double() <= rhs.as_double());
+    case Instruction::Type::GreaterThan:
+        return Value(lhs.as_double() > rhs.as_double());
+    case Instruction::Type::GreaterThanEquals:
+        return Value(lhs.as_double() >= rhs.as_double());
+    case Instruction::Type::TypedEquals:
+        return Value(lhs.as_double() == rhs.as_double());
+    case Instruction::Type::TypedInequals:
+        return Value(lhs.as_double() != rhs.as_double());
+    case Instruction::Type::BitwiseAnd:
+    case Instruction::Type::BitwiseOr:
+    case Instruction::Type::BitwiseXor: {
+        if (lhs.type() != Value::Type::Int32 || rhs.type() != Value::Type::Int32)
+            return {};
+        auto lhs_i32 = lhs.as_i32();
+        auto rhs_i32 = rhs.as_i32();
+        if (type == Instruction::Type::BitwiseAnd)
+            return Value(lhs_i32 & rhs_i32);
+        if (type == Instruction::Type::BitwiseOr)
+            return Value(lhs_i32 | rhs_i32);
+        return Value(lhs_i32 ^ rhs_i32);
+    }
+    default:
+        return {};
+    }
+}
+
+static Optional<Value> fold_unary_operation(Instruction::Type type, Value value)
+{
+    if (!value.is_number())
+        return {};
+
+    switch (type) {
+    case Instruction::Type::UnaryPlus:
+        return value;
+    case Instruction::Type::UnaryMinus:
+        if (value.is_nan())
+            return js_nan();
+        return Value(-value.as_double());
+    default:
+        return {};
+    }
+}
+
+static Optional<Register> binary_operation_lhs(Instruction const& instruction)
+{
+    switch (instruction.type()) {
+#define __BYTECODE_OP(OpTitleCase, op_snake_case) \
+    case Instruction::Type::OpTitleCase:          \
+        return static_cast<Op::OpTitleCase const&>(instruction).lhs();
+        JS_ENUMERATE_COMMON_BINARY_OPS(__BYTECODE_OP)
+#undef __BYTECODE_OP
+    default:
+        return {};
+    }
+}
+
+// Folds one constant expression starting at `offset`, returns whether anything changed.
+static bool fold_constant_expression_at(BasicBlock& block, size_t offset)
+{
+    Vector<Instruction const*, 4> window;
+    InstructionStreamIterator it { block.instruction_stream().slice(offset, block.size() - offset) };
+    while (!it.at_end() && window.size() < 4) {
+        window.append(&*it);
+        ++it;
+    }
+
+    if (window.size() < 2 || window[0]->type() != Instruction::Type::LoadImmediate)
+        return false;
+    auto first_value = static_cast<Op::LoadImmediate const&>(*window[0]).value();
+
+    // LoadImmediate <value>, <unary op>
+    if (auto result = fold_unary_operation(window[1]->type(), first_value); result.has_value()) {
+        block.replace_instructions<Op::LoadImmediate>(offset, window[0]->length() + window[1]->length(), *result);
+        return true;
+    }
+
+    // LoadImmediate <lhs>, Store <reg>, LoadImmediate <rhs>, <binary op> <reg>
+    // NOTE: Dropping the Store is fine as long as nothing reads <reg> after the binary operation. Where a binary
+    //       operation's lhs is stored right before it like this, <reg> is a temporary that the generator frees
+    //       right after the operation, so whoever gets it from allocate_register() next writes it before reading it.
+    //       Locals are never handed out as temporaries, and the register of a switch discriminant (which several
+    //       comparisons read) is stored in a different block than any of them.
+    if (window.size() < 4)
+        return false;
+    if (window[1]->type() != Instruction::Type::Store || window[2]->type() != Instruction::Type::LoadImmediate)
+        return false;
+    auto lhs_register = binary_operation_lhs(*window[3]);
+    if (!lhs_register.has_value() || lhs_register->index() != static_cast<Op::Store const&>(*window[1]).dst().index())
+        return false;
+    auto second_value = static_cast<Op::LoadImmediate const&>(*window[2]).value();
+    auto result = fold_binary_operation(window[3]->type(), first_value, second_value);
+    if (!result.has_value())
+        return false;
+
+    size_t size = 0;
+    for (auto* instruction : window)
+        size += instruction->length();
+    block.replace_instructions<Op::LoadImmediate>(offset, size, *result);
+    return true;
+}
+
+void FoldConstants::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        Vector<size_t> previous_offsets;
+        size_t offset = 0;
+        while (offset < block.size()) {
+            if (fold_constant_expression_at(block, offset)) {
+                // The folded value might complete another constant expression starting up to two instructions earlier.
+                for (size_t i = 0; i < 2 && !previous_offsets.is_empty(); ++i)
+                    offset = previous_offsets.take_last();
+                continue;
+            }
+            previous_offsets.append(offset);
+            InstructionStreamIterator it { block.instruction_stream() };
+            it.jump(offset);
+            ++it;
+            offset = it.offset();
+        }
+    }
+
+    finished();
+}
+
+}
@@ -150,6 +150,8 @@ void MergeBlocks::perform(PassPipelineExecutable& executable)
             }
             __builtin_memcpy(block.next_slot(), entry->instruction_stream().data(), copy_end);
             block.grow(copy_end);
+            // The merged block owns the copied instructions now, so they must not be destroyed along with the successor.
+            const_cast<BasicBlock&>(*entry).forget_instructions(copy_end);
         }
 
         auto first_successor_position = replace_blocks(successors, *new_block);
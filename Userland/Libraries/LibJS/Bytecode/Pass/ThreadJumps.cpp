@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PassManager.h>
+
+namespace JS::Bytecode::Passes {
+
+// Follows a chain of blocks that consist of nothing but an unconditional jump, and returns where it ends.
+static BasicBlock const& final_jump_target(BasicBlock const& target)
+{
+    HashTable<BasicBlock const*> seen_blocks;
+    auto* block = &target;
+    for (;;) {
+        InstructionStreamIterator it { block->instruction_stream() };
+        if (it.at_end() || (*it).type() != Instruction::Type::Jump)
+            return *block;
+        auto& next_target = static_cast<Op::Jump const&>(*it).true_target();
+        if (!next_target.has_value())
+            return *block;
+        // NOTE: An infinite loop of jumps just jumps to itself, leave it alone.
+        if (seen_blocks.set(block) != AK::HashSetResult::InsertedNewEntry)
+            return *block;
+        block = &next_target->block();
+    }
+}
+
+void ThreadJumps::perform(PassPipelineExecutable& executable)
+{
+    started();
+
+    for (auto& block : executable.executable.basic_blocks) {
+        InstructionStreamIterator it { block.instruction_stream() };
+        while (!it.at_end()) {
+            auto& instruction = *it;
+            ++it;
+            switch (instruction.type()) {
+            case Instruction::Type::Jump:
+            case Instruction::Type::JumpConditional:
+            case Instruction::Type::JumpNullish:
+            case Instruction::Type::JumpUndefined: {
+                auto& jump = const_cast<Op::Jump&>(static_cast<Op::Jump const&>(instruction));
+                auto true_target = jump.true_target();
+                auto false_target = jump.false_target();
+                if (true_target.has_value())
+                    true_target = Label { final_jump_target(true_target->block()) };
+                if (false_target.has_value())
+                    false_target = Label { final_jump_target(false_target->block()) };
+                jump.set_targets(move(true_target), move(false_target));
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+
+    finished();
+}
+
+}
@@ -121,6 +121,33 @@ private:
     virtual void perform(PassPipelineExecutable&) override;
 };
 
+class FoldConstants : public Pass {
+public:
+    FoldConstants() = default;
+    ~FoldConstants() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+class EliminateRedundantLoadsAndStores : public Pass {
+public:
+    EliminateRedundantLoadsAndStores() = default;
+    ~EliminateRedundantLoadsAndStores() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
+class ThreadJumps : public Pass {
+public:
+    ThreadJumps() = default;
+    ~ThreadJumps() override = default;
+
+private:
+    virtual void perform(PassPipelineExecutable&) override;
+};
+
 class DumpCFG : public Pass {
 public:
     DumpCFG(FILE* file)
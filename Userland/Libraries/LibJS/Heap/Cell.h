@@ -21,10 +21,10 @@ public:
     virtual void initialize(GlobalObject&) { }
     virtual ~Cell() { }
 
-    bool is_marked() const { return m_mark; }
-    void set_marked(bool b) { m_mark = b; }
+    // NOTE: This reflects the most recent garbage collection, and is only meaningful until the next one starts.
+    bool is_marked() const;
 
-    enum class State {
+    enum class State : u8 {
         Live,
         Dead,
     };
@@ -58,8 +58,7 @@ protected:
     Cell() { }
 
 private:
-    bool m_mark : 1 { false };
-    State m_state : 7 { State::Live };
+    State m_state { State::Live };
 };
 
 }
@@ -12,8 +12,9 @@
 
 namespace JS {
 
-CellAllocator::CellAllocator(size_t cell_size)
+CellAllocator::CellAllocator(size_t cell_size, SweepMode sweep_mode)
     : m_cell_size(cell_size)
+    , m_sweep_mode(sweep_mode)
 {
 }
 
@@ -38,17 +39,34 @@ Cell* CellAllocator::allocate_cell(Heap& heap)
 
 void CellAllocator::block_did_become_empty(Badge<Heap>, HeapBlock& block)
 {
-    auto& heap = block.heap();
     block.m_list_node.remove();
-    // NOTE: HeapBlocks are managed by the BlockAllocator, so we don't want to `delete` the block here.
-    block.~HeapBlock();
-    heap.block_allocator().deallocate_block(&block);
+    m_empty_blocks.append(block);
 }
 
-void CellAllocator::block_did_become_usable(Badge<Heap>, HeapBlock& block)
+void CellAllocator::release_empty_blocks(Badge<Heap>)
 {
-    VERIFY(!block.is_full());
-    m_usable_blocks.append(block);
+    while (auto* block = m_empty_blocks.take_first()) {
+        auto& heap = block->heap();
+        // NOTE: HeapBlocks are managed by the BlockAllocator, so we don't want to `delete` the block here.
+        block->~HeapBlock();
+        heap.block_allocator().deallocate_block(block);
+    }
+}
+
+void CellAllocator::schedule_sweep_of_all_blocks(Badge<Heap>)
+{
+    while (auto* block = m_full_blocks.take_first())
+        m_blocks_pending_sweep.append(*block);
+    while (auto* block = m_usable_blocks.take_first())
+        m_blocks_pending_sweep.append(*block);
+}
+
+void CellAllocator::block_was_swept(Badge<Heap>, HeapBlock& block)
+{
+    if (block.is_full())
+        m_full_blocks.append(block);
+    else
+        m_usable_blocks.append(block);
 }
 
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Badge.h>
 #include <AK/IntrusiveList.h>
 #include <AK/NonnullOwnPtr.h>
 #include <AK/Vector.h>
@@ -16,12 +17,21 @@ namespace JS {
 
 class CellAllocator {
 public:
-    explicit CellAllocator(size_t cell_size);
+    enum class SweepMode {
+        // Blocks are swept on demand when the allocator runs out of usable blocks.
+        Lazy,
+        // Blocks are swept as part of the collection itself.
+        Eager,
+    };
+
+    CellAllocator(size_t cell_size, SweepMode);
     ~CellAllocator();
 
     size_t cell_size() const { return m_cell_size; }
+    SweepMode sweep_mode() const { return m_sweep_mode; }
 
     Cell* allocate_cell(Heap&);
+    bool has_usable_blocks() const { return !m_usable_blocks.is_empty(); }
 
     template<typename Callback>
     IterationDecision for_each_block(Callback callback)
@@ -34,18 +44,32 @@ public:
             if (callback(block) == IterationDecision::Break)
                 return IterationDecision::Break;
         }
+        for (auto& block : m_blocks_pending_sweep) {
+            if (callback(block) == IterationDecision::Break)
+                return IterationDecision::Break;
+        }
         return IterationDecision::Continue;
     }
 
+    void schedule_sweep_of_all_blocks(Badge<Heap>);
+    HeapBlock* next_block_pending_sweep(Badge<Heap>) { return m_blocks_pending_sweep.first(); }
+    bool has_blocks_pending_sweep() const { return !m_blocks_pending_sweep.is_empty(); }
+
     void block_did_become_empty(Badge<Heap>, HeapBlock&);
-    void block_did_become_usable(Badge<Heap>, HeapBlock&);
+    void block_was_swept(Badge<Heap>, HeapBlock&);
+    void release_empty_blocks(Badge<Heap>);
 
 private:
     const size_t m_cell_size;
+    const SweepMode m_sweep_mode;
 
     typedef IntrusiveList<HeapBlock, RawPtr<HeapBlock>, &HeapBlock::m_list_node> BlockList;
     BlockList m_full_blocks;
     BlockList m_usable_blocks;
+    BlockList m_blocks_pending_sweep;
+    // Destructors of cells swept later on may still look at the HeapBlock of a cell that died with them,
+    // so empty blocks are only given back once no allocator has any blocks left to sweep.
+    BlockList m_empty_blocks;
 };
 
 }
@@ -5,8 +5,9 @@
  */
 
 #include <AK/Badge.h>
+#include <AK/BinarySearch.h>
 #include <AK/Debug.h>
-#include <AK/HashTable.h>
+#include <AK/QuickSort.h>
 #include <AK/StackInfo.h>
 #include <AK/TemporaryChange.h>
 #include <LibCore/ElapsedTimer.h>
@@ -24,17 +25,19 @@ namespace JS {
 Heap::Heap(VM& vm)
     : m_vm(vm)
 {
-    if constexpr (HeapBlock::min_possible_cell_size <= 16) {
-        m_allocators.append(make<CellAllocator>(16));
+    for (auto sweep_mode : { CellAllocator::SweepMode::Lazy, CellAllocator::SweepMode::Eager }) {
+        if constexpr (HeapBlock::min_possible_cell_size <= 16) {
+            m_allocators.append(make<CellAllocator>(16, sweep_mode));
+        }
+        static_assert(HeapBlock::min_possible_cell_size <= 24, "Heap Cell tracking uses too much data!");
+        m_allocators.append(make<CellAllocator>(32, sweep_mode));
+        m_allocators.append(make<CellAllocator>(64, sweep_mode));
+        m_allocators.append(make<CellAllocator>(128, sweep_mode));
+        m_allocators.append(make<CellAllocator>(256, sweep_mode));
+        m_allocators.append(make<CellAllocator>(512, sweep_mode));
+        m_allocators.append(make<CellAllocator>(1024, sweep_mode));
+        m_allocators.append(make<CellAllocator>(3072, sweep_mode));
     }
-    static_assert(HeapBlock::min_possible_cell_size <= 24, "Heap Cell tracking uses too much data!");
-    m_allocators.append(make<CellAllocator>(32));
-    m_allocators.append(make<CellAllocator>(64));
-    m_allocators.append(make<CellAllocator>(128));
-    m_allocators.append(make<CellAllocator>(256));
-    m_allocators.append(make<CellAllocator>(512));
-    m_allocators.append(make<CellAllocator>(1024));
-    m_allocators.append(make<CellAllocator>(3072));
 }
 
 Heap::~Heap()
@@ -42,17 +45,17 @@ Heap::~Heap()
     collect_garbage(CollectionType::CollectEverything);
 }
 
-ALWAYS_INLINE CellAllocator& Heap::allocator_for_size(size_t cell_size)
+ALWAYS_INLINE CellAllocator& Heap::allocator_for_size(size_t cell_size, CellAllocator::SweepMode sweep_mode)
 {
     for (auto& allocator : m_allocators) {
-        if (allocator->cell_size() >= cell_size)
+        if (allocator->sweep_mode() == sweep_mode && allocator->cell_size() >= cell_size)
             return *allocator;
     }
     dbgln("Cannot get CellAllocator for cell size {}, largest available is {}!", cell_size, m_allocators.last()->cell_size());
     VERIFY_NOT_REACHED();
 }
 
-Cell* Heap::allocate_cell(size_t size)
+Cell* Heap::allocate_cell(size_t size, CellAllocator::SweepMode sweep_mode)
 {
     if (should_collect_on_every_allocation()) {
         collect_garbage();
@@ -63,7 +66,19 @@ Cell* Heap::allocate_cell(size_t size)
         ++m_allocations_since_last_gc;
     }
 
-    auto& allocator = allocator_for_size(size);
+    auto& allocator = allocator_for_size(size, sweep_mode);
+    if (!allocator.has_usable_blocks()) {
+        // Sweep just enough of the blocks left over from the last collection to make room for this cell.
+        TemporaryChange change(m_collecting_garbage, true);
+        SweepStatistics statistics;
+        while (!allocator.has_usable_blocks()) {
+            auto* block = allocator.next_block_pending_sweep({});
+            if (!block)
+                break;
+            sweep_block(allocator, *block, statistics);
+        }
+        release_empty_blocks_if_fully_swept();
+    }
     return allocator.allocate_cell(*this);
 }
 
@@ -74,30 +89,55 @@ void Heap::collect_garbage(CollectionType collection_type, bool print_report)
 
     Core::ElapsedTimer collection_measurement_timer;
     collection_measurement_timer.start();
+    if (collection_type == CollectionType::CollectGarbage && m_gc_deferrals) {
+        m_should_gc_when_deferral_ends = true;
+        return;
+    }
+
+    // Whatever is still unswept from the previous collection has to go before we mark again.
+    // Otherwise, the conservative scan could resurrect a dead cell whose edges were already swept.
+    SweepStatistics statistics;
+    for (auto& allocator : m_allocators)
+        sweep_pending_blocks(*allocator, statistics);
+    release_empty_blocks_if_fully_swept();
+    for_each_block([](auto& block) {
+        block.clear_marks();
+        return IterationDecision::Continue;
+    });
+
+    size_t marked_cells = 0;
     if (collection_type == CollectionType::CollectGarbage) {
-        if (m_gc_deferrals) {
-            m_should_gc_when_deferral_ends = true;
-            return;
-        }
-        HashTable<Cell*> roots;
+        Vector<Cell*> roots;
         gather_roots(roots);
-        mark_live_cells(roots);
+        marked_cells = mark_live_cells(roots);
+
+        // Weak containers check the mark bits of their dead entries, so they have to let go of them
+        // before sweeping frees the blocks those entries live in.
+        // NOTE: A WeakRef whose target died deregisters itself right away, so we have to step past
+        //       each container before letting it remove its dead cells.
+        for (auto it = m_weak_containers.begin(); it != m_weak_containers.end();) {
+            auto& weak_container = *it;
+            ++it;
+            weak_container.remove_dead_cells({});
+        }
     }
-    sweep_dead_cells(print_report, collection_measurement_timer);
+    sweep_dead_cells(collection_type == CollectionType::CollectEverything || print_report, print_report, collection_measurement_timer);
+
+    m_max_allocations_between_gc = max(min_allocations_between_gc, marked_cells);
 }
 
-void Heap::gather_roots(HashTable<Cell*>& roots)
+void Heap::gather_roots(Vector<Cell*>& roots)
 {
     vm().gather_roots(roots);
     gather_conservative_roots(roots);
 
     for (auto& handle : m_handles)
-        roots.set(handle.cell());
+        roots.append(handle.cell());
 
     for (auto& list : m_marked_value_lists) {
         for (auto& value : list.values()) {
             if (value.is_cell())
-                roots.set(&value.as_cell());
+                roots.append(&value.as_cell());
         }
     }
 
@@ -108,7 +148,7 @@ void Heap::gather_roots(HashTable<Cell*>& roots)
     }
 }
 
-__attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(HashTable<Cell*>& roots)
+__attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Vector<Cell*>& roots)
 {
     FlatPtr dummy;
 
@@ -117,40 +157,43 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
     jmp_buf buf;
     setjmp(buf);
 
-    HashTable<FlatPtr> possible_pointers;
+    Vector<FlatPtr> possible_pointers;
 
     auto* raw_jmp_buf = reinterpret_cast<FlatPtr const*>(buf);
 
     for (size_t i = 0; i < ((size_t)sizeof(buf)) / sizeof(FlatPtr); i += sizeof(FlatPtr))
-        possible_pointers.set(raw_jmp_buf[i]);
+        possible_pointers.append(raw_jmp_buf[i]);
 
     auto stack_reference = bit_cast<FlatPtr>(&dummy);
     auto& stack_info = m_vm.stack_info();
 
     for (FlatPtr stack_address = stack_reference; stack_address < stack_info.top(); stack_address += sizeof(FlatPtr)) {
         auto data = *reinterpret_cast<FlatPtr*>(stack_address);
-        possible_pointers.set(data);
+        possible_pointers.append(data);
     }
 
-    HashTable<HeapBlock*> all_live_heap_blocks;
+    // NOTE: Every HeapBlock is block_size-aligned, so masking off the low bits of a candidate
+    //       pointer gives the address of the block it would belong to.
+    Vector<FlatPtr> all_live_heap_blocks;
     for_each_block([&](auto& block) {
-        all_live_heap_blocks.set(&block);
+        all_live_heap_blocks.append(reinterpret_cast<FlatPtr>(&block));
         return IterationDecision::Continue;
     });
+    quick_sort(all_live_heap_blocks);
 
     for (auto possible_pointer : possible_pointers) {
         if (!possible_pointer)
             continue;
         dbgln_if(HEAP_DEBUG, "  ? {}", (const void*)possible_pointer);
         auto* possible_heap_block = HeapBlock::from_cell(reinterpret_cast<const Cell*>(possible_pointer));
-        if (all_live_heap_blocks.contains(possible_heap_block)) {
-            if (auto* cell = possible_heap_block->cell_from_possible_pointer(possible_pointer)) {
-                if (cell->state() == Cell::State::Live) {
-                    dbgln_if(HEAP_DEBUG, "  ?-> {}", (const void*)cell);
-                    roots.set(cell);
-                } else {
-                    dbgln_if(HEAP_DEBUG, "  #-> {}", (const void*)cell);
-                }
+        if (!binary_search(all_live_heap_blocks, reinterpret_cast<FlatPtr>(possible_heap_block)))
+            continue;
+        if (auto* cell = possible_heap_block->cell_from_possible_pointer(possible_pointer)) {
+            if (cell->state() == Cell::State::Live) {
+                dbgln_if(HEAP_DEBUG, "  ?-> {}", (const void*)cell);
+                roots.append(cell);
+            } else {
+                dbgln_if(HEAP_DEBUG, "  #-> {}", (const void*)cell);
             }
         }
     }
@@ -158,76 +201,59 @@ __attribute__((no_sanitize("address"))) void Heap::gather_conservative_roots(Has
 
 class MarkingVisitor final : public Cell::Visitor {
 public:
-    MarkingVisitor() { }
+    explicit MarkingVisitor(Vector<Cell*>& mark_stack)
+        : m_mark_stack(mark_stack)
+    {
+    }
+
+    size_t marked_cells() const { return m_marked_cells; }
 
     virtual void visit_impl(Cell& cell)
     {
-        if (cell.is_marked())
+        auto* block = HeapBlock::from_cell(&cell);
+        if (block->is_marked(&cell))
             return;
         dbgln_if(HEAP_DEBUG, "  ! {}", &cell);
-        cell.set_marked(true);
-        cell.visit_edges(*this);
+        block->set_marked(&cell);
+        m_mark_stack.append(&cell);
+        ++m_marked_cells;
     }
+
+private:
+    Vector<Cell*>& m_mark_stack;
+    size_t m_marked_cells { 0 };
 };
 
-void Heap::mark_live_cells(const HashTable<Cell*>& roots)
+size_t Heap::mark_live_cells(Vector<Cell*> const& roots)
 {
     dbgln_if(HEAP_DEBUG, "mark_live_cells:");
-    MarkingVisitor visitor;
+
+    // Cells are marked as soon as they are discovered, and their edges are visited once they
+    // come off the mark stack. This keeps the native stack depth constant for deep object graphs.
+    Vector<Cell*> mark_stack;
+    MarkingVisitor visitor(mark_stack);
     for (auto* root : roots)
         visitor.visit(root);
+
+    while (!mark_stack.is_empty())
+        mark_stack.take_last()->visit_edges(visitor);
+
+    return visitor.marked_cells();
 }
 
-void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measurement_timer)
+void Heap::sweep_dead_cells(bool sweep_all_blocks, bool print_report, const Core::ElapsedTimer& measurement_timer)
 {
     dbgln_if(HEAP_DEBUG, "sweep_dead_cells:");
-    Vector<HeapBlock*, 32> empty_blocks;
-    Vector<HeapBlock*, 32> full_blocks_that_became_usable;
-    Vector<Cell*> swept_cells;
-
-    size_t collected_cells = 0;
-    size_t live_cells = 0;
-    size_t collected_cell_bytes = 0;
-    size_t live_cell_bytes = 0;
-
-    auto should_store_swept_cells = !m_weak_containers.is_empty();
-    for_each_block([&](auto& block) {
-        bool block_has_live_cells = false;
-        bool block_was_full = block.is_full();
-        block.template for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
-            if (!cell->is_marked()) {
-                dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
-                if (should_store_swept_cells)
-                    swept_cells.append(cell);
-                block.deallocate(cell);
-                ++collected_cells;
-                collected_cell_bytes += block.cell_size();
-            } else {
-                cell->set_marked(false);
-                block_has_live_cells = true;
-                ++live_cells;
-                live_cell_bytes += block.cell_size();
-            }
-        });
-        if (!block_has_live_cells)
-            empty_blocks.append(&block);
-        else if (block_was_full != block.is_full())
-            full_blocks_that_became_usable.append(&block);
-        return IterationDecision::Continue;
-    });
 
-    for (auto* block : empty_blocks) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", block, block->cell_size());
-        allocator_for_size(block->cell_size()).block_did_become_empty({}, *block);
-    }
-
-    for (auto* block : full_blocks_that_became_usable) {
-        dbgln_if(HEAP_DEBUG, " - HeapBlock usable again @ {}: cell_size={}", block, block->cell_size());
-        allocator_for_size(block->cell_size()).block_did_become_usable({}, *block);
+    // NOTE: Blocks are swept lazily by default, as allocations need them. The mark bits of unswept
+    //       blocks stay around until then, which is how we tell their dead cells apart from live ones.
+    SweepStatistics statistics;
+    for (auto& allocator : m_allocators) {
+        allocator->schedule_sweep_of_all_blocks({});
+        if (sweep_all_blocks || allocator->sweep_mode() == CellAllocator::SweepMode::Eager)
+            sweep_pending_blocks(*allocator, statistics);
     }
-
-    for (auto& weak_container : m_weak_containers)
-        weak_container.remove_swept_cells({}, swept_cells);
+    release_empty_blocks_if_fully_swept();
 
     if constexpr (HEAP_DEBUG) {
         for_each_block([&](auto& block) {
@@ -248,14 +274,58 @@ void Heap::sweep_dead_cells(bool print_report, const Core::ElapsedTimer& measure
         dbgln("Garbage collection report");
         dbgln("=============================================");
         dbgln("     Time spent: {} ms", time_spent);
-        dbgln("     Live cells: {} ({} bytes)", live_cells, live_cell_bytes);
-        dbgln("Collected cells: {} ({} bytes)", collected_cells, collected_cell_bytes);
+        dbgln("     Live cells: {} ({} bytes)", statistics.live_cells, statistics.live_cell_bytes);
+        dbgln("Collected cells: {} ({} bytes)", statistics.collected_cells, statistics.collected_cell_bytes);
         dbgln("    Live blocks: {} ({} bytes)", live_block_count, live_block_count * HeapBlock::block_size);
-        dbgln("   Freed blocks: {} ({} bytes)", empty_blocks.size(), empty_blocks.size() * HeapBlock::block_size);
+        dbgln("   Freed blocks: {} ({} bytes)", statistics.freed_blocks, statistics.freed_blocks * HeapBlock::block_size);
         dbgln("=============================================");
     }
 }
 
+void Heap::sweep_block(CellAllocator& allocator, HeapBlock& block, SweepStatistics& statistics)
+{
+    bool block_has_live_cells = false;
+    block.for_each_cell_in_state<Cell::State::Live>([&](Cell* cell) {
+        if (!block.is_marked(cell)) {
+            dbgln_if(HEAP_DEBUG, "  ~ {}", cell);
+            block.deallocate(cell);
+            ++statistics.collected_cells;
+            statistics.collected_cell_bytes += block.cell_size();
+        } else {
+            block_has_live_cells = true;
+            ++statistics.live_cells;
+            statistics.live_cell_bytes += block.cell_size();
+        }
+    });
+
+    if (!block_has_live_cells) {
+        dbgln_if(HEAP_DEBUG, " - HeapBlock empty @ {}: cell_size={}", &block, block.cell_size());
+        ++statistics.freed_blocks;
+        allocator.block_did_become_empty({}, block);
+        return;
+    }
+
+    allocator.block_was_swept({}, block);
+}
+
+void Heap::sweep_pending_blocks(CellAllocator& allocator, SweepStatistics& statistics)
+{
+    while (auto* block = allocator.next_block_pending_sweep({}))
+        sweep_block(allocator, *block, statistics);
+}
+
+void Heap::release_empty_blocks_if_fully_swept()
+{
+    // A block emptied by a lazy sweep has to stay around while any other allocator still has dead cells
+    // to destroy, as their destructors may look at cells that lived in it.
+    for (auto& allocator : m_allocators) {
+        if (allocator->has_blocks_pending_sweep())
+            return;
+    }
+    for (auto& allocator : m_allocators)
+        allocator->release_empty_blocks({});
+}
+
 void Heap::did_create_handle(Badge<HandleImpl>, HandleImpl& impl)
 {
     VERIFY(!m_handles.contains(impl));
@@ -34,7 +34,7 @@ public:
     template<typename T, typename... Args>
     T* allocate_without_global_object(Args&&... args)
     {
-        auto* memory = allocate_cell(sizeof(T));
+        auto* memory = allocate_cell(sizeof(T), sweep_mode_for<T>());
         new (memory) T(forward<Args>(args)...);
         return static_cast<T*>(memory);
     }
@@ -42,7 +42,7 @@ public:
     template<typename T, typename... Args>
     T* allocate(GlobalObject& global_object, Args&&... args)
     {
-        auto* memory = allocate_cell(sizeof(T));
+        auto* memory = allocate_cell(sizeof(T), sweep_mode_for<T>());
         new (memory) T(forward<Args>(args)...);
         auto* cell = static_cast<T*>(memory);
         constexpr bool is_object = IsBaseOf<Object, T>;
@@ -63,6 +63,9 @@ public:
 
     VM& vm() { return m_vm; }
 
+    static constexpr size_t min_allocations_between_gc = 10000;
+    size_t max_allocations_between_gc() const { return m_max_allocations_between_gc; }
+
     bool should_collect_on_every_allocation() const { return m_should_collect_on_every_allocation; }
     void set_should_collect_on_every_allocation(bool b) { m_should_collect_on_every_allocation = b; }
 
@@ -81,14 +84,36 @@ public:
     BlockAllocator& block_allocator() { return m_block_allocator; }
 
 private:
-    Cell* allocate_cell(size_t);
+    // Dead cells that can still be reached through a WeakPtr or a WeakContainer must be destroyed
+    // before the collection finishes, so they're kept apart from the cells we sweep lazily.
+    template<typename T>
+    static constexpr CellAllocator::SweepMode sweep_mode_for()
+    {
+        if constexpr (IsBaseOf<WeakContainer, T> || requires(T& cell) { cell.make_weak_ptr(); })
+            return CellAllocator::SweepMode::Eager;
+        else
+            return CellAllocator::SweepMode::Lazy;
+    }
+
+    struct SweepStatistics {
+        size_t live_cells { 0 };
+        size_t live_cell_bytes { 0 };
+        size_t collected_cells { 0 };
+        size_t collected_cell_bytes { 0 };
+        size_t freed_blocks { 0 };
+    };
+
+    Cell* allocate_cell(size_t, CellAllocator::SweepMode);
 
-    void gather_roots(HashTable<Cell*>&);
-    void gather_conservative_roots(HashTable<Cell*>&);
-    void mark_live_cells(const HashTable<Cell*>& live_cells);
-    void sweep_dead_cells(bool print_report, const Core::ElapsedTimer&);
+    void gather_roots(Vector<Cell*>&);
+    void gather_conservative_roots(Vector<Cell*>&);
+    size_t mark_live_cells(Vector<Cell*> const& roots);
+    void sweep_dead_cells(bool sweep_all_blocks, bool print_report, const Core::ElapsedTimer&);
+    void sweep_block(CellAllocator&, HeapBlock&, SweepStatistics&);
+    void sweep_pending_blocks(CellAllocator&, SweepStatistics&);
+    void release_empty_blocks_if_fully_swept();
 
-    CellAllocator& allocator_for_size(size_t);
+    CellAllocator& allocator_for_size(size_t, CellAllocator::SweepMode);
 
     template<typename Callback>
     void for_each_block(Callback callback)
@@ -99,7 +124,9 @@ private:
         }
     }
 
-    size_t m_max_allocations_between_gc { 10000 };
+    // This grows along with the number of cells that survive a collection, so that a large
+    // long-lived heap isn't fully re-marked every time a small amount of garbage accumulates.
+    size_t m_max_allocations_between_gc { min_allocations_between_gc };
     size_t m_allocations_since_last_gc { 0 };
 
     bool m_should_collect_on_every_allocation { false };
@@ -36,6 +36,7 @@ HeapBlock::HeapBlock(Heap& heap, size_t cell_size)
     , m_cell_size(cell_size)
 {
     VERIFY(cell_size >= sizeof(FreelistEntry));
+    VERIFY(cell_size >= smallest_cell_size);
     ASAN_POISON_MEMORY_REGION(m_storage, block_size);
 }
 
@@ -44,7 +45,7 @@ void HeapBlock::deallocate(Cell* cell)
     VERIFY(is_valid_cell_pointer(cell));
     VERIFY(!m_freelist || is_valid_cell_pointer(m_freelist));
     VERIFY(cell->state() == Cell::State::Live);
-    VERIFY(!cell->is_marked());
+    VERIFY(!is_marked(cell));
 
     cell->~Cell();
     auto* freelist_entry = new (cell) FreelistEntry();
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Array.h>
 #include <AK/IntrusiveList.h>
 #include <AK/Platform.h>
 #include <AK/Types.h>
@@ -24,6 +25,8 @@ class HeapBlock {
 
 public:
     static constexpr size_t block_size = 16 * KiB;
+    static constexpr size_t smallest_cell_size = 16;
+    static constexpr size_t max_cell_count = block_size / smallest_cell_size;
     static NonnullOwnPtr<HeapBlock> create_with_cell_size(Heap&, size_t);
 
     size_t cell_size() const { return m_cell_size; }
@@ -88,6 +91,20 @@ public:
         return cell_from_possible_pointer((FlatPtr)cell);
     }
 
+    bool is_marked(Cell const* cell) const
+    {
+        auto index = cell_index(cell);
+        return m_mark_bits[index / 8] & (1u << (index % 8));
+    }
+
+    void set_marked(Cell const* cell)
+    {
+        auto index = cell_index(cell);
+        m_mark_bits[index / 8] |= (1u << (index % 8));
+    }
+
+    void clear_marks() { m_mark_bits.fill(0); }
+
     IntrusiveListNode<HeapBlock> m_list_node;
 
 private:
@@ -106,14 +123,25 @@ private:
         return reinterpret_cast<Cell*>(&m_storage[index * cell_size()]);
     }
 
+    size_t cell_index(Cell const* cell) const
+    {
+        return (reinterpret_cast<FlatPtr>(cell) - reinterpret_cast<FlatPtr>(m_storage)) / m_cell_size;
+    }
+
     Heap& m_heap;
     size_t m_cell_size { 0 };
     size_t m_next_lazy_freelist_index { 0 };
     FreelistEntry* m_freelist { nullptr };
+    AK::Array<u8, max_cell_count / 8> m_mark_bits {};
     alignas(Cell) u8 m_storage[];
 
 public:
     static constexpr size_t min_possible_cell_size = sizeof(FreelistEntry);
 };
 
+ALWAYS_INLINE bool Cell::is_marked() const
+{
+    return HeapBlock::from_cell(this)->is_marked(this);
+}
+
 }
@@ -58,6 +58,14 @@ public:
         // Manual clear required to resolve circular references
         popped->hoisted_function_declarations.clear();
 
+        if (popped->type == Parser::Scope::Function && popped->parent) {
+            auto parent_function_scope = popped->parent->get_current_function_scope();
+            for (auto& name : popped->referenced_names) {
+                parent_function_scope->referenced_names.set(name);
+                parent_function_scope->names_referenced_by_nested_functions.set(name);
+            }
+        }
+
         m_parser.m_state.current_scope = popped->parent;
     }
 
@@ -76,6 +84,14 @@ public:
                 scope_node->add_hoisted_function(hoistable_function.declaration);
             }
         }
+
+        if (scope->type == Parser::Scope::Function) {
+            // Direct eval and `with` can reach any variable by name, and `arguments` aliases the parameters.
+            bool has_dynamic_variable_access = scope->contains_with_statement
+                || scope->referenced_names.contains("eval"sv)
+                || scope->referenced_names.contains("arguments"sv);
+            scope_node->set_variable_access_info(scope->names_referenced_by_nested_functions, has_dynamic_variable_access);
+        }
     }
 
     static bool is_hoistable(Parser::Scope::HoistableDeclaration& declaration)
@@ -220,6 +236,12 @@ Parser::Scope::Scope(Parser::Scope::Type type, RefPtr<Parser::Scope> parent_scop
 {
 }
 
+void Parser::note_identifier_reference(FlyString const& name)
+{
+    if (m_state.current_scope)
+        m_state.current_scope->get_current_function_scope()->referenced_names.set(name);
+}
+
 RefPtr<Parser::Scope> Parser::Scope::get_current_function_scope()
 {
     if (this->type == Parser::Scope::Function) {
@@ -425,6 +447,9 @@ RefPtr<FunctionExpression> Parser::try_parse_arrow_function_expression(bool expe
         load_state();
     };
 
+    // NOTE: This also covers the parameters, so names referenced by default values are attributed to the arrow function.
+    ScopePusher scope(*this, ScopePusher::Var, Scope::Function);
+
     Vector<FunctionNode::Parameter> parameters;
     i32 function_length = -1;
     if (expect_parens) {
@@ -473,7 +498,6 @@ RefPtr<FunctionExpression> Parser::try_parse_arrow_function_expression(bool expe
         TemporaryChange change(m_state.in_arrow_function_context, true);
         if (match(TokenType::CurlyOpen)) {
             // Parse a function body with statements
-            ScopePusher scope(*this, ScopePusher::Var, Scope::Function);
             bool has_binding = any_of(parameters, [](FunctionNode::Parameter const& parameter) {
                 return parameter.binding.has<NonnullRefPtr<BindingPattern>>();
             });
@@ -492,6 +516,7 @@ RefPtr<FunctionExpression> Parser::try_parse_arrow_function_expression(bool expe
             auto return_expression = parse_expression(2);
             auto return_block = create_ast_node<BlockStatement>({ m_state.current_token.filename(), rule_start.position(), position() });
             return_block->append<ReturnStatement>({ m_filename, rule_start.position(), position() }, move(return_expression));
+            scope.add_to_scope_node(return_block);
             return return_block;
         }
         // Invalid arrow function body
@@ -798,6 +823,7 @@ Parser::PrimaryExpressionParseResult Parser::parse_primary_expression()
         // This could be 'eval' or 'arguments' and thus needs a custom check (`eval[1] = true`)
         if (m_state.strict_mode && (string == "let" || is_strict_reserved_word(string)))
             syntax_error(String::formatted("Identifier must not be a reserved word in strict mode ('{}')", string));
+        note_identifier_reference(string);
         return { create_ast_node<Identifier>({ m_state.current_token.filename(), rule_start.position(), position() }, string) };
     }
     case TokenType::NumericLiteral:
@@ -1022,6 +1048,7 @@ NonnullRefPtr<ObjectExpression> Parser::parse_object_expression()
                 property_name = parse_property_key();
             } else {
                 property_name = create_ast_node<StringLiteral>({ m_state.current_token.filename(), rule_start.position(), position() }, identifier);
+                note_identifier_reference(identifier);
                 property_value = create_ast_node<Identifier>({ m_state.current_token.filename(), rule_start.position(), position() }, identifier);
             }
         } else {
@@ -2275,6 +2302,8 @@ NonnullRefPtr<WithStatement> Parser::parse_with_statement()
     consume(TokenType::ParenClose);
 
     auto body = parse_statement();
+    if (m_state.current_scope)
+        m_state.current_scope->get_current_function_scope()->contains_with_statement = true;
     return create_ast_node<WithStatement>({ m_state.current_token.filename(), rule_start.position(), position() }, move(object), move(body));
 }
 
@@ -171,6 +171,7 @@ private:
     Position position() const;
 
     void check_identifier_name_for_assignment_validity(StringView, bool force_strict = false);
+    void note_identifier_reference(FlyString const&);
 
     bool try_parse_arrow_function_expression_failed_at_position(const Position&) const;
     void set_try_parse_arrow_function_expression_failed_at_position(const Position&, bool);
@@ -221,6 +222,11 @@ private:
 
         HashTable<FlyString> lexical_declarations;
 
+        // Only tracked on function scopes, including everything referenced by nested functions.
+        HashTable<FlyString> referenced_names;
+        HashTable<FlyString> names_referenced_by_nested_functions;
+        bool contains_with_statement { false };
+
         explicit Scope(Type, RefPtr<Scope>);
         RefPtr<Scope> get_current_function_scope();
     };
@@ -28,6 +28,8 @@ public:
     virtual bool internal_set(PropertyName const&, Value value, Value receiver) override;
     virtual bool internal_delete(PropertyName const&) override;
 
+    virtual bool has_exotic_property_access() const override { return true; }
+
     // [[ParameterMap]]
     Object& parameter_map() { return *m_parameter_map; }
 
@@ -25,6 +25,8 @@ public:
     virtual bool internal_delete(PropertyName const&) override;
     virtual MarkedValueList internal_own_property_keys() const override;
 
+    virtual bool has_exotic_property_access() const override { return true; }
+
     [[nodiscard]] bool length_is_writable() const { return m_length_writable; };
 
 private:
@@ -48,6 +48,8 @@ void GeneratorObject::visit_edges(Cell::Visitor& visitor)
     visitor.visit(m_generating_function);
     if (m_previous_value.is_object())
         visitor.visit(&m_previous_value.as_object());
+    for (auto& value : m_frame)
+        visitor.visit(value);
 }
 
 Value GeneratorObject::next_impl(VM& vm, GlobalObject& global_object, Optional<Value> value_to_throw)
@@ -111,6 +113,8 @@ Value GeneratorObject::next_impl(VM& vm, GlobalObject& global_object, Optional<V
 
     m_previous_value = bytecode_interpreter->run(*m_generating_function->bytecode_executable(), next_block);
 
+    // Keep the registers around for the next resumption, they hold the generator's locals.
+    m_frame = bytecode_interpreter->snapshot_frame();
     bytecode_interpreter->leave_frame();
 
     m_done = generated_continuation(m_previous_value) == nullptr;
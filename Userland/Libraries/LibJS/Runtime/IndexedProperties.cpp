@@ -15,75 +15,236 @@ constexpr const size_t LENGTH_SETTER_GENERIC_STORAGE_THRESHOLD = 4 * MiB;
 
 SimpleIndexedPropertyStorage::SimpleIndexedPropertyStorage(Vector<Value>&& initial_values)
     : m_array_size(initial_values.size())
-    , m_packed_elements(move(initial_values))
 {
+    bool all_int32 = true;
+    bool all_numbers = true;
+    for (auto& value : initial_values) {
+        if (!value.is_int32())
+            all_int32 = false;
+        if (!value.is_number() && !value.is_empty()) {
+            all_numbers = false;
+            break;
+        }
+    }
+
+    if (all_int32) {
+        m_element_kind = ElementKind::Int32;
+        m_int32_elements.ensure_capacity(initial_values.size());
+        for (auto& value : initial_values)
+            m_int32_elements.unchecked_append(static_cast<i32>(value.as_double()));
+    } else if (all_numbers) {
+        m_element_kind = ElementKind::Double;
+        m_double_elements.ensure_capacity(initial_values.size());
+        for (auto& value : initial_values)
+            m_double_elements.unchecked_append(value.is_empty() ? hole() : canonicalize_nan(value.as_double()));
+    } else {
+        m_element_kind = ElementKind::Value;
+        m_packed_elements = move(initial_values);
+    }
+}
+
+size_t SimpleIndexedPropertyStorage::size() const
+{
+    switch (m_element_kind) {
+    case ElementKind::Int32:
+        return m_int32_elements.size();
+    case ElementKind::Double:
+        return m_double_elements.size();
+    case ElementKind::Value:
+        return m_packed_elements.size();
+    }
+    VERIFY_NOT_REACHED();
 }
 
 bool SimpleIndexedPropertyStorage::has_index(u32 index) const
 {
-    return index < m_array_size && !m_packed_elements[index].is_empty();
+    if (index >= m_array_size)
+        return false;
+    switch (m_element_kind) {
+    case ElementKind::Int32:
+        return true;
+    case ElementKind::Double:
+        return !is_hole(m_double_elements[index]);
+    case ElementKind::Value:
+        return !m_packed_elements[index].is_empty();
+    }
+    VERIFY_NOT_REACHED();
 }
 
 Optional<ValueAndAttributes> SimpleIndexedPropertyStorage::get(u32 index) const
 {
     if (index >= m_array_size)
         return {};
-    return ValueAndAttributes { m_packed_elements[index], default_attributes };
+    switch (m_element_kind) {
+    case ElementKind::Int32:
+        return ValueAndAttributes { Value(m_int32_elements[index]), default_attributes };
+    case ElementKind::Double: {
+        auto element = m_double_elements[index];
+        if (is_hole(element))
+            return ValueAndAttributes { {}, default_attributes };
+        return ValueAndAttributes { Value(element), default_attributes };
+    }
+    case ElementKind::Value:
+        return ValueAndAttributes { m_packed_elements[index], default_attributes };
+    }
+    VERIFY_NOT_REACHED();
 }
 
 void SimpleIndexedPropertyStorage::grow_storage_if_needed()
 {
-    if (m_array_size <= m_packed_elements.size())
+    if (m_array_size <= size())
         return;
     // Grow storage by 25% at a time.
-    m_packed_elements.resize(m_array_size + (m_array_size / 4));
+    auto new_size = m_array_size + (m_array_size / 4);
+    switch (m_element_kind) {
+    case ElementKind::Int32:
+        // Int32 storage has no holes, so the slack past m_array_size is never read.
+        m_int32_elements.resize(new_size);
+        break;
+    case ElementKind::Double:
+        m_double_elements.ensure_capacity(new_size);
+        while (m_double_elements.size() < new_size)
+            m_double_elements.append(hole());
+        break;
+    case ElementKind::Value:
+        m_packed_elements.resize(new_size);
+        break;
+    }
+}
+
+void SimpleIndexedPropertyStorage::transition_to(ElementKind new_kind)
+{
+    VERIFY(new_kind > m_element_kind);
+
+    if (m_element_kind == ElementKind::Int32) {
+        // Anything after m_array_size is unused slack, and becomes holes in the new storage.
+        if (new_kind == ElementKind::Double) {
+            m_double_elements.ensure_capacity(m_int32_elements.size());
+            for (size_t i = 0; i < m_int32_elements.size(); ++i)
+                m_double_elements.unchecked_append(i < m_array_size ? static_cast<double>(m_int32_elements[i]) : hole());
+        } else {
+            m_packed_elements.ensure_capacity(m_int32_elements.size());
+            for (size_t i = 0; i < m_int32_elements.size(); ++i)
+                m_packed_elements.unchecked_append(i < m_array_size ? Value(m_int32_elements[i]) : Value());
+        }
+        m_int32_elements.clear();
+    } else {
+        VERIFY(new_kind == ElementKind::Value);
+        m_packed_elements.ensure_capacity(m_double_elements.size());
+        for (auto element : m_double_elements)
+            m_packed_elements.unchecked_append(is_hole(element) ? Value() : Value(element));
+        m_double_elements.clear();
+    }
+
+    m_element_kind = new_kind;
 }
 
 void SimpleIndexedPropertyStorage::put(u32 index, Value value, PropertyAttributes attributes)
 {
     VERIFY(attributes == default_attributes);
 
+    if (m_element_kind != ElementKind::Value) {
+        if (!value.is_number())
+            transition_to(ElementKind::Value);
+        else if (m_element_kind == ElementKind::Int32 && (!value.is_int32() || index > m_array_size))
+            transition_to(ElementKind::Double);
+    }
+
     if (index >= m_array_size) {
         m_array_size = index + 1;
         grow_storage_if_needed();
     }
-    m_packed_elements[index] = value;
+
+    switch (m_element_kind) {
+    case ElementKind::Int32:
+        m_int32_elements[index] = static_cast<i32>(value.as_double());
+        break;
+    case ElementKind::Double:
+        m_double_elements[index] = canonicalize_nan(value.as_double());
+        break;
+    case ElementKind::Value:
+        m_packed_elements[index] = value;
+        break;
+    }
 }
 
 void SimpleIndexedPropertyStorage::remove(u32 index)
 {
     VERIFY(index < m_array_size);
-    m_packed_elements[index] = {};
+    if (m_element_kind == ElementKind::Int32)
+        transition_to(ElementKind::Double);
+
+    if (m_element_kind == ElementKind::Double)
+        m_double_elements[index] = hole();
+    else
+        m_packed_elements[index] = {};
 }
 
 ValueAndAttributes SimpleIndexedPropertyStorage::take_first()
 {
     m_array_size--;
-    return { m_packed_elements.take_first(), default_attributes };
+    switch (m_element_kind) {
+    case ElementKind::Int32:
+        return { Value(m_int32_elements.take_first()), default_attributes };
+    case ElementKind::Double: {
+        auto element = m_double_elements.take_first();
+        return { is_hole(element) ? Value() : Value(element), default_attributes };
+    }
+    case ElementKind::Value:
+        return { m_packed_elements.take_first(), default_attributes };
+    }
+    VERIFY_NOT_REACHED();
 }
 
 ValueAndAttributes SimpleIndexedPropertyStorage::take_last()
 {
     m_array_size--;
-    auto last_element = m_packed_elements[m_array_size];
-    m_packed_elements[m_array_size] = {};
-    return { last_element, default_attributes };
+    switch (m_element_kind) {
+    case ElementKind::Int32:
+        return { Value(m_int32_elements[m_array_size]), default_attributes };
+    case ElementKind::Double: {
+        auto last_element = m_double_elements[m_array_size];
+        m_double_elements[m_array_size] = hole();
+        return { is_hole(last_element) ? Value() : Value(last_element), default_attributes };
+    }
+    case ElementKind::Value: {
+        auto last_element = m_packed_elements[m_array_size];
+        m_packed_elements[m_array_size] = {};
+        return { last_element, default_attributes };
+    }
+    }
+    VERIFY_NOT_REACHED();
 }
 
 bool SimpleIndexedPropertyStorage::set_array_like_size(size_t new_size)
 {
+    // Growing the array creates holes, which Int32 storage can't represent.
+    if (m_element_kind == ElementKind::Int32 && new_size > m_array_size)
+        transition_to(ElementKind::Double);
+
+    switch (m_element_kind) {
+    case ElementKind::Int32:
+        m_int32_elements.resize(new_size);
+        break;
+    case ElementKind::Double:
+        m_double_elements.resize(min(new_size, m_double_elements.size()));
+        while (m_double_elements.size() < new_size)
+            m_double_elements.append(hole());
+        break;
+    case ElementKind::Value:
+        m_packed_elements.resize(new_size);
+        break;
+    }
     m_array_size = new_size;
-    m_packed_elements.resize(new_size);
     return true;
 }
 
 GenericIndexedPropertyStorage::GenericIndexedPropertyStorage(SimpleIndexedPropertyStorage&& storage)
 {
     m_array_size = storage.array_like_size();
-    for (size_t i = 0; i < storage.m_packed_elements.size(); ++i) {
-        auto value = storage.m_packed_elements[i];
-        if (!value.is_empty())
-            m_sparse_elements.set(i, { value, default_attributes });
+    for (u32 i = 0; i < storage.array_like_size(); ++i) {
+        if (storage.has_index(i))
+            m_sparse_elements.set(i, { storage.get(i)->value, default_attributes });
     }
 }
 
@@ -218,9 +379,18 @@ Optional<ValueAndAttributes> IndexedProperties::get(u32 index) const
     return m_storage->get(index);
 }
 
+static bool is_too_sparse_for_simple_storage(u32 index, size_t array_like_size)
+{
+    if (index <= array_like_size + SPARSE_ARRAY_HOLE_THRESHOLD)
+        return false;
+    // Holey simple storage is still much cheaper than the hash map, so let a store at most
+    // double the size of an array before giving up on it.
+    return index > array_like_size * 2 || index > LENGTH_SETTER_GENERIC_STORAGE_THRESHOLD;
+}
+
 void IndexedProperties::put(u32 index, Value value, PropertyAttributes attributes)
 {
-    if (m_storage->is_simple_storage() && (attributes != default_attributes || index > (array_like_size() + SPARSE_ARRAY_HOLE_THRESHOLD))) {
+    if (m_storage->is_simple_storage() && (attributes != default_attributes || is_too_sparse_for_simple_storage(index, array_like_size()))) {
         switch_to_generic_storage();
     }
 
@@ -268,10 +438,12 @@ bool IndexedProperties::set_array_like_size(size_t new_size)
 size_t IndexedProperties::real_size() const
 {
     if (m_storage->is_simple_storage()) {
-        auto& packed_elements = static_cast<const SimpleIndexedPropertyStorage&>(*m_storage).elements();
+        const auto& storage = static_cast<const SimpleIndexedPropertyStorage&>(*m_storage);
+        if (storage.element_kind() == SimpleIndexedPropertyStorage::ElementKind::Int32)
+            return storage.array_like_size();
         size_t size = 0;
-        for (auto& element : packed_elements) {
-            if (!element.is_empty())
+        for (size_t i = 0; i < storage.array_like_size(); ++i) {
+            if (storage.has_index(i))
                 ++size;
         }
         return size;
@@ -283,11 +455,10 @@ Vector<u32> IndexedProperties::indices() const
 {
     if (m_storage->is_simple_storage()) {
         const auto& storage = static_cast<const SimpleIndexedPropertyStorage&>(*m_storage);
-        const auto& elements = storage.elements();
         Vector<u32> indices;
         indices.ensure_capacity(storage.array_like_size());
-        for (size_t i = 0; i < elements.size(); ++i) {
-            if (!elements.at(i).is_empty())
+        for (size_t i = 0; i < storage.array_like_size(); ++i) {
+            if (storage.has_index(i))
                 indices.unchecked_append(i);
         }
         return indices;
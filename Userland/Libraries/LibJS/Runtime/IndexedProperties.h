@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/BitCast.h>
 #include <AK/NonnullOwnPtr.h>
 #include <LibJS/Runtime/Shape.h>
 #include <LibJS/Runtime/Value.h>
@@ -42,6 +43,16 @@ public:
 
 class SimpleIndexedPropertyStorage final : public IndexedPropertyStorage {
 public:
+    // Arrays start out storing raw int32s, and only move to a more general kind of
+    // storage once an element that doesn't fit is stored. Holes can't be represented
+    // in Int32 storage, so creating one moves the array to Double storage, where a
+    // reserved NaN bit pattern marks the hole.
+    enum class ElementKind : u8 {
+        Int32,
+        Double,
+        Value,
+    };
+
     SimpleIndexedPropertyStorage() = default;
     explicit SimpleIndexedPropertyStorage(Vector<Value>&& initial_values);
 
@@ -53,19 +64,55 @@ public:
     virtual ValueAndAttributes take_first() override;
     virtual ValueAndAttributes take_last() override;
 
-    virtual size_t size() const override { return m_packed_elements.size(); }
+    virtual size_t size() const override;
     virtual size_t array_like_size() const override { return m_array_size; }
     virtual bool set_array_like_size(size_t new_size) override;
 
     virtual bool is_simple_storage() const override { return true; }
-    const Vector<Value>& elements() const { return m_packed_elements; }
+
+    ElementKind element_kind() const { return m_element_kind; }
+
+    template<typename Callback>
+    void for_each_value(Callback callback) const
+    {
+        switch (m_element_kind) {
+        case ElementKind::Int32:
+            for (size_t i = 0; i < m_array_size; ++i) {
+                auto value = Value(m_int32_elements[i]);
+                callback(value);
+            }
+            break;
+        case ElementKind::Double:
+            for (size_t i = 0; i < m_array_size; ++i) {
+                if (is_hole(m_double_elements[i]))
+                    continue;
+                auto value = Value(m_double_elements[i]);
+                callback(value);
+            }
+            break;
+        case ElementKind::Value:
+            for (auto& value : m_packed_elements)
+                callback(value);
+            break;
+        }
+    }
 
 private:
-    friend GenericIndexedPropertyStorage;
+    static bool is_hole(double value) { return bit_cast<u64>(value) == hole_bits; }
+    static double hole() { return bit_cast<double>(hole_bits); }
+    // Every NaN is stored as the canonical one, so that none of them can ever be mistaken for a hole.
+    static double canonicalize_nan(double value) { return __builtin_isnan(value) ? js_nan().as_double() : value; }
+
+    // A signalling NaN that no arithmetic produces; NaNs stored by scripts are canonicalized first.
+    static constexpr u64 hole_bits = 0x7ff4'dead'0000'0001;
 
     void grow_storage_if_needed();
+    void transition_to(ElementKind);
 
     size_t m_array_size { 0 };
+    ElementKind m_element_kind { ElementKind::Int32 };
+    Vector<i32> m_int32_elements;
+    Vector<double> m_double_elements;
     Vector<Value> m_packed_elements;
 };
 
@@ -144,8 +191,7 @@ public:
     void for_each_value(Callback callback)
     {
         if (m_storage->is_simple_storage()) {
-            for (auto& value : static_cast<SimpleIndexedPropertyStorage&>(*m_storage).elements())
-                callback(value);
+            static_cast<const SimpleIndexedPropertyStorage&>(*m_storage).for_each_value(callback);
         } else {
             for (auto& element : static_cast<const GenericIndexedPropertyStorage&>(*m_storage).sparse_elements())
                 callback(element.value.value);
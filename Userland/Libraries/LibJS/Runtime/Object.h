@@ -137,6 +137,11 @@ public:
     // B.3.7 The [[IsHTMLDDA]] Internal Slot, https://tc39.es/ecma262/#sec-IsHTMLDDA-internal-slot
     virtual bool is_htmldda() const { return false; }
 
+    // Objects whose internal methods can disagree with what's in their shape (exotic objects and
+    // objects with custom [[Get]]/[[Set]]) must return true here, so the bytecode interpreter
+    // doesn't bypass them via its property lookup caches.
+    virtual bool has_exotic_property_access() const { return false; }
+
     bool has_parameter_map() const { return m_has_parameter_map; }
     void set_has_parameter_map() { m_has_parameter_map = true; }
 
@@ -145,6 +150,7 @@ public:
     virtual Value value_of() const { return Value(const_cast<Object*>(this)); }
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value) { m_storage[index] = value; }
 
     const IndexedProperties& indexed_properties() const { return m_indexed_properties; }
     IndexedProperties& indexed_properties() { return m_indexed_properties; }
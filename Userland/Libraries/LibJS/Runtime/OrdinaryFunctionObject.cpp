@@ -138,6 +138,35 @@ FunctionEnvironment* OrdinaryFunctionObject::create_environment(FunctionObject&
     return environment;
 }
 
+Bytecode::Executable const& OrdinaryFunctionObject::compile_bytecode_executable() const
+{
+    auto& body = verify_cast<ScopeNode>(*m_body);
+    if (auto* executable = body.bytecode_executable())
+        return *executable;
+
+    Vector<FlyString> parameter_names;
+    for (auto& parameter : m_parameters) {
+        parameter.binding.visit(
+            [&](FlyString const& name) { parameter_names.append(name); },
+            [&](NonnullRefPtr<BindingPattern> const& binding) {
+                binding->for_each_bound_name([&](auto const& name) {
+                    parameter_names.append(name);
+                });
+            });
+    }
+
+    auto executable = make<Bytecode::Executable>(Bytecode::Generator::generate_function(body, parameter_names, m_kind == FunctionKind::Generator));
+    auto& passes = JS::Bytecode::Interpreter::optimization_pipeline();
+    passes.perform(*executable);
+    if constexpr (JS_BYTECODE_DEBUG) {
+        dbgln("Optimisation passes took {}us", passes.elapsed());
+        dbgln("Compiled Bytecode::Block for function '{}':", m_name);
+        for (auto& block : executable->basic_blocks)
+            block.dump(*executable);
+    }
+    return body.set_bytecode_executable(move(executable));
+}
+
 Value OrdinaryFunctionObject::execute_function_body()
 {
     auto& vm = this->vm();
@@ -179,22 +208,21 @@ Value OrdinaryFunctionObject::execute_function_body()
 
     if (bytecode_interpreter) {
         prepare_arguments();
-        if (!m_bytecode_executable.has_value()) {
-            m_bytecode_executable = Bytecode::Generator::generate(m_body, m_kind == FunctionKind::Generator);
-            auto& passes = JS::Bytecode::Interpreter::optimization_pipeline();
-            passes.perform(*m_bytecode_executable);
-            if constexpr (JS_BYTECODE_DEBUG) {
-                dbgln("Optimisation passes took {}us", passes.elapsed());
-                dbgln("Compiled Bytecode::Block for function '{}':", m_name);
-                for (auto& block : m_bytecode_executable->basic_blocks)
-                    block.dump(*m_bytecode_executable);
-            }
-        }
-        auto result = bytecode_interpreter->run(*m_bytecode_executable);
+        if (!m_bytecode_executable)
+            m_bytecode_executable = &compile_bytecode_executable();
         if (m_kind != FunctionKind::Generator)
-            return result;
+            return bytecode_interpreter->run(*m_bytecode_executable);
+
+        // Run the generator up to its initial yield in a frame we can hold on to, it carries the locals across resumptions.
+        Bytecode::RegisterWindow initial_frame;
+        initial_frame.resize(m_bytecode_executable->number_of_registers);
+        initial_frame[Bytecode::Register::global_object_index] = Value(&global_object());
+        bytecode_interpreter->enter_frame(initial_frame);
+        auto result = bytecode_interpreter->run(*m_bytecode_executable);
+        auto frame = bytecode_interpreter->snapshot_frame();
+        bytecode_interpreter->leave_frame();
 
-        return GeneratorObject::create(global_object(), result, this, vm.running_execution_context().lexical_environment, bytecode_interpreter->snapshot_frame());
+        return GeneratorObject::create(global_object(), result, this, vm.running_execution_context().lexical_environment, move(frame));
     } else {
         VERIFY(m_kind != FunctionKind::Generator);
         OwnPtr<Interpreter> local_interpreter;
@@ -33,7 +33,7 @@ public:
 
     void set_is_class_constructor() { m_is_class_constructor = true; };
 
-    auto& bytecode_executable() const { return m_bytecode_executable; }
+    Bytecode::Executable const* bytecode_executable() const { return m_bytecode_executable; }
 
     virtual Environment* environment() override { return m_environment; }
 
@@ -48,11 +48,12 @@ private:
     virtual void visit_edges(Visitor&) override;
 
     Value execute_function_body();
+    Bytecode::Executable const& compile_bytecode_executable() const;
 
     FlyString m_name;
     NonnullRefPtr<Statement> m_body;
     const Vector<FunctionNode::Parameter> m_parameters;
-    Optional<Bytecode::Executable> m_bytecode_executable;
+    Bytecode::Executable const* m_bytecode_executable { nullptr };
     Environment* m_environment { nullptr };
     GlobalObject* m_realm { nullptr };
     i32 m_function_length { 0 };
@@ -5,6 +5,7 @@
  */
 
 #include <AK/CharacterTypes.h>
+#include <AK/StringBuilder.h>
 #include <AK/Utf16View.h>
 #include <LibJS/Runtime/PrimitiveString.h>
 #include <LibJS/Runtime/VM.h>
@@ -23,12 +24,39 @@ PrimitiveString::PrimitiveString(Vector<u16> string)
 {
 }
 
+PrimitiveString::PrimitiveString(PrimitiveString& lhs, PrimitiveString& rhs)
+    : m_is_rope(true)
+    , m_lhs(&lhs)
+    , m_rhs(&rhs)
+{
+}
+
 PrimitiveString::~PrimitiveString()
 {
 }
 
+void PrimitiveString::visit_edges(Cell::Visitor& visitor)
+{
+    Cell::visit_edges(visitor);
+    if (m_is_rope) {
+        visitor.visit(m_lhs);
+        visitor.visit(m_rhs);
+    }
+}
+
+bool PrimitiveString::is_empty() const
+{
+    // NOTE: Ropes are only ever created from two non-empty strings.
+    if (m_is_rope)
+        return false;
+    if (m_has_utf8_string)
+        return m_utf8_string.is_empty();
+    return m_utf16_string.is_empty();
+}
+
 String const& PrimitiveString::string() const
 {
+    resolve_rope_if_needed();
     if (!m_has_utf8_string) {
         m_utf8_string = utf16_string_view().to_utf8(Utf16View::AllowInvalidCodeUnits::Yes);
         m_has_utf8_string = true;
@@ -38,6 +66,7 @@ String const& PrimitiveString::string() const
 
 Vector<u16> const& PrimitiveString::utf16_string() const
 {
+    resolve_rope_if_needed();
     if (!m_has_utf16_string) {
         m_utf16_string = AK::utf8_to_utf16(m_utf8_string);
         m_has_utf16_string = true;
@@ -50,6 +79,74 @@ Utf16View PrimitiveString::utf16_string_view() const
     return Utf16View { utf16_string() };
 }
 
+bool PrimitiveString::ends_with_high_surrogate() const
+{
+    VERIFY(!m_is_rope);
+    if (!m_has_utf8_string)
+        return !m_utf16_string.is_empty() && Utf16View::is_high_surrogate(m_utf16_string.last());
+
+    // High surrogates (U+D800 to U+DBFF) are encoded as ED A0 80 to ED AF BF.
+    auto bytes = m_utf8_string.bytes();
+    if (bytes.size() < 3)
+        return false;
+    auto tail = bytes.slice(bytes.size() - 3);
+    return tail[0] == 0xed && (tail[1] & 0xf0) == 0xa0;
+}
+
+void PrimitiveString::resolve_rope_if_needed() const
+{
+    if (!m_is_rope)
+        return;
+
+    // NOTE: Ropes built up in a loop are very deep (and lopsided), so we walk them with an explicit stack instead of recursing.
+    Vector<PrimitiveString const*> pieces;
+    Vector<PrimitiveString const*> stack;
+    stack.append(m_rhs);
+    stack.append(m_lhs);
+    while (!stack.is_empty()) {
+        auto* current = stack.take_last();
+        if (current->m_is_rope) {
+            stack.append(current->m_rhs);
+            stack.append(current->m_lhs);
+            continue;
+        }
+        pieces.append(current);
+    }
+
+    // NOTE: A piece ending in a high surrogate may pair up with a low surrogate at the start of the next one.
+    //       Joined as UTF-8, the two halves would stay separately encoded, so those ropes are joined as UTF-16.
+    bool has_split_surrogate_pair = false;
+    for (size_t i = 0; i + 1 < pieces.size() && !has_split_surrogate_pair; ++i)
+        has_split_surrogate_pair = pieces[i]->ends_with_high_surrogate();
+
+    size_t length = 0;
+    if (has_split_surrogate_pair) {
+        for (auto* piece : pieces)
+            length += piece->utf16_string().size();
+
+        Vector<u16> string;
+        string.ensure_capacity(length);
+        for (auto* piece : pieces)
+            string.append(piece->utf16_string().data(), piece->utf16_string().size());
+
+        m_utf16_string = move(string);
+        m_has_utf16_string = true;
+    } else {
+        for (auto* piece : pieces)
+            length += piece->string().length();
+
+        StringBuilder builder(length);
+        for (auto* piece : pieces)
+            builder.append(piece->string());
+
+        m_utf8_string = builder.to_string();
+        m_has_utf8_string = true;
+    }
+    m_is_rope = false;
+    m_lhs = nullptr;
+    m_rhs = nullptr;
+}
+
 PrimitiveString* js_string(Heap& heap, Utf16View const& view)
 {
     if (view.is_empty())
@@ -110,4 +207,13 @@ PrimitiveString* js_string(VM& vm, String string)
     return js_string(vm.heap(), move(string));
 }
 
+PrimitiveString* js_rope_string(VM& vm, PrimitiveString& lhs, PrimitiveString& rhs)
+{
+    if (lhs.is_empty())
+        return &rhs;
+    if (rhs.is_empty())
+        return &lhs;
+    return vm.heap().allocate_without_global_object<PrimitiveString>(lhs, rhs);
+}
+
 }
@@ -45,6 +45,8 @@ public:
     virtual bool internal_delete(PropertyName const&) override;
     virtual MarkedValueList internal_own_property_keys() const override;
 
+    virtual bool has_exotic_property_access() const override { return true; }
+
 private:
     virtual void visit_edges(Visitor&) override;
 
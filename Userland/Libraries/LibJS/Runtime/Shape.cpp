@@ -101,6 +101,8 @@ void Shape::visit_edges(Cell::Visitor& visitor)
     visitor.visit(m_prototype);
     visitor.visit(m_previous);
     m_property_name.visit_edges(visitor);
+    for (auto& property : m_property_list)
+        property.key.visit_edges(visitor);
     if (m_property_table) {
         for (auto& it : *m_property_table)
             it.key.visit_edges(visitor);
@@ -111,6 +113,14 @@ Optional<PropertyMetadata> Shape::lookup(const StringOrSymbol& property_name) co
 {
     if (m_property_count == 0)
         return {};
+    if (uses_property_list()) {
+        ensure_property_list();
+        for (auto& property : m_property_list) {
+            if (property.key == property_name)
+                return property.value;
+        }
+        return {};
+    }
     auto property = property_table().get(property_name);
     if (!property.has_value())
         return {};
@@ -130,6 +140,13 @@ size_t Shape::property_count() const
 
 Vector<Shape::Property> Shape::property_table_ordered() const
 {
+    if (uses_property_list()) {
+        if (m_property_count == 0)
+            return {};
+        ensure_property_list();
+        return m_property_list;
+    }
+
     auto vec = Vector<Shape::Property>();
     vec.resize(property_count());
 
@@ -145,10 +162,13 @@ void Shape::ensure_property_table() const
     if (m_property_table)
         return;
     m_property_table = make<HashMap<StringOrSymbol, PropertyMetadata>>();
+    m_property_list.clear();
 
     u32 next_offset = 0;
 
+    // The chain is replayed back to front, so it has to start with this shape.
     Vector<const Shape*, 64> transition_chain;
+    transition_chain.append(this);
     for (auto* shape = m_previous; shape; shape = shape->m_previous) {
         if (shape->m_property_table) {
             *m_property_table = *shape->m_property_table;
@@ -157,7 +177,6 @@ void Shape::ensure_property_table() const
         }
         transition_chain.append(shape);
     }
-    transition_chain.append(this);
 
     for (ssize_t i = transition_chain.size() - 1; i >= 0; --i) {
         auto* shape = transition_chain[i];
@@ -175,6 +194,43 @@ void Shape::ensure_property_table() const
     }
 }
 
+void Shape::ensure_property_list() const
+{
+    VERIFY(uses_property_list());
+    if (has_property_list())
+        return;
+
+    m_property_list.clear();
+    m_property_list.ensure_capacity(m_property_count);
+
+    // The chain is replayed back to front, so it has to start with this shape.
+    Vector<const Shape*, max_property_count_for_property_list> transition_chain;
+    transition_chain.append(this);
+    for (auto* shape = m_previous; shape; shape = shape->m_previous) {
+        if (shape->m_property_table || shape->has_property_list()) {
+            m_property_list.extend(shape->property_table_ordered());
+            break;
+        }
+        transition_chain.append(shape);
+    }
+
+    for (ssize_t i = transition_chain.size() - 1; i >= 0; --i) {
+        auto* shape = transition_chain[i];
+        if (!shape->m_property_name.is_valid()) {
+            // Ignore prototype transitions as they don't affect the key map.
+            continue;
+        }
+        if (shape->m_transition_type == TransitionType::Put) {
+            m_property_list.append({ shape->m_property_name, { m_property_list.size(), shape->m_attributes } });
+        } else if (shape->m_transition_type == TransitionType::Configure) {
+            auto it = m_property_list.find_if([&](auto& property) { return property.key == shape->m_property_name; });
+            VERIFY(it != m_property_list.end());
+            it->value.attributes = shape->m_attributes;
+        }
+    }
+    VERIFY(m_property_list.size() == m_property_count);
+}
+
 void Shape::add_property_to_unique_shape(const StringOrSymbol& property_name, PropertyAttributes attributes)
 {
     VERIFY(is_unique());
@@ -211,6 +267,7 @@ void Shape::add_property_without_transition(StringOrSymbol const& property_name,
 {
     VERIFY(property_name.is_valid());
     ensure_property_table();
+    m_property_list.clear();
     if (m_property_table->set(property_name, { m_property_count, attributes }) == AK::HashSetResult::InsertedNewEntry)
         ++m_property_count;
 }
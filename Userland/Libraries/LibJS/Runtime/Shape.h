@@ -92,6 +92,12 @@ private:
     Shape* get_or_prune_cached_forward_transition(TransitionKey const&);
     void ensure_property_table() const;
 
+    // Shapes with only a few properties are searched linearly instead of through a hash table.
+    static constexpr size_t max_property_count_for_property_list = 8;
+    bool uses_property_list() const { return !m_property_table && m_property_count <= max_property_count_for_property_list; }
+    bool has_property_list() const { return m_property_count > 0 && m_property_list.size() == m_property_count; }
+    void ensure_property_list() const;
+
     PropertyAttributes m_attributes { 0 };
     TransitionType m_transition_type : 6 { TransitionType::Invalid };
     bool m_unique : 1 { false };
@@ -99,6 +105,7 @@ private:
     Object* m_global_object { nullptr };
 
     mutable OwnPtr<HashMap<StringOrSymbol, PropertyMetadata>> m_property_table;
+    mutable Vector<Property> m_property_list;
 
     HashMap<TransitionKey, WeakPtr<Shape>> m_forward_transitions;
     Shape* m_previous { nullptr };
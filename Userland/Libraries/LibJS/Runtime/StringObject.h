@@ -31,6 +31,8 @@ private:
     virtual bool internal_define_own_property(PropertyName const&, PropertyDescriptor const&) override;
     virtual MarkedValueList internal_own_property_keys() const override;
 
+    virtual bool has_exotic_property_access() const override { return true; }
+
     virtual bool is_string_object() const final { return true; }
     virtual void visit_edges(Visitor&) override;
 
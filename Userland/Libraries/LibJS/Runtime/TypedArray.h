@@ -477,6 +477,7 @@ protected:
 
 private:
     virtual bool is_typed_array() const final { return true; }
+    virtual bool has_exotic_property_access() const final { return true; }
 };
 
 TypedArrayBase* typed_array_create(GlobalObject& global_object, FunctionObject& constructor, MarkedValueList arguments);
@@ -8,6 +8,7 @@
 #include <AK/Debug.h>
 #include <AK/ScopeGuard.h>
 #include <AK/StringBuilder.h>
+#include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Interpreter.h>
 #include <LibJS/Runtime/AbstractOperations.h>
 #include <LibJS/Runtime/Array.h>
@@ -86,39 +87,45 @@ VM::InterpreterExecutionScope::~InterpreterExecutionScope()
     m_interpreter.vm().pop_interpreter(m_interpreter);
 }
 
-void VM::gather_roots(HashTable<Cell*>& roots)
+void VM::gather_roots(Vector<Cell*>& roots)
 {
-    roots.set(m_empty_string);
+    roots.append(m_empty_string);
     for (auto* string : m_single_ascii_character_strings)
-        roots.set(string);
+        roots.append(string);
 
-    roots.set(m_exception);
+    roots.append(m_exception);
 
     if (m_last_value.is_cell())
-        roots.set(&m_last_value.as_cell());
+        roots.append(&m_last_value.as_cell());
 
     for (auto& execution_context : m_execution_context_stack) {
         if (execution_context->this_value.is_cell())
-            roots.set(&execution_context->this_value.as_cell());
-        roots.set(execution_context->arguments_object);
+            roots.append(&execution_context->this_value.as_cell());
+        roots.append(execution_context->arguments_object);
         for (auto& argument : execution_context->arguments) {
             if (argument.is_cell())
-                roots.set(&argument.as_cell());
+                roots.append(&argument.as_cell());
         }
-        roots.set(execution_context->lexical_environment);
-        roots.set(execution_context->variable_environment);
+        roots.append(execution_context->lexical_environment);
+        roots.append(execution_context->variable_environment);
     }
 
 #define __JS_ENUMERATE(SymbolName, snake_name) \
-    roots.set(well_known_symbol_##snake_name());
+    roots.append(well_known_symbol_##snake_name());
     JS_ENUMERATE_WELL_KNOWN_SYMBOLS
 #undef __JS_ENUMERATE
 
     for (auto& symbol : m_global_symbol_map)
-        roots.set(symbol.value);
+        roots.append(symbol.value);
 
     for (auto* job : m_promise_jobs)
-        roots.set(job);
+        roots.append(job);
+
+    for (auto* registry : m_finalization_registry_cleanup_jobs)
+        roots.append(registry);
+
+    if (auto* bytecode_interpreter = Bytecode::Interpreter::current())
+        bytecode_interpreter->gather_roots(roots);
 }
 
 Symbol* VM::get_global_symbol(const String& description)
@@ -84,7 +84,7 @@ public:
         Interpreter& m_interpreter;
     };
 
-    void gather_roots(HashTable<Cell*>&);
+    void gather_roots(Vector<Cell*>&);
 
 #define __JS_ENUMERATE(SymbolName, snake_name) \
     Symbol* well_known_symbol_##snake_name() const { return m_well_known_symbol_##snake_name; }
@@ -23,9 +23,14 @@ WeakMap::~WeakMap()
 {
 }
 
-void WeakMap::remove_swept_cells(Badge<Heap>, Vector<Cell*>& cells)
+void WeakMap::remove_dead_cells(Badge<Heap>)
 {
-    for (auto* cell : cells)
+    Vector<Cell*> dead_cells;
+    for (auto& it : m_values) {
+        if (!it.key->is_marked())
+            dead_cells.append(it.key);
+    }
+    for (auto* cell : dead_cells)
         m_values.remove(cell);
 }
 
@@ -0,0 +1,47 @@
+describe("elements survive storage kind transitions", () => {
+    test("int32 to double to arbitrary values", () => {
+        var a = [1, 2, 3];
+        a.push(4.5);
+        expect(a).toEqual([1, 2, 3, 4.5]);
+        a.push("foo");
+        expect(a).toEqual([1, 2, 3, 4.5, "foo"]);
+    });
+
+    test("holes in number arrays", () => {
+        var a = [1, 2, 3];
+        delete a[1];
+        expect(a).toHaveLength(3);
+        expect(1 in a).toBeFalse();
+        expect(a[1]).toBeUndefined();
+        expect(Object.keys(a)).toEqual(["0", "2"]);
+
+        var b = [];
+        b[5] = 1.5;
+        expect(b).toHaveLength(6);
+        expect(0 in b).toBeFalse();
+        expect(b[5]).toBe(1.5);
+
+        var c = [1, 2];
+        c.length = 4;
+        expect(2 in c).toBeFalse();
+        c[2] = 3;
+        expect(c.pop()).toBeUndefined();
+        expect(c).toEqual([1, 2, 3]);
+    });
+
+    test("NaN and negative zero are not mistaken for holes", () => {
+        var a = [1, NaN, -0];
+        expect(1 in a).toBeTrue();
+        expect(a[1]).toBeNaN();
+        expect(a.includes(NaN)).toBeTrue();
+        expect(Object.is(a[2], -0)).toBeTrue();
+    });
+
+    test("holey arrays grow without losing elements", () => {
+        var a = [];
+        for (var i = 0; i < 1000; ++i) a[i * 2] = i;
+        expect(a).toHaveLength(1999);
+        expect(a[1998]).toBe(999);
+        expect(1 in a).toBeFalse();
+    });
+});
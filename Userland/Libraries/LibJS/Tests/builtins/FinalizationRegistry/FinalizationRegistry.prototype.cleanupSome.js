@@ -26,6 +26,38 @@ test("basic functionality", () => {
     expect(count).toBe(1);
 });
 
+function registerWeakContainersInDifferentScope(registry, count) {
+    for (let i = 0; i < count; ++i) registry.register(new WeakMap(), i);
+}
+
+test("targets that are weak containers themselves", () => {
+    // The dead targets fill whole HeapBlocks, which are freed by the same collection.
+    var registry = new FinalizationRegistry(() => {});
+
+    var count = 0;
+    registerWeakContainersInDifferentScope(registry, 1000);
+    gc();
+
+    registry.cleanupSome(() => {
+        count++;
+    });
+
+    expect(count).toBe(1000);
+});
+
+function registerInRegistryInDifferentScope(count) {
+    const registry = new FinalizationRegistry(() => {});
+    for (let i = 0; i < count; ++i) registry.register({}, i);
+}
+
+test("registries that die together with their targets", () => {
+    // The registry is swept along with its targets, so it must not be queued for cleanup.
+    registerInRegistryInDifferentScope(1000);
+    gc();
+    for (let i = 0; i < 1000; ++i) ({ i });
+    gc();
+});
+
 test("errors", () => {
     var registry = new FinalizationRegistry(() => {});
 
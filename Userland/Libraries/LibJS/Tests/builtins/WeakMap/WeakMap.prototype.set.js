@@ -28,3 +28,16 @@ test("automatic removal of garbage-collected values", () => {
     gc();
     expect(getWeakMapSize(weakMap)).toBe(0);
 });
+
+function setWeakMapKeysInDifferentScope(weakMap, count) {
+    for (let i = 0; i < count; ++i) weakMap.set(new WeakMap(), i);
+    new WeakMap().set(new WeakMap(), count);
+}
+
+test("automatic removal of keys that are weak containers themselves", () => {
+    // The dead keys fill whole HeapBlocks, which are freed by the same collection.
+    const weakMap = new WeakMap();
+    setWeakMapKeysInDifferentScope(weakMap, 1000);
+    gc();
+    expect(getWeakMapSize(weakMap)).toBe(0);
+});
@@ -24,3 +24,16 @@ test("automatic removal of garbage-collected values", () => {
     gc();
     expect(getWeakSetSize(weakSet)).toBe(0);
 });
+
+function addWeakSetValuesInDifferentScope(weakSet, count) {
+    for (let i = 0; i < count; ++i) weakSet.add(new WeakSet());
+    new WeakSet().add(new WeakSet());
+}
+
+test("automatic removal of values that are weak containers themselves", () => {
+    // The dead values fill whole HeapBlocks, which are freed by the same collection.
+    const weakSet = new WeakSet();
+    addWeakSetValuesInDifferentScope(weakSet, 1000);
+    gc();
+    expect(getWeakSetSize(weakSet)).toBe(0);
+});
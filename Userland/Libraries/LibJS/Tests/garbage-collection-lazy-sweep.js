@@ -0,0 +1,42 @@
+test("live objects survive while the garbage around them is swept lazily", () => {
+    const kept = [];
+    for (let i = 0; i < 2000; ++i) {
+        kept.push({ i, string: "value " + i, array: [i, i + 1] });
+        for (let j = 0; j < 10; ++j) ({ j, string: "garbage " + j });
+        if (i % 250 === 0) gc();
+    }
+
+    gc();
+    for (let i = 0; i < 2000; ++i) {
+        expect(kept[i].i).toBe(i);
+        expect(kept[i].string).toBe("value " + i);
+        expect(kept[i].array).toEqual([i, i + 1]);
+    }
+});
+
+test("cells of a previous collection are reused after being swept", () => {
+    let sum = 0;
+    for (let round = 0; round < 5; ++round) {
+        let objects = [];
+        for (let i = 0; i < 5000; ++i) objects.push({ value: i });
+        for (const object of objects) sum += object.value;
+        objects = null;
+        gc();
+    }
+    expect(sum).toBe(5 * ((4999 * 5000) / 2));
+});
+
+test("garbage collection in between allocations of different sizes", () => {
+    const strings = [];
+    const objects = [];
+    for (let i = 0; i < 1000; ++i) {
+        strings.push("string " + i);
+        objects.push(new Map([[i, { i }]]));
+        if (i % 100 === 0) gc();
+    }
+
+    for (let i = 0; i < 1000; ++i) {
+        expect(strings[i]).toBe("string " + i);
+        expect(objects[i].get(i).i).toBe(i);
+    }
+});
@@ -0,0 +1,101 @@
+const makeObject = count => {
+    const object = {};
+    for (let i = 0; i < count; ++i) object["p" + i] = i;
+    return object;
+};
+
+const names = count => Array.from({ length: count }, (_, i) => "p" + i);
+
+describe("objects with few properties", () => {
+    test("keep insertion order", () => {
+        for (let count = 0; count <= 8; ++count) {
+            const object = makeObject(count);
+            expect(Object.keys(object)).toEqual(names(count));
+            for (let i = 0; i < count; ++i) expect(object["p" + i]).toBe(i);
+            expect(object.missing).toBeUndefined();
+        }
+    });
+
+    test("objects sharing a shape see the same properties", () => {
+        const a = makeObject(5);
+        const b = makeObject(5);
+        b.p2 = "changed";
+        expect(a.p2).toBe(2);
+        expect(b.p2).toBe("changed");
+        expect(Object.keys(b)).toEqual(names(5));
+    });
+
+    test("reconfigured properties", () => {
+        const object = makeObject(4);
+        Object.defineProperty(object, "p1", { writable: false });
+        object.p1 = "ignored";
+        object.p4 = 4;
+        expect(object.p1).toBe(1);
+        expect(Object.getOwnPropertyDescriptor(object, "p1").writable).toBeFalse();
+        expect(Object.getOwnPropertyDescriptor(object, "p2").writable).toBeTrue();
+        expect(Object.keys(object)).toEqual(names(5));
+    });
+
+    test("deletes", () => {
+        const object = makeObject(6);
+        delete object.p0;
+        delete object.p3;
+        expect(Object.keys(object)).toEqual(["p1", "p2", "p4", "p5"]);
+        expect(object.p3).toBeUndefined();
+        expect(object.p5).toBe(5);
+        object.p3 = "again";
+        expect(Object.keys(object)).toEqual(["p1", "p2", "p4", "p5", "p3"]);
+    });
+});
+
+describe("objects that outgrow the flat property list", () => {
+    test("keep insertion order", () => {
+        for (let count = 9; count <= 20; ++count) {
+            const object = makeObject(count);
+            expect(Object.keys(object)).toEqual(names(count));
+            for (let i = 0; i < count; ++i) expect(object["p" + i]).toBe(i);
+        }
+    });
+
+    test("keep the order of a shape that was looked up while it was small", () => {
+        const object = makeObject(8);
+        expect(object.p7).toBe(7);
+        object.p8 = 8;
+        object.p9 = 9;
+        expect(Object.keys(object)).toEqual(names(10));
+        expect(object.p0).toBe(0);
+        expect(object.p9).toBe(9);
+    });
+
+    test("reconfigured properties", () => {
+        const object = makeObject(6);
+        Object.defineProperty(object, "p2", { enumerable: false });
+        for (let i = 6; i < 12; ++i) object["p" + i] = i;
+        expect(Object.keys(object)).toEqual(names(12).filter(name => name !== "p2"));
+        expect(object.p2).toBe(2);
+        expect(object.p11).toBe(11);
+    });
+
+    test("deletes", () => {
+        const object = makeObject(12);
+        delete object.p0;
+        delete object.p8;
+        delete object.p11;
+        expect(Object.keys(object)).toEqual(
+            names(12).filter(name => !["p0", "p8", "p11"].includes(name))
+        );
+        expect(object.p8).toBeUndefined();
+        expect(object.p10).toBe(10);
+        object.p0 = "again";
+        expect(Object.keys(object).at(-1)).toBe("p0");
+        expect(object.p0).toBe("again");
+    });
+
+    test("deletes while the shape is small, then growing it", () => {
+        const object = makeObject(4);
+        delete object.p1;
+        for (let i = 4; i < 12; ++i) object["p" + i] = i;
+        expect(Object.keys(object)).toEqual(names(12).filter(name => name !== "p1"));
+        expect(object.p11).toBe(11);
+    });
+});
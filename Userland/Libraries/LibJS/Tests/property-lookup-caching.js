@@ -0,0 +1,115 @@
+// These exercise the same property access site with objects of varying shapes,
+// which is what the bytecode interpreter's property lookup caches are keyed on.
+
+describe("get", () => {
+    test("same access site, different shapes", () => {
+        const get = o => o.foo;
+        const objects = [{ foo: 1 }, { bar: 0, foo: 2 }, { baz: 0, bar: 0, foo: 3 }, { foo: 4, qux: 0 }];
+        for (let i = 0; i < 3; ++i) {
+            expect(get(objects[0])).toBe(1);
+            expect(get(objects[1])).toBe(2);
+            expect(get(objects[2])).toBe(3);
+            expect(get(objects[3])).toBe(4);
+        }
+        expect(get({})).toBeUndefined();
+    });
+
+    test("value changes without shape change", () => {
+        const get = o => o.foo;
+        const o = { foo: 1 };
+        expect(get(o)).toBe(1);
+        o.foo = 2;
+        expect(get(o)).toBe(2);
+    });
+
+    test("property found on prototype", () => {
+        const get = o => o.foo;
+        const proto = { foo: 1 };
+        const o = Object.create(proto);
+        expect(get(o)).toBe(1);
+        proto.foo = 2;
+        expect(get(o)).toBe(2);
+        o.foo = 3;
+        expect(get(o)).toBe(3);
+        delete o.foo;
+        expect(get(o)).toBe(2);
+        delete proto.foo;
+        expect(get(o)).toBeUndefined();
+    });
+
+    test("prototype is replaced", () => {
+        const get = o => o.foo;
+        const o = Object.create({ foo: 1 });
+        expect(get(o)).toBe(1);
+        Object.setPrototypeOf(o, { foo: 2 });
+        expect(get(o)).toBe(2);
+    });
+
+    test("data property is turned into an accessor", () => {
+        const get = o => o.foo;
+        const o = {};
+        Object.defineProperty(o, "foo", { value: 1, configurable: true, enumerable: true });
+        expect(get(o)).toBe(1);
+        Object.defineProperty(o, "foo", { get: () => 2, configurable: true, enumerable: true });
+        expect(get(o)).toBe(2);
+    });
+
+    test("exotic objects", () => {
+        const get = o => o.length;
+        const proto = { length: 42 };
+        const o = Object.create(proto);
+        expect(get(o)).toBe(42);
+        const a = [1, 2, 3];
+        Object.setPrototypeOf(a, proto);
+        expect(get(a)).toBe(3);
+        expect(get("foo")).toBe(3);
+        expect(get(new Proxy(o, { get: () => 1 }))).toBe(1);
+    });
+});
+
+describe("put", () => {
+    test("same access site, different shapes", () => {
+        const put = (o, v) => {
+            o.foo = v;
+        };
+        const a = { foo: 0 };
+        const b = { bar: 0, foo: 0 };
+        for (let i = 0; i < 3; ++i) {
+            put(a, i);
+            put(b, i * 2);
+            expect(a.foo).toBe(i);
+            expect(b.foo).toBe(i * 2);
+        }
+    });
+
+    test("property becomes non-writable", () => {
+        const put = (o, v) => {
+            "use strict";
+            o.foo = v;
+        };
+        const o = { foo: 0 };
+        put(o, 1);
+        expect(o.foo).toBe(1);
+        Object.freeze(o);
+        expect(() => put(o, 2)).toThrow(TypeError);
+        expect(o.foo).toBe(1);
+    });
+
+    test("data property is turned into an accessor", () => {
+        let setter_value;
+        const put = (o, v) => {
+            o.foo = v;
+        };
+        const o = {};
+        Object.defineProperty(o, "foo", { value: 0, writable: true, configurable: true });
+        put(o, 1);
+        expect(o.foo).toBe(1);
+        Object.defineProperty(o, "foo", {
+            set: v => {
+                setter_value = v;
+            },
+        });
+        put(o, 2);
+        expect(setter_value).toBe(2);
+    });
+});
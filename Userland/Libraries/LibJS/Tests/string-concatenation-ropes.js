@@ -0,0 +1,88 @@
+test("deep ropes built by appending", () => {
+    let string = "";
+    for (let i = 0; i < 100000; ++i) string += "ab";
+    expect(string.length).toBe(200000);
+    expect(string.slice(0, 4)).toBe("abab");
+    expect(string.slice(-4)).toBe("abab");
+    expect(string.indexOf("ba")).toBe(1);
+});
+
+test("deep ropes built by prepending", () => {
+    let string = "";
+    for (let i = 0; i < 100000; ++i) string = (i % 10) + string;
+    expect(string.length).toBe(100000);
+    expect(string.slice(0, 10)).toBe("9876543210");
+    expect(string.slice(-10)).toBe("9876543210");
+});
+
+test("deep ropes built from both ends", () => {
+    let string = "|";
+    for (let i = 0; i < 100000; ++i) string = "<" + string + ">";
+    expect(string.length).toBe(200001);
+    expect(string[100000]).toBe("|");
+    expect(string.lastIndexOf("<")).toBe(99999);
+    expect(string.indexOf(">")).toBe(100001);
+});
+
+test("the pieces of a rope stay alive across garbage collection", () => {
+    const ropes = [];
+    for (let i = 0; i < 100; ++i) {
+        let string = "";
+        for (let j = 0; j < 100; ++j) string += String.fromCharCode(65 + ((i + j) % 26));
+        ropes.push(string);
+    }
+    gc();
+    for (let i = 0; i < 100; ++i) {
+        expect(ropes[i].length).toBe(100);
+        expect(ropes[i].charCodeAt(0)).toBe(65 + (i % 26));
+        expect(ropes[i].charCodeAt(99)).toBe(65 + ((i + 99) % 26));
+    }
+});
+
+test("flattening a rope does not disturb ropes that share its pieces", () => {
+    const shared = "shared" + "-" + "piece";
+    const a = shared + "-a";
+    const b = "b-" + shared;
+    gc();
+    expect(a).toBe("shared-piece-a");
+    gc();
+    expect(b).toBe("b-shared-piece");
+    expect(shared).toBe("shared-piece");
+});
+
+test("UTF-16 pieces", () => {
+    const string = "äöü" + "€" + "日本語";
+    expect(string.length).toBe(7);
+    expect(string).toBe("äöü€日本語");
+    expect(string.charCodeAt(3)).toBe(0x20ac);
+});
+
+test("surrogate pairs", () => {
+    const pair = "a" + "😀" + "b";
+    expect(pair.length).toBe(4);
+    expect(pair.codePointAt(1)).toBe(0x1f600);
+
+    let repeated = "";
+    for (let i = 0; i < 1000; ++i) repeated += "😀";
+    expect(repeated.length).toBe(2000);
+    expect(repeated.codePointAt(1998)).toBe(0x1f600);
+});
+
+test("surrogate pair split across pieces", () => {
+    const string = "\ud83d" + "\ude00";
+    expect(string.length).toBe(2);
+    expect(string.codePointAt(0)).toBe(0x1f600);
+    expect(string).toBe("😀");
+});
+
+test("empty operands", () => {
+    const string = "a" + "b";
+    expect("" + string).toBe("ab");
+    expect(string + "").toBe("ab");
+    expect("" + "").toBe("");
+    expect(("" + string).length).toBe(2);
+
+    let built = "";
+    for (let i = 0; i < 10; ++i) built = "" + built + "" + i + "";
+    expect(built).toBe("0123456789");
+});
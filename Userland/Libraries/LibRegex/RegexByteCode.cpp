@@ -835,6 +835,30 @@ String const OpCode_Compare::arguments_string() const
     return String::formatted("argc={}, args={} ", arguments_count(), arguments_size());
 }
 
+bool OpCode_Compare::references_capture_groups() const
+{
+    size_t offset { state().instruction_position + 3 };
+    for (size_t i = 0; i < arguments_count(); ++i) {
+        auto compare_type = (CharacterCompareType)m_bytecode->at(offset++);
+        switch (compare_type) {
+        case CharacterCompareType::Reference:
+        case CharacterCompareType::NamedReference:
+            return true;
+        case CharacterCompareType::Inverse:
+        case CharacterCompareType::TemporaryInverse:
+        case CharacterCompareType::AnyChar:
+            break;
+        case CharacterCompareType::String:
+            offset += m_bytecode->at(offset) + 1;
+            break;
+        default:
+            ++offset;
+            break;
+        }
+    }
+    return false;
+}
+
 Vector<String> const OpCode_Compare::variable_arguments_to_string(Optional<MatchInput> input) const
 {
     Vector<String> result;
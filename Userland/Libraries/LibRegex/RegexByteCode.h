@@ -721,6 +721,7 @@ public:
     ALWAYS_INLINE size_t arguments_size() const { return argument(1); }
     String const arguments_string() const override;
     Vector<String> const variable_arguments_to_string(Optional<MatchInput> input = {}) const;
+    bool references_capture_groups() const;
 
 private:
     ALWAYS_INLINE static void compare_char(MatchInput const& input, MatchState& state, u32 ch1, bool inverse, bool& inverse_matched);
@@ -74,6 +74,9 @@ public:
         return m_view.get<Utf8View>();
     }
 
+    template<typename T>
+    bool has() const { return m_view.has<T>(); }
+
     bool unicode() const { return m_unicode; }
     void set_unicode(bool unicode) { m_unicode = unicode; }
 
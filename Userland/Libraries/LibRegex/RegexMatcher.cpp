@@ -4,12 +4,14 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Bitmap.h>
 #include <AK/BumpAllocator.h>
 #include <AK/Debug.h>
 #include <AK/String.h>
 #include <AK/StringBuilder.h>
 #include <LibRegex/RegexMatcher.h>
 #include <LibRegex/RegexParser.h>
+#include <LibThreading/Mutex.h>
 
 #if REGEX_DEBUG
 #    include <LibRegex/RegexDebug.h>
@@ -30,14 +32,89 @@ regex::Parser::Result Regex<Parser>::parse_pattern(StringView pattern, typename
     return parser.parse();
 }
 
+// The same patterns tend to get compiled over and over again (regex literals in hot functions, repeated regcomp()
+// calls, ...), so keep the most recently compiled ones around and hand out copies of their bytecode.
+template<class Parser>
+class CompiledPatternCache {
+public:
+    struct CompiledPattern {
+        // Named capture groups point into the pattern's string, so whoever uses the bytecode has to keep this alive.
+        String pattern;
+        regex::Parser::Result parser_result;
+    };
+
+    static CompiledPatternCache& the()
+    {
+        static CompiledPatternCache s_the;
+        return s_the;
+    }
+
+    Optional<CompiledPattern> get(String const& pattern, FlagsUnderlyingType options)
+    {
+        Threading::MutexLocker locker(m_lock);
+        auto it = m_entries.find({ pattern, options });
+        if (it == m_entries.end())
+            return {};
+        it->value.last_use = ++m_use_counter;
+        return CompiledPattern { it->value.compiled.pattern, it->value.compiled.parser_result };
+    }
+
+    void set(String const& pattern, FlagsUnderlyingType options, regex::Parser::Result const& parser_result)
+    {
+        Threading::MutexLocker locker(m_lock);
+        if (m_entries.size() >= c_compiled_pattern_cache_size) {
+            auto least_recently_used = m_entries.begin();
+            for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+                if (it->value.last_use < least_recently_used->value.last_use)
+                    least_recently_used = it;
+            }
+            m_entries.remove(least_recently_used);
+        }
+        m_entries.set({ pattern, options }, { { pattern, parser_result }, ++m_use_counter });
+    }
+
+private:
+    struct Key {
+        String pattern;
+        FlagsUnderlyingType options { 0 };
+
+        bool operator==(Key const& other) const { return options == other.options && pattern == other.pattern; }
+    };
+
+    struct KeyTraits : public GenericTraits<Key> {
+        static unsigned hash(Key const& key) { return pair_int_hash(key.pattern.hash(), key.options); }
+    };
+
+    struct Entry {
+        CompiledPattern compiled;
+        u64 last_use { 0 };
+    };
+
+    HashMap<Key, Entry, KeyTraits> m_entries;
+    u64 m_use_counter { 0 };
+    Threading::Mutex m_lock;
+};
+
 template<class Parser>
 Regex<Parser>::Regex(String pattern, typename ParserTraits<Parser>::OptionsType regex_options)
     : pattern_value(move(pattern))
 {
-    regex::Lexer lexer(pattern_value);
+    auto& cache = CompiledPatternCache<Parser>::the();
+    auto options = (FlagsUnderlyingType)regex_options.value();
+    if (auto compiled = cache.get(pattern_value, options); compiled.has_value()) {
+        pattern_value = move(compiled->pattern);
+        parser_result = move(compiled->parser_result);
+    } else {
+        regex::Lexer lexer(pattern_value);
 
-    Parser parser(lexer, regex_options);
-    parser_result = parser.parse();
+        Parser parser(lexer, regex_options);
+        parser_result = parser.parse();
+
+        if (parser_result.error == regex::Error::NoError) {
+            run_optimization_passes();
+            cache.set(pattern_value, options, parser_result);
+        }
+    }
 
     if (parser_result.error == regex::Error::NoError)
         matcher = make<Matcher<Parser>>(this, regex_options);
@@ -48,8 +125,10 @@ Regex<Parser>::Regex(regex::Parser::Result parse_result, String pattern, typenam
     : pattern_value(move(pattern))
     , parser_result(move(parse_result))
 {
-    if (parser_result.error == regex::Error::NoError)
+    if (parser_result.error == regex::Error::NoError) {
+        run_optimization_passes();
         matcher = make<Matcher<Parser>>(this, regex_options);
+    }
 }
 
 template<class Parser>
@@ -97,6 +176,148 @@ String Regex<Parser>::error_string(Optional<String> message) const
     return eb.build();
 }
 
+// Without backreferences and lookarounds, whether the bytecode can match from a given instruction and string position
+// does not depend on the path that led there. So once a fork has been explored from some position without finding
+// a match, exploring it again from that position is pointless. Skipping those revisits bounds the work of a whole
+// search to (number of forks) * (string length) fork executions, instead of being exponential in the worst case.
+class ExploredForkStates {
+public:
+    ExploredForkStates(size_t fork_count, size_t string_length)
+        : m_fork_count(fork_count)
+        , m_positions_per_fork(string_length + 2)
+    {
+        // Only start remembering states once there have been more fork executions than distinct states, at which
+        // point the search is guaranteed to be repeating itself. Well-behaved patterns never get that far.
+        m_forks_until_tracking = fork_count * m_positions_per_fork;
+    }
+
+    // Returns whether the fork was already explored from this position, and marks it as explored.
+    ALWAYS_INLINE bool check_and_mark(size_t fork_index, size_t string_position)
+    {
+        if (m_explored.size() == 0 && !start_tracking())
+            return false;
+        if (string_position >= m_positions_per_fork)
+            return false;
+
+        auto index = fork_index * m_positions_per_fork + string_position;
+        if (m_explored.get(index))
+            return true;
+        m_explored.set(index, true);
+        if (m_marked_indices.size() < m_explored.size_in_bytes() / sizeof(size_t))
+            m_marked_indices.append(index);
+        else
+            m_has_unlisted_marks = true;
+        return false;
+    }
+
+    // A successful match only explored the states up to the match, so those can't be assumed to fail later on.
+    void forget()
+    {
+        if (m_has_unlisted_marks) {
+            m_explored.fill(false);
+        } else {
+            for (auto index : m_marked_indices)
+                m_explored.set(index, false);
+        }
+        m_marked_indices.clear_with_capacity();
+        m_has_unlisted_marks = false;
+    }
+
+private:
+    bool start_tracking()
+    {
+        if (m_fork_count == 0 || m_forks_until_tracking-- > 0)
+            return false;
+
+        auto size = m_fork_count * m_positions_per_fork;
+        if (size > c_max_explored_fork_states) {
+            m_fork_count = 0;
+            return false;
+        }
+        m_explored = Bitmap { size, false };
+        return true;
+    }
+
+    size_t m_fork_count { 0 };
+    size_t m_positions_per_fork { 0 };
+    ssize_t m_forks_until_tracking { 0 };
+    Bitmap m_explored;
+    Vector<size_t> m_marked_indices;
+    bool m_has_unlisted_marks { false };
+};
+
+template<class Parser>
+void Matcher<Parser>::find_memoizable_forks()
+{
+    auto& bytecode = m_pattern->parser_result.bytecode;
+    Vector<size_t> fork_indices;
+    fork_indices.resize(bytecode.size());
+    size_t fork_count = 0;
+
+    MatchState state;
+    while (state.instruction_position < bytecode.size()) {
+        auto& opcode = bytecode.get_opcode(state);
+        switch (opcode.opcode_id()) {
+        case OpCodeId::ForkJump:
+        case OpCodeId::ForkStay:
+            fork_indices[state.instruction_position] = fork_count++;
+            break;
+        case OpCodeId::Save:
+        case OpCodeId::Restore:
+        case OpCodeId::GoBack:
+        case OpCodeId::FailForks:
+            // Lookarounds move back in the string and depend on forks failing, keep backtracking normally.
+            return;
+        case OpCodeId::Compare:
+            if (to<OpCode_Compare>(opcode).references_capture_groups())
+                return;
+            break;
+        default:
+            break;
+        }
+        state.instruction_position += opcode.size();
+    }
+
+    if (fork_count == 0)
+        return;
+    m_fork_indices = move(fork_indices);
+    m_fork_count = fork_count;
+}
+
+template<class Parser>
+Optional<size_t> Matcher<Parser>::find_next_possible_match_start(MatchInput const& input, size_t position) const
+{
+    auto& data = m_pattern->parser_result.optimization_data;
+    if (data.only_start_of_line && position > 0 && !input.regex_options.has_flag_set(AllFlags::MatchNotBeginOfLine))
+        return {};
+
+    if (data.starting_ranges.is_empty() || input.regex_options.has_flag_set(AllFlags::Insensitive))
+        return position;
+
+    // String positions have to be code unit indices for the scan to line up with what Compare looks at.
+    auto& view = input.view;
+    if (view.has<Utf8View>() || (view.has<Utf16View>() && view.unicode()))
+        return position;
+
+    auto view_length = view.length();
+    if (view.has<StringView>() && !data.literal_prefix.is_empty()) {
+        auto haystack = view.string_view().substring_view(min(position, view_length));
+        auto offset = AK::memmem_optional(haystack.characters_without_null_termination(), haystack.length(), data.literal_prefix.characters(), data.literal_prefix.length());
+        if (!offset.has_value())
+            return {};
+        return position + offset.value();
+    }
+
+    for (; position < view_length; ++position) {
+        auto ch = view[position];
+        for (auto& range : data.starting_ranges) {
+            if (ch >= range.from && ch <= range.to)
+                return position;
+        }
+    }
+    return {};
+}
+
 template<typename Parser>
 RegexResult Matcher<Parser>::match(RegexStringView const& view, Optional<typename ParserTraits<Parser>::OptionsType> regex_options) const
 {
@@ -197,6 +418,7 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
 
         auto view_length = view.length();
         size_t view_index = m_pattern->start_offset;
+        ExploredForkStates explored_fork_states { m_fork_count, view_length };
         state.string_position = view_index;
         state.string_position_in_code_units = view_index;
         bool succeeded = false;
@@ -214,7 +436,8 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             state.string_position_in_code_units = view_index;
             state.instruction_position = 0;
 
-            auto success = execute(input, state, temp_output);
+            auto success = execute(input, state, temp_output, explored_fork_states);
+            explored_fork_states.forget();
             // This success is acceptable only if it doesn't read anything from the input (input length is 0).
             if (state.string_position <= view_index) {
                 if (success.has_value() && success.value()) {
@@ -229,6 +452,12 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
         }
 
         for (; view_index < view_length; ++view_index) {
+            // Skip ahead to where the pattern could possibly start matching, or give up if there is no such place.
+            auto possible_match_start = find_next_possible_match_start(input, view_index);
+            if (!possible_match_start.has_value() || (!continue_search && possible_match_start.value() != view_index))
+                break;
+            view_index = possible_match_start.value();
+
             auto& match_length_minimum = m_pattern->parser_result.match_length_minimum;
             // FIXME: More performant would be to know the remaining minimum string
             //        length needed to match from the current position onwards within
@@ -246,12 +475,13 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             state.string_position_in_code_units = view_index;
             state.instruction_position = 0;
 
-            auto success = execute(input, state, output);
+            auto success = execute(input, state, output, explored_fork_states);
             if (!success.has_value())
                 return { false, 0, {}, {}, {}, output.operations };
 
             if (success.value()) {
                 succeeded = true;
+                explored_fork_states.forget();
 
                 if (input.regex_options.has_flag_set(AllFlags::MatchNotEndOfLine) && state.string_position == input.view.length()) {
                     if (!continue_search)
@@ -397,7 +627,7 @@ private:
 };
 
 template<class Parser>
-Optional<bool> Matcher<Parser>::execute(MatchInput const& input, MatchState& state, MatchOutput& output) const
+Optional<bool> Matcher<Parser>::execute(MatchInput const& input, MatchState& state, MatchOutput& output, ExploredForkStates& explored_fork_states) const
 {
     state.recursion_level = 0;
 
@@ -417,6 +647,10 @@ Optional<bool> Matcher<Parser>::execute(MatchInput const& input, MatchState& sta
         if (input.fail_counter > 0) {
             --input.fail_counter;
             result = ExecutionResult::Failed_ExecuteLowPrioForks;
+        } else if (!m_fork_indices.is_empty()
+            && (opcode.opcode_id() == OpCodeId::ForkJump || opcode.opcode_id() == OpCodeId::ForkStay)
+            && explored_fork_states.check_and_mark(m_fork_indices[state.instruction_position], state.string_position)) {
+            result = ExecutionResult::Failed_ExecuteLowPrioForks;
         } else {
             result = opcode.execute(input, state, output);
         }
@@ -25,6 +25,8 @@ namespace regex {
 
 static constexpr const size_t c_max_recursion = 5000;
 static constexpr const size_t c_match_preallocation_count = 0;
+static constexpr const size_t c_max_explored_fork_states = 64 * MiB;
+static constexpr const size_t c_compiled_pattern_cache_size = 64;
 
 struct RegexResult final {
     bool success { false };
@@ -40,6 +42,8 @@ struct RegexResult final {
 template<class Parser>
 class Regex;
 
+class ExploredForkStates;
+
 template<class Parser>
 class Matcher final {
 
@@ -48,6 +52,7 @@ public:
         : m_pattern(pattern)
         , m_regex_options(regex_options.value_or({}))
     {
+        find_memoizable_forks();
     }
     ~Matcher() = default;
 
@@ -65,10 +70,16 @@ public:
     }
 
 private:
-    Optional<bool> execute(MatchInput const& input, MatchState& state, MatchOutput& output) const;
+    Optional<bool> execute(MatchInput const& input, MatchState& state, MatchOutput& output, ExploredForkStates& explored_fork_states) const;
+    void find_memoizable_forks();
+    Optional<size_t> find_next_possible_match_start(MatchInput const& input, size_t position) const;
 
     Regex<Parser> const* m_pattern;
     typename ParserTraits<Parser>::OptionsType const m_regex_options;
+
+    // Dense index of each ForkJump/ForkStay by instruction position, empty if the pattern has backreferences or lookarounds.
+    Vector<size_t> m_fork_indices;
+    size_t m_fork_count { 0 };
 };
 
 template<class Parser>
@@ -217,6 +228,10 @@ public:
         RegexResult result = matcher->match(views, AllOptions { regex_options.value_or({}) } | AllFlags::SkipSubExprResults);
         return result.success;
     }
+
+private:
+    void run_optimization_passes();
+    void fill_optimization_data();
 };
 
 // free standing functions for match, search and has_match
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/StringBuilder.h>
+#include <LibRegex/RegexMatcher.h>
+
+namespace regex {
+
+static constexpr size_t max_starting_ranges = 64;
+
+template<class Parser>
+void Regex<Parser>::run_optimization_passes()
+{
+    fill_optimization_data();
+}
+
+// Appends the code points the Compare at the given position can start a match with, returns false if that is not known.
+static bool collect_starting_ranges(OpCode_Compare const& compare, Vector<CharRange>& ranges)
+{
+    auto& bytecode = compare.bytecode();
+    size_t offset = compare.state().instruction_position + 3;
+    for (size_t i = 0; i < compare.arguments_count(); ++i) {
+        auto compare_type = (CharacterCompareType)bytecode[offset++];
+        switch (compare_type) {
+        case CharacterCompareType::Char: {
+            // Non-ASCII characters are compared as encoded strings, which doesn't line up with the code units of every view.
+            auto ch = (u32)bytecode[offset++];
+            if (ch > 0x7f)
+                return false;
+            ranges.empend(ch, ch);
+            break;
+        }
+        case CharacterCompareType::String: {
+            auto length = bytecode[offset];
+            if (length == 0 || bytecode[offset + 1] > 0x7f)
+                return false;
+            ranges.empend((u32)bytecode[offset + 1], (u32)bytecode[offset + 1]);
+            offset += length + 1;
+            break;
+        }
+        case CharacterCompareType::CharRange: {
+            CharRange range = bytecode[offset++];
+            ranges.empend(range.from, range.to);
+            break;
+        }
+        default:
+            // Inversions, classes and properties could match almost anything, don't bother.
+            return false;
+        }
+    }
+    return ranges.size() <= max_starting_ranges;
+}
+
+// Appends the ASCII text the Compare at the given position matches literally, returns false if it does anything else.
+static bool append_literal_text(OpCode_Compare const& compare, StringBuilder& builder)
+{
+    if (compare.arguments_count() != 1)
+        return false;
+
+    auto& bytecode = compare.bytecode();
+    size_t offset = compare.state().instruction_position + 3;
+    auto compare_type = (CharacterCompareType)bytecode[offset++];
+    size_t length = 1;
+    if (compare_type == CharacterCompareType::String)
+        length = bytecode[offset++];
+    else if (compare_type != CharacterCompareType::Char)
+        return false;
+
+    for (size_t i = 0; i < length; ++i) {
+        auto ch = bytecode[offset + i];
+        if (ch > 0x7f)
+            return false;
+        builder.append((char)ch);
+    }
+    return true;
+}
+
+template<class Parser>
+void Regex<Parser>::fill_optimization_data()
+{
+    auto& bytecode = parser_result.bytecode;
+    auto& data = parser_result.optimization_data;
+    data = {};
+
+    auto is_zero_width = [](OpCodeId id) {
+        switch (id) {
+        case OpCodeId::SaveLeftCaptureGroup:
+        case OpCodeId::SaveRightCaptureGroup:
+        case OpCodeId::SaveLeftNamedCaptureGroup:
+        case OpCodeId::SaveRightNamedCaptureGroup:
+        case OpCodeId::ClearCaptureGroup:
+        case OpCodeId::ClearNamedCaptureGroup:
+            return true;
+        default:
+            return false;
+        }
+    };
+
+    // Follow the straight-line code at the start of the pattern for an anchor and a literal prefix.
+    MatchState state;
+    StringBuilder literal_prefix;
+    while (state.instruction_position < bytecode.size()) {
+        auto& opcode = bytecode.get_opcode(state);
+        if (opcode.opcode_id() == OpCodeId::CheckBegin) {
+            data.only_start_of_line = true;
+        } else if (opcode.opcode_id() == OpCodeId::Compare) {
+            if (!append_literal_text(to<OpCode_Compare>(opcode), literal_prefix))
+                break;
+        } else if (!is_zero_width(opcode.opcode_id())) {
+            break;
+        }
+        state.instruction_position += opcode.size();
+    }
+    data.literal_prefix = literal_prefix.to_string();
+
+    // A pattern that can match the empty string can start anywhere.
+    if (parser_result.match_length_minimum == 0)
+        return;
+
+    // Collect the first Compare on every path through the pattern.
+    Vector<CharRange> starting_ranges;
+    Vector<bool> visited;
+    visited.resize(bytecode.size());
+    Vector<size_t> positions_to_visit;
+    positions_to_visit.append(0);
+    while (!positions_to_visit.is_empty()) {
+        state.instruction_position = positions_to_visit.take_last();
+        if (state.instruction_position >= bytecode.size())
+            return;
+        if (visited[state.instruction_position])
+            continue;
+        visited[state.instruction_position] = true;
+
+        auto& opcode = bytecode.get_opcode(state);
+        auto next_position = state.instruction_position + opcode.size();
+        switch (opcode.opcode_id()) {
+        case OpCodeId::Compare:
+            if (!collect_starting_ranges(to<OpCode_Compare>(opcode), starting_ranges))
+                return;
+            break;
+        case OpCodeId::Jump:
+            positions_to_visit.append(next_position + static_cast<OpCode_Jump const&>(opcode).offset());
+            break;
+        case OpCodeId::ForkJump:
+            positions_to_visit.append(next_position);
+            positions_to_visit.append(next_position + static_cast<OpCode_ForkJump const&>(opcode).offset());
+            break;
+        case OpCodeId::ForkStay:
+            positions_to_visit.append(next_position);
+            positions_to_visit.append(next_position + static_cast<OpCode_ForkStay const&>(opcode).offset());
+            break;
+        case OpCodeId::CheckBegin:
+        case OpCodeId::CheckEnd:
+        case OpCodeId::CheckBoundary:
+            positions_to_visit.append(next_position);
+            break;
+        default:
+            if (!is_zero_width(opcode.opcode_id()))
+                return;
+            positions_to_visit.append(next_position);
+            break;
+        }
+    }
+
+    data.starting_ranges = move(starting_ranges);
+    dbgln_if(REGEX_DEBUG, "[optimizer] {} starting ranges, literal prefix '{}', anchored: {}", data.starting_ranges.size(), data.literal_prefix, data.only_start_of_line);
+}
+
+template void Regex<PosixBasicParser>::run_optimization_passes();
+template void Regex<PosixExtendedParser>::run_optimization_passes();
+template void Regex<ECMA262Parser>::run_optimization_passes();
+
+}
@@ -53,6 +53,15 @@ public:
         size_t match_length_minimum;
         Error error;
         Token error_token;
+
+        struct OptimizationData {
+            // Every match starts with a code point in one of these ranges, empty if that is not known.
+            Vector<CharRange> starting_ranges;
+            // Every match starts with this (ASCII) text, empty if that is not known.
+            String literal_prefix;
+            // The pattern can only match at the start of the input (or of a line).
+            bool only_start_of_line { false };
+        } optimization_data {};
     };
 
     explicit Parser(Lexer& lexer)
@@ -19,6 +19,9 @@ ByteBuffer TLSv12::build_hello()
 {
     fill_with_random(&m_context.local_random, 32);
 
+    if (!m_context.session_id_size)
+        offer_cached_session();
+
     auto packet_version = (u16)m_context.options.version;
     auto version = (u16)m_context.options.version;
     PacketBuilder builder { MessageType::Handshake, packet_version };
@@ -77,6 +80,12 @@ ByteBuffer TLSv12::build_hello()
     if (sni_length)
         extension_length += sni_length + 9;
 
+    // session_ticket: 2b extension ID, 2b extension length, and the ticket (RFC 5077 section 3.2)
+    // An empty ticket tells the server that we'd like to get one.
+    auto use_session_ticket = m_context.options.use_session_resumption;
+    if (use_session_ticket)
+        extension_length += 2 + 2 + m_context.extensions.session_ticket.size();
+
     builder.append((u16)extension_length);
 
     if (sni_length) {
@@ -105,6 +114,13 @@ ByteBuffer TLSv12::build_hello()
         builder.append((u8)entry.signature);
     }
 
+    if (use_session_ticket) {
+        // session_ticket extension
+        builder.append((u16)HandshakeExtension::SessionTicket);
+        builder.append((u16)m_context.extensions.session_ticket.size());
+        builder.append(m_context.extensions.session_ticket.bytes());
+    }
+
     if (alpn_length) {
         // TODO
         VERIFY_NOT_REACHED();
@@ -151,11 +167,7 @@ ByteBuffer TLSv12::build_handshake_finished()
 
     u8 out[verify_data_length];
     auto outbuffer = Bytes { out, verify_data_length };
-    auto dummy = ByteBuffer::create_zeroed(0);
-
-    auto digest = m_context.handshake_hash.digest();
-    auto hashbuf = ReadonlyBytes { digest.immutable_data(), m_context.handshake_hash.digest_size() };
-    pseudorandom_function(outbuffer, m_context.master_key, (const u8*)"client finished", 15, hashbuf, dummy);
+    compute_verify_data(outbuffer, "client finished"sv);
 
     builder.append(outbuffer);
     auto packet = builder.build();
@@ -164,6 +176,16 @@ ByteBuffer TLSv12::build_handshake_finished()
     return packet;
 }
 
+void TLSv12::compute_verify_data(Bytes output, StringView label)
+{
+    // RFC 5246 section 7.4.9: verify_data = PRF(master_secret, finished_label, Hash(handshake_messages))
+    //                         The hash keeps going afterwards, the other side's Finished covers this one.
+    auto dummy = ByteBuffer::create_zeroed(0);
+    auto digest = m_context.handshake_hash.peek();
+    auto hashbuf = ReadonlyBytes { digest.immutable_data(), m_context.handshake_hash.digest_size() };
+    pseudorandom_function(output, m_context.master_key, (const u8*)label.characters_without_null_termination(), label.length(), hashbuf, dummy);
+}
+
 ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage& write_packets)
 {
     if (m_context.connection_status < ConnectionStatus::KeyExchange || m_context.connection_status == ConnectionStatus::Established) {
@@ -191,9 +213,22 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
         return (i8)Error::NeedMoreData;
     }
 
-    // TODO: Compare Hashes
-    dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
-    m_context.connection_status = ConnectionStatus::Established;
+    // See build_handshake_finished() about the length of verify_data.
+    constexpr u32 verify_data_length = 12;
+    if (size != verify_data_length) {
+        dbgln("unexpected finished message of size {}", size);
+        return (i8)Error::BrokenPacket;
+    }
+
+    u8 expected[verify_data_length];
+    auto expected_verify_data = Bytes { expected, verify_data_length };
+    compute_verify_data(expected_verify_data, "server finished"sv);
+    if (memcmp(buffer.offset_pointer(index), expected, verify_data_length) != 0) {
+        dbgln("server finished message doesn't match the handshake");
+        // RFC 5246 section 7.2.2: The session of a failed handshake must not be resumed.
+        forget_session();
+        return (i8)Error::NotVerified;
+    }
 
     if (m_handshake_timeout_timer) {
         // Disable the handshake timeout timer as handshake has been established.
@@ -202,6 +237,17 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
         m_handshake_timeout_timer = nullptr;
     }
 
+    cache_session();
+
+    if (m_context.is_resuming_session) {
+        // RFC 5246 section 7.3: In an abbreviated handshake, the server finishes first,
+        //                       the connection is established once we've sent our own Finished.
+        write_packets = WritePacketStage::Finished;
+        return index + size;
+    }
+
+    m_context.connection_status = ConnectionStatus::Established;
+
     if (on_tls_ready_to_write)
         on_tls_ready_to_write(*this);
 
@@ -274,6 +320,20 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             dbgln("unsupported: DTLS");
             payload_res = (i8)Error::UnexpectedMessage;
             break;
+        case NewSessionTicket:
+            if (m_context.handshake_messages[11] >= 1) {
+                dbgln("unexpected new session ticket message");
+                payload_res = (i8)Error::UnexpectedMessage;
+                break;
+            }
+            ++m_context.handshake_messages[11];
+            dbgln_if(TLS_DEBUG, "new session ticket");
+            if (m_context.is_server) {
+                dbgln("unsupported: server mode");
+                VERIFY_NOT_REACHED();
+            }
+            payload_res = handle_new_session_ticket(buffer.slice(1, payload_size));
+            break;
         case CertificateMessage:
             if (m_context.handshake_messages[4] >= 1) {
                 dbgln("unexpected certificate message");
@@ -523,6 +583,8 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 write_packet(packet);
             }
             m_context.connection_status = ConnectionStatus::Established;
+            if (on_tls_ready_to_write)
+                on_tls_ready_to_write(*this);
             break;
         }
         payload_size++;
@@ -6,6 +6,7 @@
 
 #include <AK/Debug.h>
 #include <AK/Random.h>
+#include <LibCore/DateTime.h>
 #include <LibCrypto/ASN1/DER.h>
 #include <LibCrypto/PK/Code/EMSA_PSS.h>
 #include <LibTLS/TLSv12.h>
@@ -135,6 +136,87 @@ bool TLSv12::compute_master_secret_from_pre_master_secret(size_t length)
     return true;
 }
 
+void TLSv12::offer_cached_session()
+{
+    if (!m_context.options.use_session_resumption || m_context.port == 0 || m_context.extensions.SNI.is_empty())
+        return;
+
+    auto session = SessionCache::the().find(m_context.extensions.SNI, m_context.port);
+    if (!session.has_value() || !m_context.options.usable_cipher_suites.contains_slow(session->cipher))
+        return;
+
+    if (session->session_id_size) {
+        memcpy(m_context.session_id, session->session_id, session->session_id_size);
+        m_context.session_id_size = session->session_id_size;
+    } else {
+        // RFC 5077 section 3.4: When offering a ticket, the client may make up a session ID,
+        //                       which the server echoes back if it accepts the ticket.
+        fill_with_random(m_context.session_id, sizeof(m_context.session_id));
+        m_context.session_id_size = sizeof(m_context.session_id);
+    }
+    m_context.extensions.session_ticket = session->ticket;
+
+    dbgln_if(TLS_DEBUG, "Offering cached session for {}:{}", m_context.extensions.SNI, m_context.port);
+    m_context.offered_session = session.release_value();
+}
+
+bool TLSv12::resume_offered_session()
+{
+    auto& session = m_context.offered_session.value();
+    if (session.cipher != m_context.cipher) {
+        dbgln("Server resumed a session with a different cipher suite");
+        return false;
+    }
+
+    dbgln_if(TLS_DEBUG, "Resuming cached session");
+    m_context.master_key = session.master_key;
+    if (!expand_key())
+        return false;
+
+    // There's no key exchange in an abbreviated handshake, the server's ChangeCipherSpec comes next.
+    m_context.is_resuming_session = true;
+    m_context.connection_status = ConnectionStatus::KeyExchange;
+    return true;
+}
+
+void TLSv12::cache_session()
+{
+    if (!m_context.options.use_session_resumption || m_context.port == 0 || m_context.extensions.SNI.is_empty())
+        return;
+
+    // The server gave us neither a session ID nor a ticket, so it can't resume this session anyway.
+    if (!m_context.session_id_size && m_context.extensions.session_ticket.is_empty())
+        return;
+
+    Session session;
+    session.cipher = m_context.cipher;
+    memcpy(session.session_id, m_context.session_id, m_context.session_id_size);
+    session.session_id_size = m_context.session_id_size;
+    session.master_key = m_context.master_key;
+    session.ticket = m_context.extensions.session_ticket;
+
+    auto lifetime = SessionCache::max_session_lifetime_in_seconds;
+    if (m_context.extensions.session_ticket_lifetime_hint)
+        lifetime = min(lifetime, (time_t)m_context.extensions.session_ticket_lifetime_hint);
+    session.expiry_timestamp = Core::DateTime::now().timestamp() + lifetime;
+
+    // Resuming a session doesn't make it live any longer, unless the server gave us a new ticket for it.
+    if (m_context.is_resuming_session && session.ticket == m_context.offered_session->ticket)
+        session.expiry_timestamp = min(session.expiry_timestamp, m_context.offered_session->expiry_timestamp);
+
+    SessionCache::the().store(m_context.extensions.SNI, m_context.port, move(session));
+}
+
+void TLSv12::forget_session()
+{
+    if (!m_context.options.use_session_resumption || m_context.port == 0 || m_context.extensions.SNI.is_empty())
+        return;
+
+    SessionCache::the().remove(m_context.extensions.SNI, m_context.port);
+    // Don't bring this connection's session back later.
+    m_context.options.use_session_resumption = false;
+}
+
 static bool wildcard_matches(const StringView& host, const StringView& subject)
 {
     if (host.matches(subject))
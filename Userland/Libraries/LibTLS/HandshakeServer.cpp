@@ -55,6 +55,12 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         return (i8)Error::NeedMoreData;
     }
 
+    // RFC 5246 section 7.4.1.3: The server agrees to resume the session we offered by echoing its ID back.
+    auto is_resuming_offered_session = m_context.offered_session.has_value()
+        && session_length
+        && session_length == m_context.session_id_size
+        && !memcmp(m_context.session_id, buffer.offset_pointer(res), session_length);
+
     if (session_length && session_length <= 32) {
         memcpy(m_context.session_id, buffer.offset_pointer(res), session_length);
         m_context.session_id_size = session_length;
@@ -93,6 +99,16 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
 
     if (m_context.connection_status != ConnectionStatus::Renegotiating)
         m_context.connection_status = ConnectionStatus::Negotiating;
+
+    if (is_resuming_offered_session) {
+        if (!resume_offered_session())
+            return (i8)Error::BrokenPacket;
+    } else if (m_context.offered_session.has_value()) {
+        // The server didn't want our session, so it's no good for later connections either.
+        dbgln_if(TLS_DEBUG, "Server declined to resume the cached session");
+        SessionCache::the().remove(m_context.extensions.SNI, m_context.port);
+        m_context.extensions.session_ticket.clear();
+    }
     if (m_context.is_server) {
         dbgln("unsupported: server mode");
         write_packets = WritePacketStage::ServerHandshake;
@@ -166,6 +182,10 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
                 }
             }
             res += extension_length;
+        } else if (extension_type == HandshakeExtension::SessionTicket) {
+            // RFC 5077 section 3.2: The server sends an empty extension if it's going to issue a new ticket.
+            dbgln_if(TLS_DEBUG, "Server will send a new session ticket");
+            res += extension_length;
         } else if (extension_type == HandshakeExtension::SignatureAlgorithms) {
             dbgln("supported signatures: ");
             print_buffer(buffer.slice(res, extension_length));
@@ -193,6 +213,52 @@ ssize_t TLSv12::handle_server_hello_done(ReadonlyBytes buffer)
     return size + 3;
 }
 
+ssize_t TLSv12::handle_new_session_ticket(ReadonlyBytes buffer)
+{
+    // RFC 5077 section 3.3: The server sends NewSessionTicket right before its ChangeCipherSpec.
+    if (m_context.connection_status != ConnectionStatus::KeyExchange || m_context.cipher_spec_set) {
+        dbgln("unexpected new session ticket message");
+        return (i8)Error::UnexpectedMessage;
+    }
+
+    SessionTicket ticket;
+    auto res = parse_new_session_ticket(buffer, ticket);
+    if (res < 0)
+        return res;
+
+    dbgln_if(TLS_DEBUG, "New session ticket of length {}, lifetime hint {}s", ticket.ticket.size(), ticket.lifetime_hint);
+
+    // An empty ticket means that the server changed its mind about giving us one.
+    m_context.extensions.session_ticket = move(ticket.ticket);
+    m_context.extensions.session_ticket_lifetime_hint = ticket.lifetime_hint;
+
+    return res;
+}
+
+ssize_t TLSv12::parse_new_session_ticket(ReadonlyBytes buffer, SessionTicket& ticket)
+{
+    if (buffer.size() < 3)
+        return (i8)Error::NeedMoreData;
+
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+
+    // ticket_lifetime_hint (4), ticket length (2), ticket
+    if (size < 6)
+        return (i8)Error::BrokenPacket;
+
+    auto lifetime_hint = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.offset_pointer(3)));
+    u16 ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(7)));
+    if (6u + ticket_length != size)
+        return (i8)Error::BrokenPacket;
+
+    ticket.lifetime_hint = lifetime_hint;
+    ticket.ticket = ByteBuffer::copy(buffer.offset_pointer(9), ticket_length);
+
+    return size + 3;
+}
+
 ByteBuffer TLSv12::build_server_key_exchange()
 {
     dbgln("FIXME: build_server_key_exchange");
@@ -35,27 +35,185 @@ void TLSv12::alert(AlertLevel level, AlertDescription code)
     flush();
 }
 
+// Outgoing records live in a ring of reusable buffers, so that sending data doesn't allocate once the ring is warmed up.
+// Application data is copied straight into the last record (which stays open until it's full or gets flushed),
+// encrypted in place, and all records that piled up are handed to the socket in a single write.
+constexpr static size_t InitialOutgoingRecordCount = 4;
+
+Context::OutgoingRecord& TLSv12::allocate_outgoing_record()
+{
+    auto& records = m_context.outgoing_records;
+    if (m_context.outgoing_records_count == records.size()) {
+        // The socket isn't keeping up, so grow the ring instead of dropping records.
+        Vector<Context::OutgoingRecord> grown_records;
+        grown_records.ensure_capacity(max(InitialOutgoingRecordCount, records.size() * 2));
+        for (size_t i = 0; i < records.size(); ++i)
+            grown_records.append(move(records[(m_context.outgoing_records_start + i) % records.size()]));
+        grown_records.resize(grown_records.capacity());
+        records = move(grown_records);
+        m_context.outgoing_records_start = 0;
+    }
+
+    auto& record = records[(m_context.outgoing_records_start + m_context.outgoing_records_count++) % records.size()];
+    if (record.buffer.size() < MaximumRecordSize)
+        record.buffer.resize(MaximumRecordSize);
+    record.size = 0;
+    record.written = 0;
+    record.plaintext_offset = 0;
+    record.is_sealed = false;
+    return record;
+}
+
+Context::OutgoingRecord& TLSv12::open_application_record()
+{
+    if (m_context.outgoing_records_count) {
+        auto& records = m_context.outgoing_records;
+        auto& last_record = records[(m_context.outgoing_records_start + m_context.outgoing_records_count - 1) % records.size()];
+        if (!last_record.is_sealed)
+            return last_record;
+    }
+
+    auto& record = allocate_outgoing_record();
+    record.buffer[0] = (u8)MessageType::ApplicationData;
+    ByteReader::store(record.buffer.offset_pointer(1), AK::convert_between_host_and_network_endian((u16)m_context.options.version));
+
+    // Leave room for the explicit IV, it's only filled in once the record gets sealed.
+    record.plaintext_offset = 5;
+    if (m_context.cipher_spec_set && m_context.crypto.created == 1)
+        record.plaintext_offset += is_aead() ? 8 : iv_length();
+    record.size = record.plaintext_offset;
+    return record;
+}
+
+void TLSv12::seal_record(Context::OutgoingRecord& record)
+{
+    VERIFY(!record.is_sealed);
+    constexpr size_t header_size = 5;
+    auto plaintext_length = record.size - record.plaintext_offset;
+    auto record_bytes = record.buffer.bytes();
+
+    if (m_context.cipher_spec_set && m_context.crypto.created == 1) {
+        m_cipher_local.visit(
+            [&](Empty&) { VERIFY_NOT_REACHED(); },
+            [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
+                VERIFY(is_aead());
+                // AEAD AAD (13)
+                // Seq. no (8)
+                // content type (1)
+                // version (2)
+                // length (2)
+                u8 aad[13];
+                Bytes aad_bytes { aad, 13 };
+                OutputMemoryStream aad_stream { aad_bytes };
+
+                u64 seq_no = AK::convert_between_host_and_network_endian(m_context.local_sequence_number);
+                u16 len = AK::convert_between_host_and_network_endian((u16)plaintext_length);
+
+                aad_stream.write({ &seq_no, sizeof(seq_no) });
+                aad_stream.write(record_bytes.slice(0, 3)); // content-type + version
+                aad_stream.write({ &len, sizeof(len) });    // length
+                VERIFY(aad_stream.is_end());
+
+                // AEAD IV (12)
+                // IV (4)
+                // (Nonce) (8)
+                // -- Our GCM impl takes 16 bytes
+                // zero (4)
+                u8 iv[16];
+                Bytes iv_bytes { iv, 16 };
+                Bytes { m_context.crypto.local_aead_iv, 4 }.copy_to(iv_bytes);
+                fill_with_random(iv_bytes.offset(4), 8);
+                memset(iv_bytes.offset(12), 0, 4);
+
+                // write the random part of the iv out
+                iv_bytes.slice(4, 8).copy_to(record_bytes.slice(header_size));
+
+                auto plaintext = record_bytes.slice(record.plaintext_offset, plaintext_length);
+                gcm.encrypt(plaintext, plaintext, iv_bytes, aad_bytes, record_bytes.slice(record.size, 16));
+                record.size += 16;
+            },
+            [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
+                VERIFY(!is_aead());
+                auto block_size = cbc.cipher().block_size();
+                auto mac_size = mac_length();
+
+                // The MAC covers the header as it would look for the plaintext.
+                u8 mac_header[header_size];
+                memcpy(mac_header, record_bytes.data(), 3);
+                ByteReader::store(mac_header + 3, AK::convert_between_host_and_network_endian((u16)plaintext_length));
+                auto mac = hmac_message({ mac_header, header_size }, record_bytes.slice(record.plaintext_offset, plaintext_length), mac_size, true);
+                mac.bytes().copy_to(record_bytes.slice(record.size));
+                record.size += mac_size;
+
+                // Apply the padding (a packet MUST always be padded)
+                auto padding = block_size - (record.size - record.plaintext_offset) % block_size;
+                memset(record_bytes.offset(record.size), padding - 1, padding);
+                record.size += padding;
+
+                auto iv = record_bytes.slice(header_size, record.plaintext_offset - header_size);
+                fill_with_random(iv.data(), iv.size());
+
+                auto ciphertext = record_bytes.slice(record.plaintext_offset, record.size - record.plaintext_offset);
+                cbc.encrypt(ciphertext, ciphertext, iv);
+            });
+    }
+
+    ByteReader::store(record_bytes.offset(3), AK::convert_between_host_and_network_endian((u16)(record.size - header_size)));
+    record.is_sealed = true;
+    ++m_context.local_sequence_number;
+}
+
+void TLSv12::seal_open_record()
+{
+    if (!m_context.outgoing_records_count)
+        return;
+
+    auto& records = m_context.outgoing_records;
+    auto& last_record = records[(m_context.outgoing_records_start + m_context.outgoing_records_count - 1) % records.size()];
+    if (!last_record.is_sealed)
+        seal_record(last_record);
+}
+
+void TLSv12::drop_outgoing_records()
+{
+    m_context.outgoing_records_start = 0;
+    m_context.outgoing_records_count = 0;
+}
+
 void TLSv12::write_packet(ByteBuffer& packet)
 {
-    m_context.tls_buffer.append(packet.data(), packet.size());
-    if (m_context.connection_status > ConnectionStatus::Disconnected) {
-        if (!m_has_scheduled_write_flush) {
-            dbgln_if(TLS_DEBUG, "Scheduling write of {}", m_context.tls_buffer.size());
-            deferred_invoke([this](auto&) { write_into_socket(); });
-            m_has_scheduled_write_flush = true;
-        } else {
-            // multiple packet are available, let's flush some out
-            dbgln_if(TLS_DEBUG, "Flushing scheduled write of {}", m_context.tls_buffer.size());
-            write_into_socket();
-            // the deferred invoke is still in place
-            m_has_scheduled_write_flush = true;
-        }
+    auto& record = allocate_outgoing_record();
+    if (record.buffer.size() < packet.size())
+        record.buffer.resize(packet.size());
+    packet.bytes().copy_to(record.buffer);
+    record.size = packet.size();
+    record.is_sealed = true;
+
+    schedule_write_flush();
+}
+
+void TLSv12::schedule_write_flush()
+{
+    if (m_context.connection_status == ConnectionStatus::Disconnected)
+        return;
+
+    if (!m_has_scheduled_write_flush) {
+        dbgln_if(TLS_DEBUG, "Scheduling write of {} records", m_context.outgoing_records_count);
+        deferred_invoke([this](auto&) { write_into_socket(); });
+        m_has_scheduled_write_flush = true;
+    } else if (m_context.outgoing_records_count > InitialOutgoingRecordCount) {
+        // Enough records piled up for a batch, let's flush some out. The deferred invoke is still in place.
+        dbgln_if(TLS_DEBUG, "Flushing scheduled write of {} records", m_context.outgoing_records_count);
+        flush();
     }
 }
 
 void TLSv12::update_packet(ByteBuffer& packet)
 {
     u32 header_size = 5;
+
+    // Any application data that's waiting to be sent has to be sealed before this packet takes the next sequence number.
+    seal_open_record();
     ByteReader::store(packet.offset_pointer(3), AK::convert_between_host_and_network_endian((u16)(packet.size() - header_size)));
 
     if (packet[0] != (u8)MessageType::ChangeCipher) {
@@ -195,7 +353,7 @@ void TLSv12::update_packet(ByteBuffer& packet)
                 ByteReader::store(ct.offset_pointer(header_size - 2), AK::convert_between_host_and_network_endian(ct_length));
 
                 // replace the packet with the ciphertext
-                packet = ct;
+                packet = move(ct);
             }
         }
     }
@@ -489,7 +647,8 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
             if (code == (u8)AlertDescription::CloseNotify) {
                 res += 2;
-                alert(AlertLevel::Critical, AlertDescription::CloseNotify);
+                // RFC 5246 section 7.2.1: close_notify is a warning, servers throw the session away after a fatal alert.
+                alert(AlertLevel::Warning, AlertDescription::CloseNotify);
                 m_context.connection_finished = true;
                 if (!m_context.cipher_spec_set) {
                     // AWS CloudFront hits this.
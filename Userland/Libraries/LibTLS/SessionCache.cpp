@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibCore/DateTime.h>
+#include <LibTLS/SessionCache.h>
+
+namespace TLS {
+
+Singleton<SessionCache> SessionCache::s_the;
+
+static String session_key(String const& host, u16 port)
+{
+    return String::formatted("{}:{}", host, port);
+}
+
+Optional<Session> SessionCache::find(String const& host, u16 port)
+{
+    auto it = m_sessions.find(session_key(host, port));
+    if (it == m_sessions.end())
+        return {};
+
+    if (it->value.expiry_timestamp <= Core::DateTime::now().timestamp()) {
+        m_sessions.remove(it);
+        return {};
+    }
+
+    return it->value;
+}
+
+void SessionCache::store(String const& host, u16 port, Session session)
+{
+    auto now = Core::DateTime::now().timestamp();
+    if (session.expiry_timestamp <= now)
+        return;
+
+    auto key = session_key(host, port);
+    if (!m_sessions.contains(key) && m_sessions.size() >= max_session_count) {
+        remove_expired_sessions(now);
+        // Still full, make room by dropping whichever session the map hands us first.
+        if (m_sessions.size() >= max_session_count)
+            m_sessions.remove(m_sessions.begin());
+    }
+
+    dbgln_if(TLS_DEBUG, "Caching session for {}", key);
+    m_sessions.set(move(key), move(session));
+}
+
+void SessionCache::remove(String const& host, u16 port)
+{
+    m_sessions.remove(session_key(host, port));
+}
+
+void SessionCache::remove_expired_sessions(time_t now)
+{
+    Vector<String> expired_keys;
+    for (auto& it : m_sessions) {
+        if (it.value.expiry_timestamp <= now)
+            expired_keys.append(it.key);
+    }
+    for (auto& key : expired_keys)
+        m_sessions.remove(key);
+}
+
+}
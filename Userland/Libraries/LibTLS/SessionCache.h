@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/Singleton.h>
+#include <AK/String.h>
+#include <AK/Types.h>
+#include <LibTLS/CipherSuite.h>
+
+namespace TLS {
+
+// Everything needed to resume a session with an abbreviated handshake (RFC 5246 section 7.3, RFC 5077).
+struct Session {
+    CipherSuite cipher { CipherSuite::Invalid };
+    u8 session_id[32];
+    u8 session_id_size { 0 };
+    ByteBuffer master_key;
+    ByteBuffer ticket;
+    time_t expiry_timestamp { 0 };
+};
+
+// The contents of a NewSessionTicket message (RFC 5077 section 3.3).
+struct SessionTicket {
+    u32 lifetime_hint { 0 };
+    ByteBuffer ticket;
+};
+
+// Sessions of past connections, keyed by the host and port they were made to.
+class SessionCache {
+public:
+    static constexpr size_t max_session_count = 256;
+    // RFC 5246 section F.1.4 suggests not keeping sessions around for more than 24 hours, we're a bit more careful.
+    static constexpr time_t max_session_lifetime_in_seconds = 60 * 60;
+
+    static SessionCache& the() { return s_the; }
+
+    Optional<Session> find(String const& host, u16 port);
+    void store(String const& host, u16 port, Session);
+    void remove(String const& host, u16 port);
+
+private:
+    static Singleton<SessionCache> s_the;
+
+    void remove_expired_sessions(time_t now);
+
+    HashMap<String, Session> m_sessions;
+};
+
+}
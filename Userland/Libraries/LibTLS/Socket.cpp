@@ -9,6 +9,9 @@
 #include <LibCore/Timer.h>
 #include <LibCrypto/PK/Code/EMSA_PSS.h>
 #include <LibTLS/TLSv12.h>
+#include <errno.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
 namespace TLS {
 
@@ -60,22 +63,51 @@ bool TLSv12::write(ReadonlyBytes buffer)
         return false;
     }
 
-    PacketBuilder builder { MessageType::ApplicationData, m_context.options.version, buffer.size() };
-    builder.append(buffer);
-    auto packet = builder.build();
+    // Small writes are coalesced into the open record, larger ones are split into records of the maximum size.
+    while (!buffer.is_empty()) {
+        auto& record = open_application_record();
+        auto chunk_size = min(buffer.size(), MaximumRecordPlaintextSize - (record.size - record.plaintext_offset));
+        buffer.slice(0, chunk_size).copy_to(record.buffer.bytes().slice(record.size));
+        record.size += chunk_size;
+        buffer = buffer.slice(chunk_size);
 
-    update_packet(packet);
-    write_packet(packet);
+        if (record.size - record.plaintext_offset == MaximumRecordPlaintextSize)
+            seal_record(record);
+    }
 
+    schedule_write_flush();
     return true;
 }
 
 bool TLSv12::connect(const String& hostname, int port)
 {
     set_sni(hostname);
+    m_context.port = port;
     return Core::Socket::connect(hostname, port);
 }
 
+bool TLSv12::establish_for_testing(int fd, CipherSuite cipher, ReadonlyBytes master_key, ReadonlyBytes client_random, ReadonlyBytes server_random)
+{
+    if (!supports_cipher(cipher) || client_random.size() != sizeof(m_context.local_random) || server_random.size() != sizeof(m_context.remote_random))
+        return false;
+
+    ::close(this->fd());
+    set_fd(fd);
+    set_mode(Core::OpenMode::ReadWrite);
+    m_connected = true;
+
+    m_context.cipher = cipher;
+    m_context.master_key = ByteBuffer::copy(master_key);
+    client_random.copy_to({ m_context.local_random, sizeof(m_context.local_random) });
+    server_random.copy_to({ m_context.remote_random, sizeof(m_context.remote_random) });
+    if (!expand_key())
+        return false;
+
+    m_context.cipher_spec_set = true;
+    m_context.connection_status = ConnectionStatus::Established;
+    return true;
+}
+
 bool TLSv12::common_connect(const struct sockaddr* saddr, socklen_t length)
 {
     if (m_context.critical_error)
@@ -109,7 +141,7 @@ bool TLSv12::common_connect(const struct sockaddr* saddr, socklen_t length)
                         // time the connection out.
                         alert(AlertLevel::Critical, AlertDescription::UserCanceled);
                         m_context.connection_finished = true;
-                        m_context.tls_buffer.clear();
+                        drop_outgoing_records();
                         m_context.error_code = Error::TimedOut;
                         m_context.critical_error = (u8)Error::TimedOut;
                         check_connection_state(false); // Notify the client.
@@ -164,11 +196,14 @@ void TLSv12::read_from_socket()
 
 void TLSv12::write_into_socket()
 {
-    dbgln_if(TLS_DEBUG, "Flushing cached records: {} established? {}", m_context.tls_buffer.size(), is_established());
+    dbgln_if(TLS_DEBUG, "Flushing cached records: {} established? {}", m_context.outgoing_records_count, is_established());
 
     m_has_scheduled_write_flush = false;
-    if (!check_connection_state(false))
+    if (!check_connection_state(false)) {
+        if (m_write_notifier)
+            m_write_notifier->set_enabled(false);
         return;
+    }
     flush();
 
     if (!is_established())
@@ -189,6 +224,9 @@ bool TLSv12::check_connection_state(bool read)
     if (m_context.critical_error) {
         dbgln_if(TLS_DEBUG, "CRITICAL ERROR {} :(", m_context.critical_error);
 
+        // RFC 5246 section 7.2.2: The session of a connection that failed must not be resumed.
+        forget_session();
+
         if (on_tls_error)
             on_tls_error((AlertDescription)m_context.critical_error);
         return false;
@@ -198,9 +236,9 @@ bool TLSv12::check_connection_state(bool read)
             if (on_tls_finished)
                 on_tls_finished();
         }
-        if (m_context.tls_buffer.size()) {
-            dbgln_if(TLS_DEBUG, "connection closed without finishing data transfer, {} bytes still in buffer and {} bytes in application buffer",
-                m_context.tls_buffer.size(),
+        if (has_pending_writes()) {
+            dbgln_if(TLS_DEBUG, "connection closed without finishing data transfer, {} records still in buffer and {} bytes in application buffer",
+                m_context.outgoing_records_count,
                 m_context.application_buffer.size());
         } else {
             m_context.connection_finished = false;
@@ -216,28 +254,71 @@ bool TLSv12::check_connection_state(bool read)
 
 bool TLSv12::flush()
 {
-    auto out_buffer = write_buffer().data();
-    size_t out_buffer_index { 0 };
-    size_t out_buffer_length = write_buffer().size();
-
-    if (out_buffer_length == 0)
+    seal_open_record();
+    if (!has_pending_writes())
         return true;
 
-    if constexpr (TLS_DEBUG) {
-        dbgln("SENDING...");
-        print_buffer(out_buffer, out_buffer_length);
+    // Hand as many records as we can to the socket in one go.
+    constexpr size_t max_records_per_write = 64;
+    auto& records = m_context.outgoing_records;
+    iovec vectors[max_records_per_write];
+    size_t vector_count = min(m_context.outgoing_records_count, max_records_per_write);
+    size_t total_size = 0;
+    for (size_t i = 0; i < vector_count; ++i) {
+        auto& record = records[(m_context.outgoing_records_start + i) % records.size()];
+        vectors[i].iov_base = record.buffer.offset_pointer(record.written);
+        vectors[i].iov_len = record.size - record.written;
+        total_size += vectors[i].iov_len;
+
+        if constexpr (TLS_DEBUG) {
+            dbgln("SENDING...");
+            print_buffer(record.buffer.bytes().slice(record.written, record.size - record.written));
+        }
     }
-    if (Core::Socket::write(&out_buffer[out_buffer_index], out_buffer_length)) {
-        write_buffer().clear();
-        return true;
+
+    auto nwritten = ::writev(fd(), vectors, vector_count);
+    if (nwritten < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Try again once the socket has room for more.
+            nwritten = 0;
+        } else {
+            set_error(errno);
+            if (m_context.send_retries++ == 10) {
+                // drop the records, we can't send
+                dbgln_if(TLS_DEBUG, "Dropping {} TLS records as max retries has been reached", m_context.outgoing_records_count);
+                drop_outgoing_records();
+                m_context.send_retries = 0;
+            }
+            return false;
+        }
     }
-    if (m_context.send_retries++ == 10) {
-        // drop the records, we can't send
-        dbgln_if(TLS_DEBUG, "Dropping {} bytes worth of TLS records as max retries has been reached", write_buffer().size());
-        write_buffer().clear();
-        m_context.send_retries = 0;
+    m_context.send_retries = 0;
+
+    // Retire the records that went out completely, and remember how far we got into the next one.
+    auto remaining_size = static_cast<size_t>(nwritten);
+    while (remaining_size > 0) {
+        auto& record = records[m_context.outgoing_records_start];
+        auto record_remaining_size = record.size - record.written;
+        if (remaining_size < record_remaining_size) {
+            record.written += remaining_size;
+            break;
+        }
+        remaining_size -= record_remaining_size;
+        m_context.outgoing_records_start = (m_context.outgoing_records_start + 1) % records.size();
+        --m_context.outgoing_records_count;
+    }
+
+    auto is_done = static_cast<size_t>(nwritten) == total_size && !has_pending_writes();
+    if (!is_done && !m_write_notifier) {
+        m_write_notifier = Core::Notifier::construct(fd(), Core::Notifier::Event::Write, this);
+        m_write_notifier->on_ready_to_write = [this] {
+            write_into_socket();
+        };
     }
-    return false;
+    if (m_write_notifier)
+        m_write_notifier->set_enabled(!is_done);
+
+    return is_done;
 }
 
 }
@@ -18,6 +18,7 @@
 #include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/PK/RSA.h>
 #include <LibTLS/CipherSuite.h>
+#include <LibTLS/SessionCache.h>
 #include <LibTLS/TLSPacketBuilder.h>
 
 namespace TLS {
@@ -121,6 +122,7 @@ enum HandshakeType {
     ClientHello = 0x01,
     ServerHello = 0x02,
     HelloVerifyRequest = 0x03,
+    NewSessionTicket = 0x04,
     CertificateMessage = 0x0b,
     ServerKeyExchange = 0x0c,
     CertificateRequest = 0x0d,
@@ -134,6 +136,7 @@ enum class HandshakeExtension : u16 {
     ServerName = 0x00,
     ApplicationLayerProtocolNegotiation = 0x10,
     SignatureAlgorithms = 0x0d,
+    SessionTicket = 0x23,
 };
 
 enum class NameType : u8 {
@@ -198,6 +201,12 @@ constexpr CipherAlgorithm get_cipher_algorithm(CipherSuite suite)
     }
 }
 
+// RFC 5246 section 6.2.1: A record carries at most 2^14 bytes of plaintext.
+constexpr static size_t MaximumRecordPlaintextSize = 16 * KiB;
+
+// Header, explicit IV, plaintext, and room for the largest MAC and padding (or the AEAD tag).
+constexpr static size_t MaximumRecordSize = 5 + 16 + MaximumRecordPlaintextSize + 64 + 16;
+
 struct Options {
     static Vector<CipherSuite> default_usable_cipher_suites()
     {
@@ -225,6 +234,7 @@ struct Options {
     OPTION_WITH_DEFAULTS(bool, use_sni, true)
     OPTION_WITH_DEFAULTS(bool, use_compression, false)
     OPTION_WITH_DEFAULTS(bool, validate_certificates, true)
+    OPTION_WITH_DEFAULTS(bool, use_session_resumption, true)
 
 #undef OPTION_WITH_DEFAULTS
 };
@@ -270,7 +280,19 @@ struct Context {
     u8 critical_error { 0 };
     Error error_code { Error::NoError };
 
-    ByteBuffer tls_buffer;
+    // A reusable buffer holding one outgoing record.
+    struct OutgoingRecord {
+        ByteBuffer buffer;
+        size_t size { 0 };
+        size_t written { 0 };
+        size_t plaintext_offset { 0 };
+        bool is_sealed { false };
+    };
+
+    // Ring of records waiting to be written to the socket, oldest first.
+    Vector<OutgoingRecord> outgoing_records;
+    size_t outgoing_records_start { 0 };
+    size_t outgoing_records_count { 0 };
 
     ByteBuffer application_buffer;
 
@@ -279,8 +301,17 @@ struct Context {
     struct {
         // Server Name Indicator
         String SNI; // I hate your existence
+        // RFC 5077 session ticket, either the one we offered or a new one the server gave us.
+        ByteBuffer session_ticket;
+        u32 session_ticket_lifetime_hint { 0 };
     } extensions;
 
+    // The port we connected to, the session cache is keyed by it and the SNI.
+    u16 port { 0 };
+    // The cached session offered in our hello, and whether the server agreed to resume it.
+    Optional<Session> offered_session;
+    bool is_resuming_session { false };
+
     u8 request_client_certificate { 0 };
 
     ByteBuffer cached_handshake;
@@ -290,7 +321,7 @@ struct Context {
     bool connection_finished { false };
 
     // message flags
-    u8 handshake_messages[11] { 0 };
+    u8 handshake_messages[12] { 0 };
     ByteBuffer user_data;
     Vector<Certificate> root_ceritificates;
 
@@ -305,10 +336,14 @@ struct Context {
 class TLSv12 : public Core::Socket {
     C_OBJECT(TLSv12)
 public:
-    ByteBuffer& write_buffer() { return m_context.tls_buffer; }
+    bool has_pending_writes() const { return m_context.outgoing_records_count > 0; }
     bool is_established() const { return m_context.connection_status == ConnectionStatus::Established; }
     virtual bool connect(const String&, int) override;
 
+    // Takes over a connected socket as if a handshake that came up with the given secrets had just finished.
+    // This only exists so that tests can check the records we send, real connections go through connect().
+    bool establish_for_testing(int fd, CipherSuite, ReadonlyBytes master_key, ReadonlyBytes client_random, ReadonlyBytes server_random);
+
     void set_sni(const StringView& sni)
     {
         if (m_context.is_server || m_context.critical_error || m_context.connection_status != ConnectionStatus::Disconnected) {
@@ -354,6 +389,9 @@ public:
         return v == Version::V12;
     }
 
+    // Parses a NewSessionTicket message starting at its length, and returns how many bytes it took up or an Error.
+    static ssize_t parse_new_session_ticket(ReadonlyBytes, SessionTicket&);
+
     Optional<ByteBuffer> read();
     ByteBuffer read(size_t max_size);
 
@@ -385,12 +423,20 @@ private:
     void update_hash(ReadonlyBytes in, size_t header_size);
 
     void write_packet(ByteBuffer& packet);
+    void schedule_write_flush();
+
+    Context::OutgoingRecord& allocate_outgoing_record();
+    Context::OutgoingRecord& open_application_record();
+    void seal_record(Context::OutgoingRecord&);
+    void seal_open_record();
+    void drop_outgoing_records();
 
     ByteBuffer build_client_key_exchange();
     ByteBuffer build_server_key_exchange();
 
     ByteBuffer build_hello();
     ByteBuffer build_handshake_finished();
+    void compute_verify_data(Bytes output, StringView label);
     ByteBuffer build_certificate();
     ByteBuffer build_done();
     ByteBuffer build_alert(bool critical, u8 code);
@@ -410,6 +456,7 @@ private:
     ssize_t handle_server_key_exchange(ReadonlyBytes);
     ssize_t handle_server_hello_done(ReadonlyBytes);
     ssize_t handle_certificate_verify(ReadonlyBytes);
+    ssize_t handle_new_session_ticket(ReadonlyBytes);
     ssize_t handle_handshake_payload(ReadonlyBytes);
     ssize_t handle_message(ReadonlyBytes);
     ssize_t handle_random(ReadonlyBytes);
@@ -488,6 +535,11 @@ private:
 
     bool compute_master_secret_from_pre_master_secret(size_t length);
 
+    void offer_cached_session();
+    bool resume_offered_session();
+    void cache_session();
+    void forget_session();
+
     Optional<size_t> verify_chain_and_get_matching_certificate(const StringView& host) const;
 
     void try_disambiguate_error() const;
@@ -508,6 +560,7 @@ private:
     i32 m_max_wait_time_for_handshake_in_seconds { 10 };
 
     RefPtr<Core::Timer> m_handshake_timeout_timer;
+    RefPtr<Core::Notifier> m_write_notifier;
 };
 
 }
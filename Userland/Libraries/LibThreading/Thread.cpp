@@ -21,7 +21,9 @@ Threading::Thread::Thread(Function<intptr_t()> action, StringView thread_name)
 Threading::Thread::~Thread()
 {
     if (m_tid && !m_detached) {
-        dbgln("Destroying thread \"{}\"({}) while it is still running!", m_thread_name, m_tid);
+        if (!m_finished)
+            dbgln("Destroying thread \"{}\"({}) while it is still running!", m_thread_name, m_tid);
+        // Even a thread that has finished has to be joined to release its resources.
         [[maybe_unused]] auto res = join();
     }
 }
@@ -34,7 +36,7 @@ void Threading::Thread::start()
         [](void* arg) -> void* {
             Thread* self = static_cast<Thread*>(arg);
             auto exit_code = self->m_action();
-            self->m_tid = 0;
+            self->m_finished = true;
             return reinterpret_cast<void*>(exit_code);
         },
         static_cast<void*>(this));
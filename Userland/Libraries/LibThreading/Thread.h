@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/DistinctNumeric.h>
 #include <AK/Function.h>
 #include <AK/Result.h>
@@ -39,6 +40,7 @@ private:
     pthread_t m_tid { 0 };
     String m_thread_name;
     bool m_detached { false };
+    Atomic<bool> m_finished { false };
 };
 
 template<typename T>
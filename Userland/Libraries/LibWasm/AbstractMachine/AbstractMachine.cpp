@@ -12,14 +12,14 @@
 
 namespace Wasm {
 
-Optional<FunctionAddress> Store::allocate(ModuleInstance& module, Module::Function const& function)
+Optional<FunctionAddress> Store::allocate(ModuleInstance& module, Module::Function const& function, FunctionMetadata metadata)
 {
     FunctionAddress address { m_functions.size() };
     if (function.type().value() > module.types().size())
         return {};
 
     auto& type = module.types()[function.type().value()];
-    m_functions.empend(WasmFunction { type, module, function });
+    m_functions.empend(WasmFunction { type, module, function, metadata });
     return address;
 }
 
@@ -110,7 +110,9 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
         main_module_instance.types() = section.types();
     });
 
-    // FIXME: Validate stuff
+    Validator validator { module };
+    if (auto error = validator.validate(); error.has_value())
+        return InstantiationError { String::formatted("Validation failed: {}", error->error) };
 
     Vector<Value> global_values;
     Vector<Vector<Reference>> elements;
@@ -147,7 +149,7 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
     if (instantiation_result.has_value())
         return instantiation_result.release_value();
 
-    if (auto result = allocate_all_initial_phase(module, main_module_instance, externs, global_values); result.has_value())
+    if (auto result = allocate_all_initial_phase(module, main_module_instance, externs, global_values, validator.function_metadata()); result.has_value())
         return result.release_value();
 
     module.for_each_section_of_type<ElementSection>([&](ElementSection const& section) {
@@ -180,7 +182,7 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
                         return IterationDecision::Continue;
                     }
                     // FIXME: type-check the reference.
-                    references.prepend(reference.release_value());
+                    references.append(reference.release_value());
                 }
             }
             elements.append(move(references));
@@ -334,7 +336,7 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
     return InstantiationResult { move(main_module_instance_pointer) };
 }
 
-Optional<InstantiationError> AbstractMachine::allocate_all_initial_phase(Module const& module, ModuleInstance& module_instance, Vector<ExternValue>& externs, Vector<Value>& global_values)
+Optional<InstantiationError> AbstractMachine::allocate_all_initial_phase(Module const& module, ModuleInstance& module_instance, Vector<ExternValue>& externs, Vector<Value>& global_values, Vector<FunctionMetadata> const& function_metadata)
 {
     Optional<InstantiationError> result;
 
@@ -348,8 +350,8 @@ Optional<InstantiationError> AbstractMachine::allocate_all_initial_phase(Module
 
     // FIXME: What if this fails?
 
-    for (auto& func : module.functions()) {
-        auto address = m_store.allocate(module_instance, func);
+    for (size_t i = 0; i < module.functions().size(); ++i) {
+        auto address = m_store.allocate(module_instance, module.functions()[i], function_metadata[i]);
         VERIFY(address.has_value());
         module_instance.functions().append(*address);
     }
@@ -11,6 +11,8 @@
 #include <AK/HashTable.h>
 #include <AK/OwnPtr.h>
 #include <AK/Result.h>
+#include <LibWasm/AbstractMachine/CompiledFunction.h>
+#include <LibWasm/AbstractMachine/Validator.h>
 #include <LibWasm/Types.h>
 
 namespace Wasm {
@@ -280,21 +282,36 @@ private:
 
 class WasmFunction {
 public:
-    explicit WasmFunction(FunctionType const& type, ModuleInstance const& module, Module::Function const& code)
+    explicit WasmFunction(FunctionType const& type, ModuleInstance const& module, Module::Function const& code, FunctionMetadata metadata)
         : m_type(type)
         , m_module(module)
         , m_code(code)
+        , m_metadata(metadata)
     {
     }
 
     auto& type() const { return m_type; }
     auto& module() const { return m_module; }
     auto& code() const { return m_code; }
+    auto& metadata() const { return m_metadata; }
+
+    // Compiles the function on first use, returns null if it can't be compiled.
+    CompiledFunction const* compiled(Store& store)
+    {
+        if (!m_attempted_compilation) {
+            m_attempted_compilation = true;
+            m_compiled = CompiledFunction::compile(*this, store);
+        }
+        return m_compiled.ptr();
+    }
 
 private:
     FunctionType m_type;
     ModuleInstance const& m_module;
     Module::Function const& m_code;
+    FunctionMetadata m_metadata;
+    OwnPtr<CompiledFunction> m_compiled;
+    bool m_attempted_compilation { false };
 };
 
 class HostFunction {
@@ -351,13 +368,22 @@ public:
             return true;
         auto new_size = m_data.size() + size_to_grow;
         // Can't grow past 2^16 pages.
-        if (new_size >= Constants::page_size * 65536)
+        size_t maximum_size = Constants::page_size * 65536;
+        if (new_size >= maximum_size)
             return false;
         if (auto max = m_type.limits().max(); max.has_value()) {
-            if (max.value() * Constants::page_size < new_size)
+            maximum_size = max.value() * Constants::page_size;
+            if (maximum_size < new_size)
                 return false;
         }
         auto previous_size = m_size;
+        if (new_size > m_data.capacity()) {
+            // Modules tend to grow their memory a few pages at a time, so grow the allocation geometrically
+            // instead of copying all of the memory on every memory.grow. Large memories only get a fixed
+            // amount of slack though, as the maximum size can be as large as 4 GiB.
+            auto extra_capacity = min(m_data.capacity(), maximum_extra_capacity_on_grow);
+            m_data.ensure_capacity(min(max(new_size, m_data.capacity() + extra_capacity), maximum_size));
+        }
         m_data.resize(new_size);
         m_size = new_size;
         // The spec requires that we zero out everything on grow
@@ -365,6 +391,8 @@ public:
         return true;
     }
 
+    static constexpr size_t maximum_extra_capacity_on_grow = 16 * MiB;
+
 private:
     MemoryType const& m_type;
     size_t m_size { 0 };
@@ -412,7 +440,7 @@ class Store {
 public:
     Store() = default;
 
-    Optional<FunctionAddress> allocate(ModuleInstance& module, Module::Function const& function);
+    Optional<FunctionAddress> allocate(ModuleInstance& module, Module::Function const& function, FunctionMetadata);
     Optional<FunctionAddress> allocate(HostFunction&&);
     Optional<TableAddress> allocate(TableType const&);
     Optional<MemoryAddress> allocate(MemoryType const&);
@@ -451,11 +479,12 @@ private:
 
 class Frame {
 public:
-    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity)
+    explicit Frame(ModuleInstance const& module, Vector<Value> locals, Expression const& expression, size_t arity, WasmFunction* function = nullptr)
         : m_module(module)
         , m_locals(move(locals))
         , m_expression(expression)
         , m_arity(arity)
+        , m_function(function)
     {
     }
 
@@ -464,12 +493,15 @@ public:
     auto& locals() { return m_locals; }
     auto& expression() const { return m_expression; }
     auto arity() const { return m_arity; }
+    // The function this frame belongs to, if any (constant expressions don't have one).
+    auto function() const { return m_function; }
 
 private:
     ModuleInstance const& m_module;
     Vector<Value> m_locals;
     Expression const& m_expression;
     size_t m_arity { 0 };
+    WasmFunction* m_function { nullptr };
 };
 
 class Stack {
@@ -508,7 +540,7 @@ public:
     void enable_instruction_count_limit() { m_should_limit_instruction_count = true; }
 
 private:
-    Optional<InstantiationError> allocate_all_initial_phase(Module const&, ModuleInstance&, Vector<ExternValue>&, Vector<Value>& global_values);
+    Optional<InstantiationError> allocate_all_initial_phase(Module const&, ModuleInstance&, Vector<ExternValue>&, Vector<Value>& global_values, Vector<FunctionMetadata> const&);
     Optional<InstantiationError> allocate_all_final_phase(Module const&, ModuleInstance&, Vector<Vector<Reference>>& elements);
     Store m_store;
     bool m_should_limit_instruction_count { false };
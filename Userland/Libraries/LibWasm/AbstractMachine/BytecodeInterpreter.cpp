@@ -5,6 +5,7 @@
  */
 
 #include <AK/Debug.h>
+#include <AK/Endian.h>
 #include <LibWasm/AbstractMachine/AbstractMachine.h>
 #include <LibWasm/AbstractMachine/BytecodeInterpreter.h>
 #include <LibWasm/AbstractMachine/Configuration.h>
@@ -34,6 +35,17 @@ void BytecodeInterpreter::interpret(Configuration& configuration)
 {
     m_stack_info = {};
     m_trap.clear();
+    if (auto* function = configuration.frame().function()) {
+        if (should_use_compiled_code()) {
+            if (auto* compiled_function = function->compiled(configuration.store())) {
+                interpret_compiled(configuration, *compiled_function);
+                return;
+            }
+        }
+        // Validation told us how deep the stack gets, so make room for all of it up front.
+        configuration.stack().entries().ensure_capacity(configuration.stack().size() + function->metadata().max_stack_height);
+    }
+
     auto& instructions = configuration.frame().expression().instructions();
     auto max_ip_value = InstructionPointer { instructions.size() };
     auto& current_ip_value = configuration.ip();
@@ -1116,6 +1128,430 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     }
 }
 
+template<typename T>
+ALWAYS_INLINE static T from_slot(u64 slot)
+{
+    if constexpr (IsSame<T, float>)
+        return bit_cast<float>(static_cast<u32>(slot));
+    else if constexpr (IsSame<T, double>)
+        return bit_cast<double>(slot);
+    else
+        return static_cast<T>(slot);
+}
+
+template<typename T>
+ALWAYS_INLINE static u64 to_slot(T value)
+{
+    if constexpr (IsSame<T, float>)
+        return bit_cast<u32>(value);
+    else if constexpr (IsSame<T, double>)
+        return bit_cast<u64>(value);
+    else if constexpr (sizeof(T) <= sizeof(u32))
+        return static_cast<u32>(value);
+    else
+        return static_cast<u64>(value);
+}
+
+static u64 value_to_slot(Value const& value)
+{
+    return value.value().visit(
+        [](Reference const& reference) {
+            return reference.ref().visit(
+                [](Reference::Null const&) { return null_reference_slot_value; },
+                [](auto const& reference) { return reference.address.value(); });
+        },
+        [](auto value) { return to_slot(value); });
+}
+
+static Value slot_to_value(ValueType const& type, u64 slot)
+{
+    switch (type.kind()) {
+    case ValueType::I32:
+        return Value(from_slot<i32>(slot));
+    case ValueType::I64:
+        return Value(from_slot<i64>(slot));
+    case ValueType::F32:
+        return Value(from_slot<float>(slot));
+    case ValueType::F64:
+        return Value(from_slot<double>(slot));
+    case ValueType::FunctionReference:
+    case ValueType::NullFunctionReference:
+        if (slot == null_reference_slot_value)
+            return Value(Reference { Reference::Null { ValueType(ValueType::FunctionReference) } });
+        return Value(Reference { Reference::Func { FunctionAddress { slot } } });
+    case ValueType::ExternReference:
+    case ValueType::NullExternReference:
+        if (slot == null_reference_slot_value)
+            return Value(Reference { Reference::Null { ValueType(ValueType::ExternReference) } });
+        return Value(Reference { Reference::Extern { ExternAddress { slot } } });
+    }
+    VERIFY_NOT_REACHED();
+}
+
+static bool function_types_match(FunctionType const& lhs, FunctionType const& rhs)
+{
+    auto kinds_match = [](auto& lhs, auto& rhs) {
+        if (lhs.size() != rhs.size())
+            return false;
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            if (lhs[i].kind() != rhs[i].kind())
+                return false;
+        }
+        return true;
+    };
+    return kinds_match(lhs.parameters(), rhs.parameters()) && kinds_match(lhs.results(), rhs.results());
+}
+
+// Returns an empty Optional if the operation traps.
+template<typename T, bool is_remainder>
+ALWAYS_INLINE static Optional<T> checked_division(T lhs, T rhs)
+{
+    if (rhs == 0)
+        return {};
+    if constexpr (IsSigned<T>) {
+        if (rhs == -1) {
+            if constexpr (is_remainder)
+                return 0;
+            if (lhs == NumericLimits<T>::min())
+                return {};
+            return -lhs;
+        }
+    }
+    if constexpr (is_remainder)
+        return lhs % rhs;
+    else
+        return lhs / rhs;
+}
+
+void BytecodeInterpreter::interpret_compiled(Configuration& configuration, CompiledFunction const& entry_function)
+{
+    struct CallFrame {
+        CompiledFunction const* function;
+        ModuleInstance const* module;
+        size_t base;
+        size_t ip;
+        u64 executed_instructions;
+    };
+
+    auto& store = configuration.store();
+    auto const should_limit_instruction_count = configuration.should_limit_instruction_count();
+
+    // All frames share one vector of slots, a callee's frame starts at the arguments its caller passed.
+    Vector<u64> slots;
+    Vector<CallFrame, 16> call_frames;
+    CompiledFunction const* function = &entry_function;
+    ModuleInstance const* module = &configuration.frame().module();
+    size_t base = 0;
+    size_t ip = 0;
+    u64 executed_instructions = 0;
+
+    u64* frame_slots = nullptr;
+    CompiledInstruction const* instructions = nullptr;
+    CompiledBranch const* branches = nullptr;
+    MemoryInstance* memory = nullptr;
+    u8* memory_data = nullptr;
+    u64 memory_size = 0;
+
+    auto refresh_memory = [&] {
+        if (!memory)
+            return;
+        memory_data = memory->data().data();
+        memory_size = memory->size();
+    };
+    auto enter_frame = [&] {
+        frame_slots = slots.data() + base;
+        instructions = function->instructions().data();
+        branches = function->branches().data();
+        memory = module->memories().is_empty() ? nullptr : store.get(module->memories().first());
+        refresh_memory();
+    };
+    auto initialize_locals = [&] {
+        auto& local_types = function->local_types();
+        for (size_t i = function->parameter_count(); i < local_types.size(); ++i)
+            frame_slots[i] = local_types[i].is_reference() ? null_reference_slot_value : 0;
+    };
+    auto take_branch = [&](size_t index) {
+        auto& branch = branches[index];
+        for (size_t i = 0; i < branch.count; ++i)
+            frame_slots[branch.destination + i] = frame_slots[branch.source + i];
+        ip = branch.target;
+    };
+
+    // Returns false if the call trapped.
+    auto call = [&](FunctionAddress address, size_t argument_base) {
+        auto* instance = store.get(address);
+        if (!instance) {
+            m_trap = Trap { "Call to nonexistent function" };
+            return false;
+        }
+
+        if (auto* wasm_function = instance->get_pointer<WasmFunction>()) {
+            if (auto* callee = wasm_function->compiled(store)) {
+                if (call_frames.size() >= Constants::max_allowed_call_stack_depth) {
+                    m_trap = Trap { "Call stack exhausted" };
+                    return false;
+                }
+                call_frames.append({ function, module, base, ip, executed_instructions });
+                function = callee;
+                module = &wasm_function->module();
+                base += argument_base;
+                ip = 0;
+                executed_instructions = 0;
+                if (slots.size() < base + callee->frame_size())
+                    slots.resize(base + callee->frame_size());
+                enter_frame();
+                initialize_locals();
+                return true;
+            }
+        }
+
+        // Host functions and functions that couldn't be compiled go through the configuration like any other call.
+        if (m_stack_info.size_free() < Constants::minimum_stack_space_to_keep_free) {
+            m_trap = Trap { "Call stack exhausted" };
+            return false;
+        }
+        FunctionType const* type { nullptr };
+        instance->visit([&](auto const& function) { type = &function.type(); });
+        Vector<Value> arguments;
+        arguments.ensure_capacity(type->parameters().size());
+        for (size_t i = 0; i < type->parameters().size(); ++i)
+            arguments.unchecked_append(slot_to_value(type->parameters()[i], frame_slots[argument_base + i]));
+        auto result_count = type->results().size();
+
+        Result result { Trap { ""sv } };
+        {
+            CallFrameHandle handle { *this, configuration };
+            result = configuration.call(*this, address, move(arguments));
+        }
+        if (result.is_trap()) {
+            m_trap = move(result.trap());
+            return false;
+        }
+        if (result.values().size() != result_count) {
+            m_trap = Trap { "Call returned an unexpected number of results" };
+            return false;
+        }
+
+        // The callee could have done anything to the store, including growing our memory.
+        enter_frame();
+        for (size_t i = 0; i < result_count; ++i)
+            frame_slots[argument_base + i] = value_to_slot(result.values()[i]);
+        return true;
+    };
+
+    slots.resize(function->frame_size());
+    auto& arguments = configuration.frame().locals();
+    for (size_t i = 0; i < function->parameter_count(); ++i)
+        slots[i] = value_to_slot(arguments[i]);
+    enter_frame();
+    initialize_locals();
+
+    for (;;) {
+        if (should_limit_instruction_count) {
+            if (executed_instructions++ >= Constants::max_allowed_executed_instructions_per_call) [[unlikely]] {
+                m_trap = Trap { "Exceeded maximum allowed number of instructions" };
+                return;
+            }
+        }
+
+        auto& instruction = instructions[ip++];
+        switch (instruction.opcode.value()) {
+#define M(name, operand_kind, result_kind, operand_type, result_type, expression)                           \
+    case Instructions::name.value(): {                                                                      \
+        auto value = from_slot<operand_type>(frame_slots[instruction.lhs]);                                 \
+        frame_slots[instruction.destination] = to_slot<result_type>(static_cast<result_type>(expression)); \
+        break;                                                                                              \
+    }
+            ENUMERATE_WASM_UNARY_OPERATIONS(M)
+#undef M
+#define M(name, operand_kind, result_kind, operand_type, result_type, expression)                           \
+    case Instructions::name.value(): {                                                                      \
+        auto lhs = from_slot<operand_type>(frame_slots[instruction.lhs]);                                   \
+        auto rhs = from_slot<operand_type>(frame_slots[instruction.rhs]);                                   \
+        frame_slots[instruction.destination] = to_slot<result_type>(static_cast<result_type>(expression)); \
+        break;                                                                                              \
+    }
+            ENUMERATE_WASM_BINARY_OPERATIONS(M)
+#undef M
+#define M(name, kind, memory_type, stack_type)                                                                     \
+    case Instructions::name.value(): {                                                                             \
+        auto address = static_cast<u64>(static_cast<u32>(frame_slots[instruction.lhs])) + instruction.immediate;   \
+        if (address + sizeof(memory_type) > memory_size) [[unlikely]] {                                            \
+            m_trap = Trap { "Memory access out of bounds" };                                                       \
+            return;                                                                                                \
+        }                                                                                                          \
+        LittleEndian<memory_type> value;                                                                           \
+        __builtin_memcpy(&value, memory_data + address, sizeof(value));                                            \
+        frame_slots[instruction.destination] = to_slot<stack_type>(static_cast<memory_type>(value));               \
+        break;                                                                                                     \
+    }
+            ENUMERATE_WASM_LOAD_OPERATIONS(M)
+#undef M
+#define M(name, kind, memory_type)                                                                               \
+    case Instructions::name.value(): {                                                                           \
+        auto address = static_cast<u64>(static_cast<u32>(frame_slots[instruction.lhs])) + instruction.immediate; \
+        if (address + sizeof(memory_type) > memory_size) [[unlikely]] {                                          \
+            m_trap = Trap { "Memory access out of bounds" };                                                     \
+            return;                                                                                              \
+        }                                                                                                        \
+        LittleEndian<memory_type> value = static_cast<memory_type>(frame_slots[instruction.rhs]);                \
+        __builtin_memcpy(memory_data + address, &value, sizeof(value));                                          \
+        break;                                                                                                   \
+    }
+            ENUMERATE_WASM_STORE_OPERATIONS(M)
+#undef M
+#define M(name, type, is_remainder)                                                                    \
+    case Instructions::name.value(): {                                                                 \
+        auto result = checked_division<type, is_remainder>(                                            \
+            from_slot<type>(frame_slots[instruction.lhs]), from_slot<type>(frame_slots[instruction.rhs])); \
+        if (!result.has_value()) [[unlikely]] {                                                        \
+            m_trap = Trap { "Integer division by zero or overflow" };                                  \
+            return;                                                                                    \
+        }                                                                                              \
+        frame_slots[instruction.destination] = to_slot(result.value());                                \
+        break;                                                                                         \
+    }
+            M(i32_divs, i32, false)
+            M(i32_divu, u32, false)
+            M(i32_rems, i32, true)
+            M(i32_remu, u32, true)
+            M(i64_divs, i64, false)
+            M(i64_divu, u64, false)
+            M(i64_rems, i64, true)
+            M(i64_remu, u64, true)
+#undef M
+#define M(name, operand_type, result_type, truncate)                                                   \
+    case Instructions::name.value(): {                                                                 \
+        auto result = truncate<operand_type, result_type>(from_slot<operand_type>(frame_slots[instruction.lhs])); \
+        if (m_trap.has_value()) [[unlikely]]                                                           \
+            return;                                                                                    \
+        frame_slots[instruction.destination] = to_slot(result);                                        \
+        break;                                                                                         \
+    }
+            M(i32_trunc_sf32, float, i32, checked_signed_truncate)
+            M(i32_trunc_uf32, float, i32, checked_unsigned_truncate)
+            M(i32_trunc_sf64, double, i32, checked_signed_truncate)
+            M(i32_trunc_uf64, double, i32, checked_unsigned_truncate)
+            M(i64_trunc_sf32, float, i64, checked_signed_truncate)
+            M(i64_trunc_uf32, float, i64, checked_unsigned_truncate)
+            M(i64_trunc_sf64, double, i64, checked_signed_truncate)
+            M(i64_trunc_uf64, double, i64, checked_unsigned_truncate)
+#undef M
+        case CompiledInstructions::copy.value():
+            frame_slots[instruction.destination] = frame_slots[instruction.lhs];
+            break;
+        case CompiledInstructions::constant.value():
+            frame_slots[instruction.destination] = instruction.immediate;
+            break;
+        case CompiledInstructions::jump.value():
+            ip = instruction.immediate;
+            break;
+        case CompiledInstructions::jump_if.value():
+            if (static_cast<u32>(frame_slots[instruction.lhs]) != 0)
+                ip = instruction.immediate;
+            break;
+        case CompiledInstructions::jump_unless.value():
+            if (static_cast<u32>(frame_slots[instruction.lhs]) == 0)
+                ip = instruction.immediate;
+            break;
+        case Instructions::br.value():
+            take_branch(instruction.immediate);
+            break;
+        case Instructions::br_if.value():
+            if (static_cast<u32>(frame_slots[instruction.lhs]) != 0)
+                take_branch(instruction.immediate);
+            break;
+        case Instructions::br_table.value(): {
+            auto index = static_cast<u32>(frame_slots[instruction.lhs]);
+            take_branch(instruction.immediate + min(index, instruction.rhs));
+            break;
+        }
+        case Instructions::return_.value(): {
+            for (size_t i = 0; i < instruction.rhs; ++i)
+                frame_slots[i] = frame_slots[instruction.lhs + i];
+            if (call_frames.is_empty()) {
+                auto& result_types = function->result_types();
+                for (size_t i = 0; i < result_types.size(); ++i)
+                    configuration.stack().push(slot_to_value(result_types[i], frame_slots[i]));
+                return;
+            }
+            auto caller = call_frames.take_last();
+            function = caller.function;
+            module = caller.module;
+            base = caller.base;
+            ip = caller.ip;
+            executed_instructions = caller.executed_instructions;
+            enter_frame();
+            break;
+        }
+        case Instructions::call.value():
+            if (!call(FunctionAddress { instruction.immediate }, instruction.destination))
+                return;
+            break;
+        case Instructions::call_indirect.value(): {
+            auto index = static_cast<u32>(frame_slots[instruction.lhs]);
+            auto* table = store.get(module->tables()[instruction.rhs]);
+            if (!table || index >= table->elements().size()) {
+                m_trap = Trap { "Indirect call to an element outside of the table" };
+                return;
+            }
+            auto& element = table->elements()[index];
+            if (!element.has_value() || !element->ref().has<Reference::Func>()) {
+                m_trap = Trap { "Indirect call to a null reference" };
+                return;
+            }
+            auto address = element->ref().get<Reference::Func>().address;
+            auto* callee = store.get(address);
+            if (!callee) {
+                m_trap = Trap { "Call to nonexistent function" };
+                return;
+            }
+            FunctionType const* type { nullptr };
+            callee->visit([&](auto const& function) { type = &function.type(); });
+            if (!function_types_match(*type, module->types()[instruction.immediate])) {
+                m_trap = Trap { "Indirect call to a function of the wrong type" };
+                return;
+            }
+            if (!call(address, instruction.destination))
+                return;
+            break;
+        }
+        case Instructions::unreachable.value():
+            m_trap = Trap { "Unreachable" };
+            return;
+        case Instructions::select.value():
+            frame_slots[instruction.destination] = static_cast<u32>(frame_slots[instruction.immediate]) != 0 ? frame_slots[instruction.lhs] : frame_slots[instruction.rhs];
+            break;
+        case Instructions::global_get.value():
+            frame_slots[instruction.destination] = value_to_slot(store.get(GlobalAddress { instruction.immediate })->value());
+            break;
+        case Instructions::global_set.value(): {
+            auto* global = store.get(GlobalAddress { instruction.immediate });
+            global->set_value(slot_to_value(global->value().type(), frame_slots[instruction.lhs]));
+            break;
+        }
+        case Instructions::memory_size.value():
+            frame_slots[instruction.destination] = to_slot(static_cast<u32>(memory_size / Constants::page_size));
+            break;
+        case Instructions::memory_grow.value(): {
+            auto pages = from_slot<u32>(frame_slots[instruction.lhs]);
+            auto old_pages = static_cast<u32>(memory_size / Constants::page_size);
+            auto result = NumericLimits<u32>::max();
+            if (pages <= 65536 && memory->grow(static_cast<size_t>(pages) * Constants::page_size))
+                result = old_pages;
+            refresh_memory();
+            frame_slots[instruction.destination] = to_slot(result);
+            break;
+        }
+        case Instructions::ref_is_null.value():
+            frame_slots[instruction.destination] = frame_slots[instruction.lhs] == null_reference_slot_value;
+            break;
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    }
+}
+
 void DebuggerBytecodeInterpreter::interpret(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
 {
     if (pre_interpret_hook) {
@@ -34,6 +34,9 @@ struct BytecodeInterpreter : public Interpreter {
 
 protected:
     virtual void interpret(Configuration&, InstructionPointer&, Instruction const&);
+    // Whether functions may run as CompiledFunctions, which skips the per-instruction interpret() above.
+    virtual bool should_use_compiled_code() const { return true; }
+    void interpret_compiled(Configuration&, CompiledFunction const&);
     void branch_to_label(Configuration&, LabelIndex);
     template<typename ReadT, typename PushT>
     void load_and_push(Configuration&, Instruction const&);
@@ -69,6 +72,7 @@ struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
 
 private:
     virtual void interpret(Configuration&, InstructionPointer&, Instruction const&) override;
+    virtual bool should_use_compiled_code() const override { return false; }
 };
 
 }
@@ -0,0 +1,749 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/CompiledFunction.h>
+#include <LibWasm/Printer/Printer.h>
+
+namespace Wasm {
+
+// Null references have the same representation as their non-null counterparts.
+static ValueType::Kind normalized_kind(ValueType const& type)
+{
+    switch (type.kind()) {
+    case ValueType::NullFunctionReference:
+        return ValueType::FunctionReference;
+    case ValueType::NullExternReference:
+        return ValueType::ExternReference;
+    default:
+        return type.kind();
+    }
+}
+
+static bool types_match(Vector<ValueType> const& lhs, Vector<ValueType> const& rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (normalized_kind(lhs[i]) != normalized_kind(rhs[i]))
+            return false;
+    }
+    return true;
+}
+
+class FunctionCompiler {
+public:
+    FunctionCompiler(WasmFunction const& function, Store& store, CompiledFunction& output)
+        : m_function(function)
+        , m_store(store)
+        , m_output(output)
+    {
+    }
+
+    bool compile();
+
+private:
+    // An operand either lives in its home slot (the first slot above the locals, plus its depth on the stack),
+    // or it is the unmodified value of a local, in which case the local's slot is used directly.
+    struct Operand {
+        ValueType::Kind type;
+        u32 slot;
+    };
+
+    enum class FrameKind {
+        Function,
+        Block,
+        Loop,
+        If,
+    };
+
+    struct ControlFrame {
+        FrameKind kind { FrameKind::Block };
+        Vector<ValueType> parameters;
+        Vector<ValueType> results;
+        size_t height { 0 };
+        size_t loop_start { 0 };
+        Optional<size_t> else_jump;
+        Vector<size_t> pending_jumps;
+        Vector<size_t> pending_branches;
+        bool unreachable { false };
+        bool has_else { false };
+
+        auto& label_types() const { return kind == FrameKind::Loop ? parameters : results; }
+    };
+
+    bool compile_instruction(Instruction const&);
+    bool compile_block_start(Instruction const&, FrameKind);
+    bool compile_else();
+    bool compile_end();
+    bool compile_function_end();
+    bool compile_branch(LabelIndex, Optional<u32> condition_slot);
+    bool compile_branch_table(Instruction::TableBranchArgs const&);
+    bool compile_call(FunctionType const&, OpCode, u32 index_slot, u32 table_index, u64 immediate);
+    bool compile_local_set(LocalIndex, bool keep_value);
+
+    bool block_type(BlockType const&, Vector<ValueType>& parameters, Vector<ValueType>& results) const;
+
+    u32 home_slot(size_t depth) const { return m_local_count + depth; }
+    Optional<Operand> pop(ValueType::Kind);
+    Optional<Operand> pop_any();
+    bool top_matches(Vector<ValueType> const&) const;
+    u32 push(ValueType::Kind type)
+    {
+        auto slot = home_slot(m_stack.size());
+        m_stack.append({ type, slot });
+        m_max_height = max(m_max_height, m_stack.size());
+        return slot;
+    }
+    void push_types(Vector<ValueType> const& types)
+    {
+        for (auto& type : types)
+            push(normalized_kind(type));
+    }
+    void materialize(size_t index);
+    void materialize_top(size_t count);
+    void materialize_all() { materialize_top(m_stack.size()); }
+    void mark_unreachable();
+
+    size_t emit(CompiledInstruction instruction)
+    {
+        m_last_producer.clear();
+        m_output.m_instructions.append(instruction);
+        return m_output.m_instructions.size() - 1;
+    }
+    // Emits an instruction that only writes its result to `destination`, which allows a following local.set to retarget it.
+    void emit_producer(CompiledInstruction instruction)
+    {
+        m_last_producer = emit(instruction);
+    }
+    size_t current_position() const { return m_output.m_instructions.size(); }
+    void place_label() { m_last_producer.clear(); }
+    void patch_frame_end(ControlFrame&, size_t target);
+
+    WasmFunction const& m_function;
+    Store& m_store;
+    CompiledFunction& m_output;
+    ModuleInstance const& module() const { return m_function.module(); }
+
+    u32 m_local_count { 0 };
+    Vector<Operand> m_stack;
+    size_t m_max_height { 0 };
+    Vector<ControlFrame> m_frames;
+    size_t m_skipped_depth { 0 };
+    Optional<size_t> m_last_producer;
+};
+
+Optional<FunctionCompiler::Operand> FunctionCompiler::pop_any()
+{
+    if (m_stack.size() <= m_frames.last().height)
+        return {};
+    return m_stack.take_last();
+}
+
+Optional<FunctionCompiler::Operand> FunctionCompiler::pop(ValueType::Kind type)
+{
+    auto operand = pop_any();
+    if (!operand.has_value() || operand->type != type)
+        return {};
+    return operand;
+}
+
+bool FunctionCompiler::top_matches(Vector<ValueType> const& types) const
+{
+    if (m_stack.size() < m_frames.last().height + types.size())
+        return false;
+    auto first = m_stack.size() - types.size();
+    for (size_t i = 0; i < types.size(); ++i) {
+        if (m_stack[first + i].type != normalized_kind(types[i]))
+            return false;
+    }
+    return true;
+}
+
+void FunctionCompiler::materialize(size_t index)
+{
+    auto& operand = m_stack[index];
+    auto slot = home_slot(index);
+    if (operand.slot == slot)
+        return;
+    emit({ CompiledInstructions::copy, slot, operand.slot });
+    operand.slot = slot;
+}
+
+void FunctionCompiler::materialize_top(size_t count)
+{
+    for (size_t i = m_stack.size() - count; i < m_stack.size(); ++i)
+        materialize(i);
+}
+
+void FunctionCompiler::mark_unreachable()
+{
+    auto& frame = m_frames.last();
+    m_stack.shrink(frame.height);
+    frame.unreachable = true;
+}
+
+void FunctionCompiler::patch_frame_end(ControlFrame& frame, size_t target)
+{
+    for (auto index : frame.pending_jumps)
+        m_output.m_instructions[index].immediate = target;
+    for (auto index : frame.pending_branches)
+        m_output.m_branches[index].target = target;
+}
+
+bool FunctionCompiler::block_type(BlockType const& type, Vector<ValueType>& parameters, Vector<ValueType>& results) const
+{
+    switch (type.kind()) {
+    case BlockType::Empty:
+        return true;
+    case BlockType::Type:
+        results.append(type.value_type());
+        return true;
+    case BlockType::Index: {
+        auto index = type.type_index().value();
+        if (index >= module().types().size())
+            return false;
+        auto& function_type = module().types()[index];
+        parameters.extend(function_type.parameters());
+        results.extend(function_type.results());
+        return true;
+    }
+    }
+    VERIFY_NOT_REACHED();
+}
+
+bool FunctionCompiler::compile()
+{
+    auto& type = m_function.type();
+    auto& locals = m_function.code().locals();
+
+    m_output.m_parameter_count = type.parameters().size();
+    m_output.m_local_types.extend(type.parameters());
+    m_output.m_local_types.extend(locals);
+    m_output.m_result_types.extend(type.results());
+    m_local_count = m_output.m_local_types.size();
+
+    ControlFrame function_frame;
+    function_frame.kind = FrameKind::Function;
+    function_frame.results = type.results();
+    m_frames.append(move(function_frame));
+
+    for (auto& instruction : m_function.code().body().instructions()) {
+        if (!compile_instruction(instruction)) {
+            dbgln_if(WASM_TRACE_DEBUG, "Can't compile function, {} is unsupported or invalid", instruction_name(instruction.opcode()));
+            return false;
+        }
+    }
+
+    if (!compile_function_end())
+        return false;
+
+    m_output.m_frame_size = m_local_count + m_max_height;
+    return true;
+}
+
+bool FunctionCompiler::compile_function_end()
+{
+    if (m_frames.size() != 1)
+        return false;
+
+    auto& frame = m_frames.last();
+    auto result_count = frame.results.size();
+    if (!frame.unreachable) {
+        if (m_stack.size() != result_count)
+            return false;
+        materialize_all();
+    }
+
+    // Branches to the function's label leave their results in the same place as the fallthrough.
+    place_label();
+    patch_frame_end(frame, current_position());
+    emit({ Instructions::return_, 0, home_slot(0), static_cast<u32>(result_count) });
+    return true;
+}
+
+bool FunctionCompiler::compile_block_start(Instruction const& instruction, FrameKind kind)
+{
+    auto& arguments = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
+    ControlFrame frame;
+    frame.kind = kind;
+    if (!block_type(arguments.block_type, frame.parameters, frame.results))
+        return false;
+
+    Optional<Operand> condition;
+    if (kind == FrameKind::If) {
+        condition = pop(ValueType::I32);
+        if (!condition.has_value())
+            return false;
+    }
+
+    if (!top_matches(frame.parameters))
+        return false;
+
+    // Everything on the stack has to be in its home slot when entering a block, as the block could be left
+    // through a path that didn't see a local.set which made us move an operand that aliases a local.
+    materialize_all();
+    frame.height = m_stack.size() - frame.parameters.size();
+
+    if (kind == FrameKind::Loop) {
+        place_label();
+        frame.loop_start = current_position();
+    } else if (kind == FrameKind::If) {
+        frame.else_jump = emit({ CompiledInstructions::jump_unless, 0, condition->slot });
+    }
+
+    m_frames.append(move(frame));
+    return true;
+}
+
+bool FunctionCompiler::compile_else()
+{
+    auto& frame = m_frames.last();
+    if (frame.kind != FrameKind::If || frame.has_else)
+        return false;
+
+    if (!frame.unreachable) {
+        if (m_stack.size() != frame.height + frame.results.size() || !top_matches(frame.results))
+            return false;
+        materialize_all();
+        frame.pending_jumps.append(emit({ CompiledInstructions::jump }));
+    }
+
+    place_label();
+    m_output.m_instructions[frame.else_jump.value()].immediate = current_position();
+    frame.else_jump.clear();
+    frame.has_else = true;
+    frame.unreachable = false;
+    m_stack.shrink(frame.height);
+    push_types(frame.parameters);
+    return true;
+}
+
+bool FunctionCompiler::compile_end()
+{
+    if (m_frames.size() <= 1)
+        return false;
+
+    auto& frame = m_frames.last();
+    auto reachable = !frame.unreachable;
+    if (reachable) {
+        if (m_stack.size() != frame.height + frame.results.size() || !top_matches(frame.results))
+            return false;
+        materialize_all();
+    }
+
+    if (frame.kind == FrameKind::If && !frame.has_else) {
+        // The implicit else passes the parameters through as the results.
+        if (!types_match(frame.parameters, frame.results))
+            return false;
+        frame.pending_jumps.append(frame.else_jump.value());
+        frame.else_jump.clear();
+    }
+
+    if (frame.kind != FrameKind::Loop) {
+        reachable |= !frame.pending_jumps.is_empty() || !frame.pending_branches.is_empty();
+        place_label();
+        patch_frame_end(frame, current_position());
+    }
+
+    auto ended_frame = m_frames.take_last();
+    m_stack.shrink(ended_frame.height);
+    push_types(ended_frame.results);
+    if (!reachable)
+        mark_unreachable();
+    return true;
+}
+
+bool FunctionCompiler::compile_branch(LabelIndex label, Optional<u32> condition_slot)
+{
+    if (label.value() >= m_frames.size())
+        return false;
+    auto& target_frame = m_frames[m_frames.size() - label.value() - 1];
+    auto& types = target_frame.label_types();
+    auto count = types.size();
+    if (!top_matches(types))
+        return false;
+    materialize_top(count);
+
+    auto source = home_slot(m_stack.size() - count);
+    auto destination = home_slot(target_frame.height);
+    if (count == 0 || source == destination) {
+        // Nothing to move, so this can be a plain jump.
+        auto opcode = condition_slot.has_value() ? CompiledInstructions::jump_if : CompiledInstructions::jump;
+        auto index = emit({ opcode, 0, condition_slot.value_or(0), 0, target_frame.loop_start });
+        if (target_frame.kind != FrameKind::Loop)
+            target_frame.pending_jumps.append(index);
+    } else {
+        m_output.m_branches.append({ static_cast<u32>(target_frame.loop_start), source, destination, static_cast<u32>(count) });
+        auto branch_index = m_output.m_branches.size() - 1;
+        if (target_frame.kind != FrameKind::Loop)
+            target_frame.pending_branches.append(branch_index);
+        auto opcode = condition_slot.has_value() ? Instructions::br_if : Instructions::br;
+        emit({ opcode, 0, condition_slot.value_or(0), 0, branch_index });
+    }
+
+    if (!condition_slot.has_value())
+        mark_unreachable();
+    return true;
+}
+
+bool FunctionCompiler::compile_branch_table(Instruction::TableBranchArgs const& arguments)
+{
+    auto index = pop(ValueType::I32);
+    if (!index.has_value() || arguments.default_.value() >= m_frames.size())
+        return false;
+
+    auto& default_types = m_frames[m_frames.size() - arguments.default_.value() - 1].label_types();
+    auto count = default_types.size();
+    if (!top_matches(default_types))
+        return false;
+    materialize_top(count);
+
+    auto source = home_slot(m_stack.size() - count);
+    auto first_branch = m_output.m_branches.size();
+    auto add_branch = [&](LabelIndex label) {
+        if (label.value() >= m_frames.size())
+            return false;
+        auto& target_frame = m_frames[m_frames.size() - label.value() - 1];
+        if (!types_match(target_frame.label_types(), default_types))
+            return false;
+        auto destination = home_slot(target_frame.height);
+        m_output.m_branches.append({ static_cast<u32>(target_frame.loop_start), source, destination, source == destination ? 0 : static_cast<u32>(count) });
+        if (target_frame.kind != FrameKind::Loop)
+            target_frame.pending_branches.append(m_output.m_branches.size() - 1);
+        return true;
+    };
+
+    for (auto& label : arguments.labels) {
+        if (!add_branch(label))
+            return false;
+    }
+    if (!add_branch(arguments.default_))
+        return false;
+
+    emit({ Instructions::br_table, 0, index->slot, static_cast<u32>(arguments.labels.size()), first_branch });
+    mark_unreachable();
+    return true;
+}
+
+bool FunctionCompiler::compile_call(FunctionType const& type, OpCode opcode, u32 index_slot, u32 table_index, u64 immediate)
+{
+    auto parameter_count = type.parameters().size();
+    if (!top_matches(type.parameters()))
+        return false;
+
+    // The callee's frame starts at the first argument, and leaves its results there.
+    materialize_top(parameter_count);
+    auto base = home_slot(m_stack.size() - parameter_count);
+    m_stack.shrink(m_stack.size() - parameter_count);
+    emit({ opcode, base, index_slot, table_index, immediate });
+    push_types(type.results());
+    return true;
+}
+
+bool FunctionCompiler::compile_local_set(LocalIndex index, bool keep_value)
+{
+    if (index.value() >= m_local_count)
+        return false;
+    auto local = static_cast<u32>(index.value());
+    auto value = pop(normalized_kind(m_output.m_local_types[local]));
+    if (!value.has_value())
+        return false;
+
+    auto is_aliased = false;
+    for (auto& operand : m_stack)
+        is_aliased |= operand.slot == local;
+
+    if (m_last_producer.has_value() && !is_aliased && value->slot == home_slot(m_stack.size())) {
+        // Have the instruction that produced the value write it to the local directly.
+        auto& producer = m_output.m_instructions[*m_last_producer];
+        if (producer.destination == value->slot) {
+            producer.destination = local;
+            m_last_producer.clear();
+            if (keep_value)
+                m_stack.append({ value->type, local });
+            return true;
+        }
+    }
+
+    // Anything that still refers to the old value of the local needs its own copy now.
+    for (size_t i = 0; i < m_stack.size(); ++i) {
+        if (m_stack[i].slot == local)
+            materialize(i);
+    }
+    if (value->slot != local)
+        emit({ CompiledInstructions::copy, local, value->slot });
+    if (keep_value)
+        m_stack.append({ value->type, local });
+    return true;
+}
+
+bool FunctionCompiler::compile_instruction(Instruction const& instruction)
+{
+    auto opcode = instruction.opcode();
+
+    if (m_frames.last().unreachable) {
+        // Skip over dead code up to the end of the current frame, or the start of the else arm of an if.
+        if (opcode == Instructions::block || opcode == Instructions::loop || opcode == Instructions::if_) {
+            ++m_skipped_depth;
+            return true;
+        }
+        if (opcode == Instructions::structured_end) {
+            if (m_skipped_depth > 0) {
+                --m_skipped_depth;
+                return true;
+            }
+            return compile_end();
+        }
+        if (opcode == Instructions::structured_else && m_skipped_depth == 0)
+            return compile_else();
+        return true;
+    }
+
+    switch (opcode.value()) {
+#define M(name, operand_kind, result_kind, ...)                                        \
+    case Instructions::name.value(): {                                                 \
+        auto value = pop(ValueType::operand_kind);                                     \
+        if (!value.has_value())                                                        \
+            return false;                                                              \
+        emit_producer({ opcode, push(ValueType::result_kind), value->slot });          \
+        return true;                                                                   \
+    }
+        ENUMERATE_WASM_UNARY_OPERATIONS(M)
+#undef M
+#define M(name, operand_kind, result_kind, ...)                                        \
+    case Instructions::name.value(): {                                                 \
+        auto rhs = pop(ValueType::operand_kind);                                       \
+        auto lhs = pop(ValueType::operand_kind);                                       \
+        if (!lhs.has_value() || !rhs.has_value())                                      \
+            return false;                                                              \
+        emit_producer({ opcode, push(ValueType::result_kind), lhs->slot, rhs->slot }); \
+        return true;                                                                   \
+    }
+        ENUMERATE_WASM_BINARY_OPERATIONS(M)
+#undef M
+#define M(name, kind, ...)                                                             \
+    case Instructions::name.value(): {                                                 \
+        auto& argument = instruction.arguments().get<Instruction::MemoryArgument>();   \
+        auto address = pop(ValueType::I32);                                            \
+        if (!address.has_value() || module().memories().is_empty())                    \
+            return false;                                                              \
+        emit_producer({ opcode, push(ValueType::kind), address->slot, 0, argument.offset }); \
+        return true;                                                                   \
+    }
+        ENUMERATE_WASM_LOAD_OPERATIONS(M)
+#undef M
+#define M(name, kind, ...)                                                             \
+    case Instructions::name.value(): {                                                 \
+        auto& argument = instruction.arguments().get<Instruction::MemoryArgument>();   \
+        auto value = pop(ValueType::kind);                                             \
+        auto address = pop(ValueType::I32);                                            \
+        if (!value.has_value() || !address.has_value() || module().memories().is_empty()) \
+            return false;                                                              \
+        emit({ opcode, 0, address->slot, value->slot, argument.offset });              \
+        return true;                                                                   \
+    }
+        ENUMERATE_WASM_STORE_OPERATIONS(M)
+#undef M
+
+    case Instructions::i32_divs.value():
+    case Instructions::i32_divu.value():
+    case Instructions::i32_rems.value():
+    case Instructions::i32_remu.value():
+    case Instructions::i64_divs.value():
+    case Instructions::i64_divu.value():
+    case Instructions::i64_rems.value():
+    case Instructions::i64_remu.value(): {
+        auto kind = opcode.value() <= Instructions::i32_remu.value() ? ValueType::I32 : ValueType::I64;
+        auto rhs = pop(kind);
+        auto lhs = pop(kind);
+        if (!lhs.has_value() || !rhs.has_value())
+            return false;
+        emit_producer({ opcode, push(kind), lhs->slot, rhs->slot });
+        return true;
+    }
+    case Instructions::i32_trunc_sf32.value():
+    case Instructions::i32_trunc_uf32.value():
+    case Instructions::i32_trunc_sf64.value():
+    case Instructions::i32_trunc_uf64.value():
+    case Instructions::i64_trunc_sf32.value():
+    case Instructions::i64_trunc_uf32.value():
+    case Instructions::i64_trunc_sf64.value():
+    case Instructions::i64_trunc_uf64.value(): {
+        auto is_double = opcode == Instructions::i32_trunc_sf64 || opcode == Instructions::i32_trunc_uf64
+            || opcode == Instructions::i64_trunc_sf64 || opcode == Instructions::i64_trunc_uf64;
+        auto value = pop(is_double ? ValueType::F64 : ValueType::F32);
+        if (!value.has_value())
+            return false;
+        auto result_kind = opcode.value() <= Instructions::i32_trunc_uf64.value() ? ValueType::I32 : ValueType::I64;
+        emit_producer({ opcode, push(result_kind), value->slot });
+        return true;
+    }
+
+    case Instructions::unreachable.value():
+        emit({ opcode });
+        mark_unreachable();
+        return true;
+    case Instructions::nop.value():
+        return true;
+    case Instructions::block.value():
+        return compile_block_start(instruction, FrameKind::Block);
+    case Instructions::loop.value():
+        return compile_block_start(instruction, FrameKind::Loop);
+    case Instructions::if_.value():
+        return compile_block_start(instruction, FrameKind::If);
+    case Instructions::structured_else.value():
+        return compile_else();
+    case Instructions::structured_end.value():
+        return compile_end();
+    case Instructions::br.value():
+        return compile_branch(instruction.arguments().get<LabelIndex>(), {});
+    case Instructions::br_if.value(): {
+        auto condition = pop(ValueType::I32);
+        if (!condition.has_value())
+            return false;
+        return compile_branch(instruction.arguments().get<LabelIndex>(), condition->slot);
+    }
+    case Instructions::br_table.value():
+        return compile_branch_table(instruction.arguments().get<Instruction::TableBranchArgs>());
+    case Instructions::return_.value(): {
+        auto count = m_output.m_result_types.size();
+        if (!top_matches(m_output.m_result_types))
+            return false;
+        materialize_top(count);
+        emit({ opcode, 0, home_slot(m_stack.size() - count), static_cast<u32>(count) });
+        mark_unreachable();
+        return true;
+    }
+    case Instructions::call.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= module().functions().size())
+            return false;
+        auto address = module().functions()[index];
+        auto* callee = m_store.get(address);
+        if (!callee)
+            return false;
+        FunctionType const* type { nullptr };
+        callee->visit([&](auto const& function) { type = &function.type(); });
+        return compile_call(*type, opcode, 0, 0, address.value());
+    }
+    case Instructions::call_indirect.value(): {
+        auto& arguments = instruction.arguments().get<Instruction::IndirectCallArgs>();
+        if (arguments.type.value() >= module().types().size() || arguments.table.value() >= module().tables().size())
+            return false;
+        auto index = pop(ValueType::I32);
+        if (!index.has_value())
+            return false;
+        return compile_call(module().types()[arguments.type.value()], opcode, index->slot, arguments.table.value(), arguments.type.value());
+    }
+    case Instructions::drop.value():
+        return pop_any().has_value();
+    case Instructions::select.value():
+    case Instructions::select_typed.value(): {
+        auto condition = pop(ValueType::I32);
+        auto rhs = pop_any();
+        if (!condition.has_value() || !rhs.has_value())
+            return false;
+        auto lhs = pop(rhs->type);
+        if (!lhs.has_value())
+            return false;
+        emit_producer({ Instructions::select, push(lhs->type), lhs->slot, rhs->slot, condition->slot });
+        return true;
+    }
+    case Instructions::local_get.value(): {
+        auto index = instruction.arguments().get<LocalIndex>().value();
+        if (index >= m_local_count)
+            return false;
+        m_stack.append({ normalized_kind(m_output.m_local_types[index]), static_cast<u32>(index) });
+        m_max_height = max(m_max_height, m_stack.size());
+        return true;
+    }
+    case Instructions::local_set.value():
+        return compile_local_set(instruction.arguments().get<LocalIndex>(), false);
+    case Instructions::local_tee.value():
+        return compile_local_set(instruction.arguments().get<LocalIndex>(), true);
+    case Instructions::global_get.value():
+    case Instructions::global_set.value(): {
+        auto index = instruction.arguments().get<GlobalIndex>().value();
+        if (index >= module().globals().size())
+            return false;
+        auto address = module().globals()[index];
+        auto* global = m_store.get(address);
+        if (!global)
+            return false;
+        auto kind = normalized_kind(global->value().type());
+        if (opcode == Instructions::global_get) {
+            emit_producer({ opcode, push(kind), 0, 0, address.value() });
+            return true;
+        }
+        auto value = pop(kind);
+        if (!value.has_value() || !global->is_mutable())
+            return false;
+        emit({ opcode, 0, value->slot, 0, address.value() });
+        return true;
+    }
+    case Instructions::i32_const.value():
+        emit_producer({ CompiledInstructions::constant, push(ValueType::I32), 0, 0, static_cast<u32>(instruction.arguments().get<i32>()) });
+        return true;
+    case Instructions::i64_const.value():
+        emit_producer({ CompiledInstructions::constant, push(ValueType::I64), 0, 0, static_cast<u64>(instruction.arguments().get<i64>()) });
+        return true;
+    case Instructions::f32_const.value():
+        emit_producer({ CompiledInstructions::constant, push(ValueType::F32), 0, 0, bit_cast<u32>(instruction.arguments().get<float>()) });
+        return true;
+    case Instructions::f64_const.value():
+        emit_producer({ CompiledInstructions::constant, push(ValueType::F64), 0, 0, bit_cast<u64>(instruction.arguments().get<double>()) });
+        return true;
+    case Instructions::memory_size.value():
+        if (module().memories().is_empty())
+            return false;
+        emit_producer({ opcode, push(ValueType::I32) });
+        return true;
+    case Instructions::memory_grow.value(): {
+        auto pages = pop(ValueType::I32);
+        if (!pages.has_value() || module().memories().is_empty())
+            return false;
+        emit_producer({ opcode, push(ValueType::I32), pages->slot });
+        return true;
+    }
+    case Instructions::ref_null.value(): {
+        auto& type = instruction.arguments().get<ValueType>();
+        if (!type.is_reference())
+            return false;
+        emit_producer({ CompiledInstructions::constant, push(normalized_kind(type)), 0, 0, null_reference_slot_value });
+        return true;
+    }
+    case Instructions::ref_func.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= module().functions().size())
+            return false;
+        emit_producer({ CompiledInstructions::constant, push(ValueType::FunctionReference), 0, 0, module().functions()[index].value() });
+        return true;
+    }
+    case Instructions::ref_is_null.value(): {
+        auto value = pop_any();
+        if (!value.has_value() || (value->type != ValueType::FunctionReference && value->type != ValueType::ExternReference))
+            return false;
+        emit_producer({ opcode, push(ValueType::I32), value->slot });
+        return true;
+    }
+    default:
+        // Table and bulk memory instructions are left to the interpreter.
+        return false;
+    }
+}
+
+OwnPtr<CompiledFunction> CompiledFunction::compile(WasmFunction const& function, Store& store)
+{
+    auto compiled_function = adopt_own(*new CompiledFunction);
+    FunctionCompiler compiler { function, store, *compiled_function };
+    if (!compiler.compile())
+        return {};
+    return compiled_function;
+}
+
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibWasm/Opcode.h>
+#include <LibWasm/Types.h>
+
+namespace Wasm {
+
+class Store;
+class WasmFunction;
+
+// Opcodes that only appear in compiled code, see CompiledInstruction for what they do.
+namespace CompiledInstructions {
+
+static constexpr OpCode copy = 0xfe00,
+                        constant = 0xfe01,
+                        jump = 0xfe02,
+                        jump_if = 0xfe03,
+                        jump_unless = 0xfe04;
+
+}
+
+// Values are kept in untyped 64-bit slots while running compiled code, the compiler knows their types.
+// References are stored as their address, or as this value if they're null.
+static constexpr u64 null_reference_slot_value = NumericLimits<u64>::max();
+
+// A single instruction of a compiled function, operating on the slots of the current frame.
+// Locals occupy the first slots of a frame, followed by the operand stack. As the height of the operand stack is known
+// at every point of a valid function, every operand and result has a fixed slot, so no stack bookkeeping happens at runtime.
+//
+// - Numeric operations read `lhs` (and `rhs`) and write `destination`.
+// - copy/constant write `lhs`/`immediate` into `destination`.
+// - jump/jump_if/jump_unless continue at instruction `immediate` (if the i32 in `lhs` is nonzero/zero).
+// - br/br_if (if `lhs` is nonzero) take the branch at index `immediate` of the branch table, br_table picks one of the
+//   `rhs` + 1 branches starting at `immediate` using the index in `lhs`.
+// - return copies `rhs` results starting at `lhs` to the start of the frame, where the caller expects them.
+// - call/call_indirect take their arguments from (and put their results into) the slots starting at `destination`,
+//   call_indirect looks up the function in table `rhs` using the index in `lhs`, and expects type `immediate`.
+// - Loads read the address from `lhs`, stores also read the value to store from `rhs`, the offset is in `immediate`.
+// - select picks `lhs` or `rhs` depending on the i32 in slot `immediate`.
+// - global.get/global.set use the global at address `immediate`.
+struct CompiledInstruction {
+    OpCode opcode;
+    u32 destination { 0 };
+    u32 lhs { 0 };
+    u32 rhs { 0 };
+    u64 immediate { 0 };
+};
+
+// Copies `count` slots from `source` to `destination` and continues at `target`.
+struct CompiledBranch {
+    u32 target { 0 };
+    u32 source { 0 };
+    u32 destination { 0 };
+    u32 count { 0 };
+};
+
+class CompiledFunction {
+public:
+    // Returns null if the function uses an instruction that can't be compiled (yet), or isn't valid.
+    static OwnPtr<CompiledFunction> compile(WasmFunction const&, Store&);
+
+    auto& instructions() const { return m_instructions; }
+    auto& branches() const { return m_branches; }
+    auto& local_types() const { return m_local_types; }
+    auto& result_types() const { return m_result_types; }
+    auto parameter_count() const { return m_parameter_count; }
+    // The number of slots a frame of this function needs, including its locals.
+    auto frame_size() const { return m_frame_size; }
+
+private:
+    friend class FunctionCompiler;
+
+    CompiledFunction() = default;
+
+    Vector<CompiledInstruction> m_instructions;
+    Vector<CompiledBranch> m_branches;
+    Vector<ValueType> m_local_types;
+    Vector<ValueType> m_result_types;
+    size_t m_parameter_count { 0 };
+    size_t m_frame_size { 0 };
+};
+
+// Instructions that can't trap and simply map their operands to a result.
+// O(name, operand kind, result kind, operand type, result type, expression)
+#define ENUMERATE_WASM_UNARY_OPERATIONS(O)                                                     \
+    O(i32_eqz, I32, I32, u32, u32, value == 0)                                                 \
+    O(i32_clz, I32, I32, u32, u32, clz(value))                                                 \
+    O(i32_ctz, I32, I32, u32, u32, ctz(value))                                                 \
+    O(i32_popcnt, I32, I32, u32, u32, __builtin_popcount(value))                               \
+    O(i64_eqz, I64, I32, u64, u32, value == 0)                                                 \
+    O(i64_clz, I64, I64, u64, u64, clz(value))                                                 \
+    O(i64_ctz, I64, I64, u64, u64, ctz(value))                                                 \
+    O(i64_popcnt, I64, I64, u64, u64, __builtin_popcountll(value))                             \
+    O(f32_abs, F32, F32, float, float, fabsf(value))                                           \
+    O(f32_neg, F32, F32, float, float, -value)                                                 \
+    O(f32_ceil, F32, F32, float, float, ceilf(value))                                          \
+    O(f32_floor, F32, F32, float, float, floorf(value))                                        \
+    O(f32_trunc, F32, F32, float, float, truncf(value))                                        \
+    O(f32_nearest, F32, F32, float, float, nearbyintf(value))                                  \
+    O(f32_sqrt, F32, F32, float, float, sqrtf(value))                                          \
+    O(f64_abs, F64, F64, double, double, fabs(value))                                          \
+    O(f64_neg, F64, F64, double, double, -value)                                               \
+    O(f64_ceil, F64, F64, double, double, ceil(value))                                         \
+    O(f64_floor, F64, F64, double, double, floor(value))                                       \
+    O(f64_trunc, F64, F64, double, double, trunc(value))                                       \
+    O(f64_nearest, F64, F64, double, double, nearbyint(value))                                 \
+    O(f64_sqrt, F64, F64, double, double, sqrt(value))                                         \
+    O(i32_wrap_i64, I64, I32, u64, u32, static_cast<u32>(value))                               \
+    O(i64_extend_si32, I32, I64, i32, i64, value)                                              \
+    O(i64_extend_ui32, I32, I64, u32, u64, value)                                              \
+    O(f32_convert_si32, I32, F32, i32, float, static_cast<float>(value))                       \
+    O(f32_convert_ui32, I32, F32, u32, float, static_cast<float>(value))                       \
+    O(f32_convert_si64, I64, F32, i64, float, static_cast<float>(value))                       \
+    O(f32_convert_ui64, I64, F32, u64, float, static_cast<float>(value))                       \
+    O(f32_demote_f64, F64, F32, double, float, static_cast<float>(value))                      \
+    O(f64_convert_si32, I32, F64, i32, double, static_cast<double>(value))                     \
+    O(f64_convert_ui32, I32, F64, u32, double, static_cast<double>(value))                     \
+    O(f64_convert_si64, I64, F64, i64, double, static_cast<double>(value))                     \
+    O(f64_convert_ui64, I64, F64, u64, double, static_cast<double>(value))                     \
+    O(f64_promote_f32, F32, F64, float, double, static_cast<double>(value))                    \
+    O(i32_reinterpret_f32, F32, I32, float, u32, bit_cast<u32>(value))                         \
+    O(i64_reinterpret_f64, F64, I64, double, u64, bit_cast<u64>(value))                        \
+    O(f32_reinterpret_i32, I32, F32, u32, float, bit_cast<float>(value))                       \
+    O(f64_reinterpret_i64, I64, F64, u64, double, bit_cast<double>(value))                     \
+    O(i32_extend8_s, I32, I32, u32, i32, static_cast<i8>(value))                               \
+    O(i32_extend16_s, I32, I32, u32, i32, static_cast<i16>(value))                             \
+    O(i64_extend8_s, I64, I64, u64, i64, static_cast<i8>(value))                               \
+    O(i64_extend16_s, I64, I64, u64, i64, static_cast<i16>(value))                             \
+    O(i64_extend32_s, I64, I64, u64, i64, static_cast<i32>(value))                             \
+    O(i32_trunc_sat_f32_s, F32, I32, float, i32, saturating_truncate<i32>(value))              \
+    O(i32_trunc_sat_f32_u, F32, I32, float, u32, saturating_truncate<u32>(value))              \
+    O(i32_trunc_sat_f64_s, F64, I32, double, i32, saturating_truncate<i32>(value))             \
+    O(i32_trunc_sat_f64_u, F64, I32, double, u32, saturating_truncate<u32>(value))             \
+    O(i64_trunc_sat_f32_s, F32, I64, float, i64, saturating_truncate<i64>(value))              \
+    O(i64_trunc_sat_f32_u, F32, I64, float, u64, saturating_truncate<u64>(value))              \
+    O(i64_trunc_sat_f64_s, F64, I64, double, i64, saturating_truncate<i64>(value))             \
+    O(i64_trunc_sat_f64_u, F64, I64, double, u64, saturating_truncate<u64>(value))
+
+// O(name, operand kind, result kind, operand type, result type, expression)
+#define ENUMERATE_WASM_BINARY_OPERATIONS(O)                       \
+    O(i32_eq, I32, I32, u32, u32, lhs == rhs)                     \
+    O(i32_ne, I32, I32, u32, u32, lhs != rhs)                     \
+    O(i32_lts, I32, I32, i32, u32, lhs < rhs)                     \
+    O(i32_ltu, I32, I32, u32, u32, lhs < rhs)                     \
+    O(i32_gts, I32, I32, i32, u32, lhs > rhs)                     \
+    O(i32_gtu, I32, I32, u32, u32, lhs > rhs)                     \
+    O(i32_les, I32, I32, i32, u32, lhs <= rhs)                    \
+    O(i32_leu, I32, I32, u32, u32, lhs <= rhs)                    \
+    O(i32_ges, I32, I32, i32, u32, lhs >= rhs)                    \
+    O(i32_geu, I32, I32, u32, u32, lhs >= rhs)                    \
+    O(i64_eq, I64, I32, u64, u32, lhs == rhs)                     \
+    O(i64_ne, I64, I32, u64, u32, lhs != rhs)                     \
+    O(i64_lts, I64, I32, i64, u32, lhs < rhs)                     \
+    O(i64_ltu, I64, I32, u64, u32, lhs < rhs)                     \
+    O(i64_gts, I64, I32, i64, u32, lhs > rhs)                     \
+    O(i64_gtu, I64, I32, u64, u32, lhs > rhs)                     \
+    O(i64_les, I64, I32, i64, u32, lhs <= rhs)                    \
+    O(i64_leu, I64, I32, u64, u32, lhs <= rhs)                    \
+    O(i64_ges, I64, I32, i64, u32, lhs >= rhs)                    \
+    O(i64_geu, I64, I32, u64, u32, lhs >= rhs)                    \
+    O(f32_eq, F32, I32, float, u32, lhs == rhs)                   \
+    O(f32_ne, F32, I32, float, u32, lhs != rhs)                   \
+    O(f32_lt, F32, I32, float, u32, lhs < rhs)                    \
+    O(f32_gt, F32, I32, float, u32, lhs > rhs)                    \
+    O(f32_le, F32, I32, float, u32, lhs <= rhs)                   \
+    O(f32_ge, F32, I32, float, u32, lhs >= rhs)                   \
+    O(f64_eq, F64, I32, double, u32, lhs == rhs)                  \
+    O(f64_ne, F64, I32, double, u32, lhs != rhs)                  \
+    O(f64_lt, F64, I32, double, u32, lhs < rhs)                   \
+    O(f64_gt, F64, I32, double, u32, lhs > rhs)                   \
+    O(f64_le, F64, I32, double, u32, lhs <= rhs)                  \
+    O(f64_ge, F64, I32, double, u32, lhs >= rhs)                  \
+    O(i32_add, I32, I32, u32, u32, lhs + rhs)                     \
+    O(i32_sub, I32, I32, u32, u32, lhs - rhs)                     \
+    O(i32_mul, I32, I32, u32, u32, lhs * rhs)                     \
+    O(i32_and, I32, I32, u32, u32, lhs & rhs)                     \
+    O(i32_or, I32, I32, u32, u32, lhs | rhs)                      \
+    O(i32_xor, I32, I32, u32, u32, lhs ^ rhs)                     \
+    O(i32_shl, I32, I32, u32, u32, lhs << (rhs % 32))             \
+    O(i32_shrs, I32, I32, i32, i32, lhs >> (rhs & 31))            \
+    O(i32_shru, I32, I32, u32, u32, lhs >> (rhs % 32))            \
+    O(i32_rotl, I32, I32, u32, u32, rotl(lhs, rhs))               \
+    O(i32_rotr, I32, I32, u32, u32, rotr(lhs, rhs))               \
+    O(i64_add, I64, I64, u64, u64, lhs + rhs)                     \
+    O(i64_sub, I64, I64, u64, u64, lhs - rhs)                     \
+    O(i64_mul, I64, I64, u64, u64, lhs * rhs)                     \
+    O(i64_and, I64, I64, u64, u64, lhs & rhs)                     \
+    O(i64_or, I64, I64, u64, u64, lhs | rhs)                      \
+    O(i64_xor, I64, I64, u64, u64, lhs ^ rhs)                     \
+    O(i64_shl, I64, I64, u64, u64, lhs << (rhs % 64))             \
+    O(i64_shrs, I64, I64, i64, i64, lhs >> (rhs & 63))            \
+    O(i64_shru, I64, I64, u64, u64, lhs >> (rhs % 64))            \
+    O(i64_rotl, I64, I64, u64, u64, rotl(lhs, rhs))               \
+    O(i64_rotr, I64, I64, u64, u64, rotr(lhs, rhs))               \
+    O(f32_add, F32, F32, float, float, lhs + rhs)                 \
+    O(f32_sub, F32, F32, float, float, lhs - rhs)                 \
+    O(f32_mul, F32, F32, float, float, lhs * rhs)                 \
+    O(f32_div, F32, F32, float, float, lhs / rhs)                 \
+    O(f32_min, F32, F32, float, float, float_min(lhs, rhs))       \
+    O(f32_max, F32, F32, float, float, float_max(lhs, rhs))       \
+    O(f32_copysign, F32, F32, float, float, copysignf(lhs, rhs))  \
+    O(f64_add, F64, F64, double, double, lhs + rhs)               \
+    O(f64_sub, F64, F64, double, double, lhs - rhs)               \
+    O(f64_mul, F64, F64, double, double, lhs * rhs)               \
+    O(f64_div, F64, F64, double, double, lhs / rhs)               \
+    O(f64_min, F64, F64, double, double, float_min(lhs, rhs))     \
+    O(f64_max, F64, F64, double, double, float_max(lhs, rhs))     \
+    O(f64_copysign, F64, F64, double, double, copysign(lhs, rhs))
+
+// O(name, value kind, type in memory, type on the stack)
+#define ENUMERATE_WASM_LOAD_OPERATIONS(O)   \
+    O(i32_load, I32, u32, u32)              \
+    O(i64_load, I64, u64, u64)              \
+    O(f32_load, F32, u32, u32)              \
+    O(f64_load, F64, u64, u64)              \
+    O(i32_load8_s, I32, i8, i32)            \
+    O(i32_load8_u, I32, u8, u32)            \
+    O(i32_load16_s, I32, i16, i32)          \
+    O(i32_load16_u, I32, u16, u32)          \
+    O(i64_load8_s, I64, i8, i64)            \
+    O(i64_load8_u, I64, u8, u64)            \
+    O(i64_load16_s, I64, i16, i64)          \
+    O(i64_load16_u, I64, u16, u64)          \
+    O(i64_load32_s, I64, i32, i64)          \
+    O(i64_load32_u, I64, u32, u64)
+
+// O(name, value kind, type in memory)
+#define ENUMERATE_WASM_STORE_OPERATIONS(O) \
+    O(i32_store, I32, u32)                 \
+    O(i64_store, I64, u64)                 \
+    O(f32_store, F32, u32)                 \
+    O(f64_store, F64, u64)                 \
+    O(i32_store8, I32, u8)                 \
+    O(i32_store16, I32, u16)               \
+    O(i64_store8, I64, u8)                 \
+    O(i64_store16, I64, u16)               \
+    O(i64_store32, I64, u32)
+
+}
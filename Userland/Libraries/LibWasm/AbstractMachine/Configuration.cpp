@@ -54,6 +54,7 @@ Result Configuration::call(Interpreter& interpreter, FunctionAddress address, Ve
             move(locals),
             wasm_function->code().body(),
             wasm_function->type().results().size(),
+            wasm_function,
         });
         m_ip = 0;
         return execute(interpreter);
@@ -74,9 +75,9 @@ Result Configuration::execute(Interpreter& interpreter)
         return Trap { "Not enough values to return from call" };
 
     Vector<Value> results;
-    results.ensure_capacity(frame().arity());
-    for (size_t i = 0; i < frame().arity(); ++i)
-        results.append(move(stack().pop().get<Value>()));
+    results.resize(frame().arity());
+    for (size_t i = frame().arity(); i > 0; --i)
+        results[i - 1] = move(stack().pop().get<Value>());
     auto label = stack().pop();
     // ASSERT: label == current frame
     if (!label.has<Label>())
@@ -0,0 +1,843 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/Validator.h>
+#include <LibWasm/Printer/Printer.h>
+
+namespace Wasm {
+
+// Type-checks a function body, following https://webassembly.github.io/spec/core/appendix/algorithm.html
+class FunctionValidator {
+public:
+    FunctionValidator(Validator::Context const& context, Module::Function const& function, FunctionType const& type)
+        : m_context(context)
+        , m_function(function)
+        , m_type(type)
+    {
+    }
+
+    bool validate();
+
+    auto& error() const { return m_error; }
+    auto max_stack_height() const { return m_max_stack_height; }
+
+private:
+    // Values of unknown type only appear in unreachable code, where anything can be popped off an empty stack.
+    using StackType = Optional<ValueType::Kind>;
+
+    struct ControlFrame {
+        OpCode opcode { 0 };
+        Vector<ValueType> start_types;
+        Vector<ValueType> end_types;
+        size_t height { 0 };
+        bool unreachable { false };
+
+        auto& label_types() const { return opcode == Instructions::loop ? start_types : end_types; }
+    };
+
+    bool validate_instruction(Instruction const&);
+    bool validate_memory_argument(Instruction const&, size_t natural_size);
+    bool validate_table_index(TableIndex);
+    bool validate_block_type(BlockType const&, Vector<ValueType>& parameters, Vector<ValueType>& results);
+
+    void push(StackType type)
+    {
+        m_values.append(type);
+        update_max_stack_height();
+    }
+    void push(Vector<ValueType> const& types)
+    {
+        for (auto& type : types)
+            push(type.kind());
+    }
+    bool pop(StackType& type);
+    bool pop(ValueType::Kind);
+    bool pop(Vector<ValueType> const&);
+    bool top_matches(Vector<ValueType> const&);
+    bool pop_reference(StackType&);
+
+    void push_frame(OpCode, Vector<ValueType> start_types, Vector<ValueType> end_types);
+    bool pop_frame(ControlFrame&);
+    bool label(LabelIndex, ControlFrame const*&);
+    void mark_unreachable()
+    {
+        m_values.shrink(m_frames.last().height);
+        m_frames.last().unreachable = true;
+    }
+    void update_max_stack_height() { m_max_stack_height = max(m_max_stack_height, m_values.size() + m_frames.size()); }
+
+    bool fail(String error)
+    {
+        m_error = move(error);
+        return false;
+    }
+
+    Validator::Context const& m_context;
+    Module::Function const& m_function;
+    FunctionType const& m_type;
+    Vector<ValueType> m_locals;
+    Vector<StackType> m_values;
+    Vector<ControlFrame> m_frames;
+    size_t m_max_stack_height { 0 };
+    String m_error;
+};
+
+bool FunctionValidator::pop(StackType& type)
+{
+    auto& frame = m_frames.last();
+    if (m_values.size() == frame.height) {
+        if (!frame.unreachable)
+            return fail("Not enough values on the stack");
+        type = {};
+        return true;
+    }
+    type = m_values.take_last();
+    return true;
+}
+
+bool FunctionValidator::pop(ValueType::Kind expected)
+{
+    StackType type;
+    if (!pop(type))
+        return false;
+    if (type.has_value() && *type != expected)
+        return fail(String::formatted("Expected a value of type {}, but got {}", ValueType::kind_name(expected), ValueType::kind_name(*type)));
+    return true;
+}
+
+bool FunctionValidator::pop(Vector<ValueType> const& types)
+{
+    for (size_t i = types.size(); i > 0; --i) {
+        if (!pop(types[i - 1].kind()))
+            return false;
+    }
+    return true;
+}
+
+// Checks the values on top of the stack without popping them.
+bool FunctionValidator::top_matches(Vector<ValueType> const& types)
+{
+    auto& frame = m_frames.last();
+    for (size_t i = 0; i < types.size(); ++i) {
+        auto expected = types[types.size() - i - 1].kind();
+        if (m_values.size() <= frame.height + i) {
+            if (!frame.unreachable)
+                return fail("Not enough values on the stack");
+            break;
+        }
+        auto& type = m_values[m_values.size() - i - 1];
+        if (type.has_value() && *type != expected)
+            return fail(String::formatted("Expected a value of type {}, but got {}", ValueType::kind_name(expected), ValueType::kind_name(*type)));
+    }
+    return true;
+}
+
+bool FunctionValidator::pop_reference(StackType& type)
+{
+    if (!pop(type))
+        return false;
+    if (type.has_value() && *type != ValueType::FunctionReference && *type != ValueType::ExternReference)
+        return fail(String::formatted("Expected a reference, but got {}", ValueType::kind_name(*type)));
+    return true;
+}
+
+void FunctionValidator::push_frame(OpCode opcode, Vector<ValueType> start_types, Vector<ValueType> end_types)
+{
+    ControlFrame frame;
+    frame.opcode = opcode;
+    frame.start_types = move(start_types);
+    frame.end_types = move(end_types);
+    frame.height = m_values.size();
+    m_frames.append(move(frame));
+    push(m_frames.last().start_types);
+    update_max_stack_height();
+}
+
+bool FunctionValidator::pop_frame(ControlFrame& frame)
+{
+    if (m_frames.is_empty())
+        return fail("Unbalanced structured instructions");
+    if (!pop(m_frames.last().end_types))
+        return false;
+    if (m_values.size() != m_frames.last().height)
+        return fail("Too many values on the stack at the end of a block");
+    frame = m_frames.take_last();
+    return true;
+}
+
+bool FunctionValidator::label(LabelIndex index, ControlFrame const*& frame)
+{
+    if (index.value() >= m_frames.size())
+        return fail(String::formatted("Branch to nonexistent label {}", index.value()));
+    frame = &m_frames[m_frames.size() - index.value() - 1];
+    return true;
+}
+
+bool FunctionValidator::validate_block_type(BlockType const& type, Vector<ValueType>& parameters, Vector<ValueType>& results)
+{
+    switch (type.kind()) {
+    case BlockType::Empty:
+        return true;
+    case BlockType::Type:
+        results.append(type.value_type());
+        return true;
+    case BlockType::Index: {
+        auto index = type.type_index().value();
+        if (index >= m_context.types.size())
+            return fail(String::formatted("Block type refers to nonexistent type {}", index));
+        parameters.extend(m_context.types[index].parameters());
+        results.extend(m_context.types[index].results());
+        return true;
+    }
+    }
+    VERIFY_NOT_REACHED();
+}
+
+bool FunctionValidator::validate_memory_argument(Instruction const& instruction, size_t natural_size)
+{
+    if (m_context.memories.is_empty())
+        return fail(String::formatted("{} used in a module without memory", instruction_name(instruction.opcode())));
+    auto& argument = instruction.arguments().get<Instruction::MemoryArgument>();
+    if (argument.align >= 32 || (1ull << argument.align) > natural_size)
+        return fail(String::formatted("Alignment of {} is larger than its natural alignment", instruction_name(instruction.opcode())));
+    return true;
+}
+
+bool FunctionValidator::validate_table_index(TableIndex index)
+{
+    if (index.value() >= m_context.tables.size())
+        return fail(String::formatted("Use of nonexistent table {}", index.value()));
+    return true;
+}
+
+bool FunctionValidator::validate()
+{
+    m_locals.extend(m_type.parameters());
+    m_locals.extend(m_function.locals());
+
+    push_frame(Instructions::block, {}, m_type.results());
+
+    for (auto& instruction : m_function.body().instructions()) {
+        if (!validate_instruction(instruction))
+            return false;
+    }
+
+    // The function's own end isn't part of its body.
+    ControlFrame frame;
+    if (!pop_frame(frame))
+        return false;
+    if (!m_frames.is_empty())
+        return fail("Unbalanced structured instructions");
+    return true;
+}
+
+bool FunctionValidator::validate_instruction(Instruction const& instruction)
+{
+    auto opcode = instruction.opcode();
+    switch (opcode.value()) {
+#define M(name, operand_kind, result_kind, ...) \
+    case Instructions::name.value():            \
+        if (!pop(ValueType::operand_kind))      \
+            return false;                       \
+        push(ValueType::result_kind);           \
+        return true;
+        ENUMERATE_WASM_UNARY_OPERATIONS(M)
+#undef M
+#define M(name, operand_kind, result_kind, ...)                                   \
+    case Instructions::name.value():                                              \
+        if (!pop(ValueType::operand_kind) || !pop(ValueType::operand_kind))       \
+            return false;                                                         \
+        push(ValueType::result_kind);                                             \
+        return true;
+        ENUMERATE_WASM_BINARY_OPERATIONS(M)
+#undef M
+#define M(name, kind, memory_type, ...)                                                       \
+    case Instructions::name.value():                                                          \
+        if (!validate_memory_argument(instruction, sizeof(memory_type)) || !pop(ValueType::I32)) \
+            return false;                                                                     \
+        push(ValueType::kind);                                                                \
+        return true;
+        ENUMERATE_WASM_LOAD_OPERATIONS(M)
+#undef M
+#define M(name, kind, memory_type)                                                                                      \
+    case Instructions::name.value():                                                                                    \
+        return validate_memory_argument(instruction, sizeof(memory_type)) && pop(ValueType::kind) && pop(ValueType::I32);
+        ENUMERATE_WASM_STORE_OPERATIONS(M)
+#undef M
+
+    case Instructions::i32_divs.value():
+    case Instructions::i32_divu.value():
+    case Instructions::i32_rems.value():
+    case Instructions::i32_remu.value():
+        if (!pop(ValueType::I32) || !pop(ValueType::I32))
+            return false;
+        push(ValueType::I32);
+        return true;
+    case Instructions::i64_divs.value():
+    case Instructions::i64_divu.value():
+    case Instructions::i64_rems.value():
+    case Instructions::i64_remu.value():
+        if (!pop(ValueType::I64) || !pop(ValueType::I64))
+            return false;
+        push(ValueType::I64);
+        return true;
+    case Instructions::i32_trunc_sf32.value():
+    case Instructions::i32_trunc_uf32.value():
+        if (!pop(ValueType::F32))
+            return false;
+        push(ValueType::I32);
+        return true;
+    case Instructions::i32_trunc_sf64.value():
+    case Instructions::i32_trunc_uf64.value():
+        if (!pop(ValueType::F64))
+            return false;
+        push(ValueType::I32);
+        return true;
+    case Instructions::i64_trunc_sf32.value():
+    case Instructions::i64_trunc_uf32.value():
+        if (!pop(ValueType::F32))
+            return false;
+        push(ValueType::I64);
+        return true;
+    case Instructions::i64_trunc_sf64.value():
+    case Instructions::i64_trunc_uf64.value():
+        if (!pop(ValueType::F64))
+            return false;
+        push(ValueType::I64);
+        return true;
+
+    case Instructions::i32_const.value():
+        push(ValueType::I32);
+        return true;
+    case Instructions::i64_const.value():
+        push(ValueType::I64);
+        return true;
+    case Instructions::f32_const.value():
+        push(ValueType::F32);
+        return true;
+    case Instructions::f64_const.value():
+        push(ValueType::F64);
+        return true;
+
+    case Instructions::unreachable.value():
+        mark_unreachable();
+        return true;
+    case Instructions::nop.value():
+        return true;
+    case Instructions::block.value():
+    case Instructions::loop.value():
+    case Instructions::if_.value(): {
+        auto& arguments = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
+        Vector<ValueType> parameters;
+        Vector<ValueType> results;
+        if (!validate_block_type(arguments.block_type, parameters, results))
+            return false;
+        if ((opcode == Instructions::if_ && !pop(ValueType::I32)) || !pop(parameters))
+            return false;
+        push_frame(opcode, move(parameters), move(results));
+        return true;
+    }
+    case Instructions::structured_else.value(): {
+        ControlFrame frame;
+        if (!pop_frame(frame))
+            return false;
+        if (frame.opcode != Instructions::if_)
+            return fail("else outside of an if");
+        push_frame(Instructions::structured_else, move(frame.start_types), move(frame.end_types));
+        return true;
+    }
+    case Instructions::structured_end.value(): {
+        ControlFrame frame;
+        if (!pop_frame(frame))
+            return false;
+        if (m_frames.is_empty())
+            return fail("Unbalanced structured instructions");
+        if (frame.opcode == Instructions::if_) {
+            // An if without an else implicitly passes its parameters through.
+            auto passes_through = frame.start_types.size() == frame.end_types.size();
+            for (size_t i = 0; passes_through && i < frame.start_types.size(); ++i)
+                passes_through = frame.start_types[i].kind() == frame.end_types[i].kind();
+            if (!passes_through)
+                return fail("if without else has to produce the values it takes");
+        }
+        push(frame.end_types);
+        return true;
+    }
+    case Instructions::br.value(): {
+        ControlFrame const* frame;
+        if (!label(instruction.arguments().get<LabelIndex>(), frame) || !pop(frame->label_types()))
+            return false;
+        mark_unreachable();
+        return true;
+    }
+    case Instructions::br_if.value(): {
+        ControlFrame const* frame;
+        if (!pop(ValueType::I32) || !label(instruction.arguments().get<LabelIndex>(), frame))
+            return false;
+        auto types = frame->label_types();
+        if (!pop(types))
+            return false;
+        push(types);
+        return true;
+    }
+    case Instructions::br_table.value(): {
+        auto& arguments = instruction.arguments().get<Instruction::TableBranchArgs>();
+        ControlFrame const* default_frame;
+        if (!pop(ValueType::I32) || !label(arguments.default_, default_frame))
+            return false;
+        auto arity = default_frame->label_types().size();
+        for (auto& index : arguments.labels) {
+            ControlFrame const* frame;
+            if (!label(index, frame))
+                return false;
+            if (frame->label_types().size() != arity)
+                return fail("All labels of a br_table have to take the same number of values");
+            if (!top_matches(frame->label_types()))
+                return false;
+        }
+        if (!pop(default_frame->label_types()))
+            return false;
+        mark_unreachable();
+        return true;
+    }
+    case Instructions::return_.value():
+        if (!pop(m_type.results()))
+            return false;
+        mark_unreachable();
+        return true;
+    case Instructions::call.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= m_context.functions.size())
+            return fail(String::formatted("Call to nonexistent function {}", index));
+        auto& type = m_context.functions[index];
+        if (!pop(type.parameters()))
+            return false;
+        push(type.results());
+        return true;
+    }
+    case Instructions::call_indirect.value(): {
+        auto& arguments = instruction.arguments().get<Instruction::IndirectCallArgs>();
+        if (!validate_table_index(arguments.table))
+            return false;
+        if (m_context.tables[arguments.table.value()].element_type().kind() != ValueType::FunctionReference)
+            return fail("call_indirect through a table that doesn't hold functions");
+        if (arguments.type.value() >= m_context.types.size())
+            return fail(String::formatted("call_indirect with nonexistent type {}", arguments.type.value()));
+        auto& type = m_context.types[arguments.type.value()];
+        if (!pop(ValueType::I32) || !pop(type.parameters()))
+            return false;
+        push(type.results());
+        return true;
+    }
+
+    case Instructions::drop.value(): {
+        StackType type;
+        return pop(type);
+    }
+    case Instructions::select.value(): {
+        StackType lhs, rhs;
+        if (!pop(ValueType::I32) || !pop(rhs) || !pop(lhs))
+            return false;
+        if ((lhs.has_value() && !ValueType(*lhs).is_numeric()) || (rhs.has_value() && !ValueType(*rhs).is_numeric()))
+            return fail("select without a type can only pick numbers");
+        if (lhs.has_value() && rhs.has_value() && *lhs != *rhs)
+            return fail("select between values of different types");
+        push(lhs.has_value() ? lhs : rhs);
+        return true;
+    }
+    case Instructions::select_typed.value(): {
+        auto& types = instruction.arguments().get<Vector<ValueType>>();
+        if (types.size() != 1)
+            return fail("select has to pick exactly one value");
+        auto kind = types.first().kind();
+        if (!pop(ValueType::I32) || !pop(kind) || !pop(kind))
+            return false;
+        push(kind);
+        return true;
+    }
+    case Instructions::local_get.value():
+    case Instructions::local_set.value():
+    case Instructions::local_tee.value(): {
+        auto index = instruction.arguments().get<LocalIndex>().value();
+        if (index >= m_locals.size())
+            return fail(String::formatted("Use of nonexistent local {}", index));
+        auto kind = m_locals[index].kind();
+        if (opcode != Instructions::local_get && !pop(kind))
+            return false;
+        if (opcode != Instructions::local_set)
+            push(kind);
+        return true;
+    }
+    case Instructions::global_get.value():
+    case Instructions::global_set.value(): {
+        auto index = instruction.arguments().get<GlobalIndex>().value();
+        if (index >= m_context.globals.size())
+            return fail(String::formatted("Use of nonexistent global {}", index));
+        auto& global = m_context.globals[index];
+        if (opcode == Instructions::global_get) {
+            push(global.type().kind());
+            return true;
+        }
+        if (!global.is_mutable())
+            return fail(String::formatted("global.set of immutable global {}", index));
+        return pop(global.type().kind());
+    }
+
+    case Instructions::table_get.value():
+    case Instructions::table_set.value(): {
+        auto index = instruction.arguments().get<TableIndex>();
+        if (!validate_table_index(index))
+            return false;
+        auto kind = m_context.tables[index.value()].element_type().kind();
+        if (opcode == Instructions::table_get) {
+            if (!pop(ValueType::I32))
+                return false;
+            push(kind);
+            return true;
+        }
+        return pop(kind) && pop(ValueType::I32);
+    }
+    case Instructions::table_size.value():
+        if (!validate_table_index(instruction.arguments().get<TableIndex>()))
+            return false;
+        push(ValueType::I32);
+        return true;
+    case Instructions::table_grow.value(): {
+        auto index = instruction.arguments().get<TableIndex>();
+        if (!validate_table_index(index) || !pop(ValueType::I32) || !pop(m_context.tables[index.value()].element_type().kind()))
+            return false;
+        push(ValueType::I32);
+        return true;
+    }
+    case Instructions::table_fill.value(): {
+        auto index = instruction.arguments().get<TableIndex>();
+        return validate_table_index(index) && pop(ValueType::I32) && pop(m_context.tables[index.value()].element_type().kind()) && pop(ValueType::I32);
+    }
+    case Instructions::table_copy.value(): {
+        auto& arguments = instruction.arguments().get<Instruction::TableTableArgs>();
+        if (!validate_table_index(arguments.lhs) || !validate_table_index(arguments.rhs))
+            return false;
+        if (m_context.tables[arguments.lhs.value()].element_type().kind() != m_context.tables[arguments.rhs.value()].element_type().kind())
+            return fail("table.copy between tables of different types");
+        return pop(ValueType::I32) && pop(ValueType::I32) && pop(ValueType::I32);
+    }
+    case Instructions::table_init.value(): {
+        auto& arguments = instruction.arguments().get<Instruction::TableElementArgs>();
+        if (!validate_table_index(arguments.table_index))
+            return false;
+        if (arguments.element_index.value() >= m_context.elements.size())
+            return fail(String::formatted("Use of nonexistent element segment {}", arguments.element_index.value()));
+        if (m_context.tables[arguments.table_index.value()].element_type().kind() != m_context.elements[arguments.element_index.value()].kind())
+            return fail("table.init from an element segment of a different type");
+        return pop(ValueType::I32) && pop(ValueType::I32) && pop(ValueType::I32);
+    }
+    case Instructions::elem_drop.value(): {
+        auto index = instruction.arguments().get<ElementIndex>().value();
+        if (index >= m_context.elements.size())
+            return fail(String::formatted("Use of nonexistent element segment {}", index));
+        return true;
+    }
+
+    case Instructions::memory_size.value():
+        if (m_context.memories.is_empty())
+            return fail("memory.size used in a module without memory");
+        push(ValueType::I32);
+        return true;
+    case Instructions::memory_grow.value():
+        if (m_context.memories.is_empty())
+            return fail("memory.grow used in a module without memory");
+        if (!pop(ValueType::I32))
+            return false;
+        push(ValueType::I32);
+        return true;
+    case Instructions::memory_copy.value():
+    case Instructions::memory_fill.value():
+        if (m_context.memories.is_empty())
+            return fail(String::formatted("{} used in a module without memory", instruction_name(opcode)));
+        return pop(ValueType::I32) && pop(ValueType::I32) && pop(ValueType::I32);
+    case Instructions::memory_init.value():
+    case Instructions::data_drop.value(): {
+        auto index = instruction.arguments().get<DataIndex>().value();
+        if (!m_context.data_count.has_value())
+            return fail(String::formatted("{} used in a module without a data count section", instruction_name(opcode)));
+        if (index >= *m_context.data_count)
+            return fail(String::formatted("Use of nonexistent data segment {}", index));
+        if (opcode == Instructions::data_drop)
+            return true;
+        if (m_context.memories.is_empty())
+            return fail("memory.init used in a module without memory");
+        return pop(ValueType::I32) && pop(ValueType::I32) && pop(ValueType::I32);
+    }
+
+    case Instructions::ref_null.value():
+        push(instruction.arguments().get<ValueType>().kind());
+        return true;
+    case Instructions::ref_is_null.value(): {
+        StackType type;
+        if (!pop_reference(type))
+            return false;
+        push(ValueType::I32);
+        return true;
+    }
+    case Instructions::ref_func.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= m_context.functions.size())
+            return fail(String::formatted("Reference to nonexistent function {}", index));
+        if (!m_context.references.contains(index))
+            return fail(String::formatted("Reference to function {}, which isn't declared outside of function bodies", index));
+        push(ValueType::FunctionReference);
+        return true;
+    }
+    default:
+        return fail(String::formatted("Unknown instruction {}", instruction_name(opcode)));
+    }
+}
+
+Optional<ValidationError> Validator::validate_limits(Limits const& limits, size_t bound) const
+{
+    if (limits.min() > bound || limits.max().value_or(0) > bound)
+        return ValidationError { String::formatted("Limits exceed the maximum of {}", bound) };
+    if (limits.max().has_value() && *limits.max() < limits.min())
+        return ValidationError { "Maximum limit is smaller than the minimum" };
+    return {};
+}
+
+Optional<ValidationError> Validator::validate_constant_expression(Expression const& expression, ValueType const& type, bool allow_multiple_values) const
+{
+    size_t value_count = 0;
+    for (auto& instruction : expression.instructions()) {
+        Optional<ValueType::Kind> kind;
+        switch (instruction.opcode().value()) {
+        case Instructions::i32_const.value():
+            kind = ValueType::I32;
+            break;
+        case Instructions::i64_const.value():
+            kind = ValueType::I64;
+            break;
+        case Instructions::f32_const.value():
+            kind = ValueType::F32;
+            break;
+        case Instructions::f64_const.value():
+            kind = ValueType::F64;
+            break;
+        case Instructions::ref_null.value():
+            kind = instruction.arguments().get<ValueType>().kind();
+            break;
+        case Instructions::ref_func.value():
+            if (instruction.arguments().get<FunctionIndex>().value() >= m_context.functions.size())
+                return ValidationError { "Constant expression refers to a nonexistent function" };
+            kind = ValueType::FunctionReference;
+            break;
+        case Instructions::global_get.value(): {
+            // Only immutable imported globals have a known value before the module's own globals are set up.
+            auto index = instruction.arguments().get<GlobalIndex>().value();
+            if (index >= m_context.imported_global_count || m_context.globals[index].is_mutable())
+                return ValidationError { "Constant expression refers to a global that isn't an immutable import" };
+            kind = m_context.globals[index].type().kind();
+            break;
+        }
+        default:
+            return ValidationError { String::formatted("{} is not allowed in a constant expression", instruction_name(instruction.opcode())) };
+        }
+        if (*kind != type.kind())
+            return ValidationError { String::formatted("Constant expression produces a {} instead of a {}", ValueType::kind_name(*kind), ValueType::kind_name(type.kind())) };
+        ++value_count;
+    }
+    if (value_count != 1 && !allow_multiple_values)
+        return ValidationError { "Constant expression has to produce exactly one value" };
+    return {};
+}
+
+Optional<ValidationError> Validator::build_context()
+{
+    Optional<ValidationError> error;
+    auto function_type = [&](TypeIndex index) -> FunctionType {
+        if (index.value() < m_context.types.size())
+            return m_context.types[index.value()];
+        error = ValidationError { String::formatted("Use of nonexistent type {}", index.value()) };
+        return FunctionType { {}, {} };
+    };
+
+    m_module.for_each_section_of_type<TypeSection>([&](TypeSection const& section) {
+        m_context.types.extend(section.types());
+    });
+
+    m_module.for_each_section_of_type<ImportSection>([&](ImportSection const& section) {
+        for (auto& import : section.imports()) {
+            import.description().visit(
+                [&](TypeIndex const& index) { m_context.functions.append(function_type(index)); },
+                [&](FunctionType const& type) { m_context.functions.append(type); },
+                [&](TableType const& type) { m_context.tables.append(type); },
+                [&](MemoryType const& type) { m_context.memories.append(type); },
+                [&](GlobalType const& type) {
+                    m_context.globals.append(type);
+                    ++m_context.imported_global_count;
+                });
+        }
+    });
+
+    size_t function_count = 0;
+    m_module.for_each_section_of_type<FunctionSection>([&](FunctionSection const& section) {
+        function_count = section.types().size();
+        for (auto& index : section.types())
+            m_context.functions.append(function_type(index));
+    });
+    size_t code_count = 0;
+    m_module.for_each_section_of_type<CodeSection>([&](CodeSection const& section) {
+        code_count = section.functions().size();
+    });
+    if (function_count != code_count)
+        return ValidationError { String::formatted("The module declares {} functions, but has code for {}", function_count, code_count) };
+
+    m_module.for_each_section_of_type<TableSection>([&](TableSection const& section) {
+        for (auto& table : section.tables())
+            m_context.tables.append(table.type());
+    });
+    m_module.for_each_section_of_type<MemorySection>([&](MemorySection const& section) {
+        for (auto& memory : section.memories())
+            m_context.memories.append(memory.type());
+    });
+    m_module.for_each_section_of_type<GlobalSection>([&](GlobalSection const& section) {
+        for (auto& global : section.entries())
+            m_context.globals.append(global.type());
+    });
+
+    // Functions referenced outside of function bodies may be used by ref.func.
+    auto collect_references = [&](Expression const& expression) {
+        for (auto& instruction : expression.instructions()) {
+            if (instruction.opcode() == Instructions::ref_func)
+                m_context.references.set(instruction.arguments().get<FunctionIndex>().value());
+        }
+    };
+    m_module.for_each_section_of_type<ElementSection>([&](ElementSection const& section) {
+        for (auto& segment : section.segments()) {
+            m_context.elements.append(segment.type);
+            for (auto& expression : segment.init)
+                collect_references(expression);
+        }
+    });
+    m_module.for_each_section_of_type<GlobalSection>([&](GlobalSection const& section) {
+        for (auto& global : section.entries())
+            collect_references(global.expression());
+    });
+    m_module.for_each_section_of_type<ExportSection>([&](ExportSection const& section) {
+        for (auto& entry : section.entries()) {
+            if (auto* index = entry.description().get_pointer<FunctionIndex>())
+                m_context.references.set(index->value());
+        }
+    });
+
+    m_module.for_each_section_of_type<DataCountSection>([&](DataCountSection const& section) {
+        if (section.count().has_value())
+            m_context.data_count = *section.count();
+    });
+
+    return error;
+}
+
+Optional<ValidationError> Validator::validate()
+{
+    if (auto error = build_context(); error.has_value())
+        return error;
+
+    for (auto& table : m_context.tables) {
+        if (auto error = validate_limits(table.limits(), NumericLimits<u32>::max()); error.has_value())
+            return error;
+    }
+    for (auto& memory : m_context.memories) {
+        if (auto error = validate_limits(memory.limits(), 65536); error.has_value())
+            return error;
+    }
+    if (m_context.memories.size() > 1)
+        return ValidationError { "A module can have at most one memory" };
+
+    Optional<ValidationError> error;
+    auto set_error = [&](Optional<ValidationError> new_error) {
+        if (!error.has_value())
+            error = move(new_error);
+    };
+
+    m_module.for_each_section_of_type<GlobalSection>([&](GlobalSection const& section) {
+        for (auto& global : section.entries())
+            set_error(validate_constant_expression(global.expression(), global.type().type()));
+    });
+
+    m_module.for_each_section_of_type<ElementSection>([&](ElementSection const& section) {
+        for (auto& segment : section.segments()) {
+            for (auto& expression : segment.init)
+                set_error(validate_constant_expression(expression, segment.type, true));
+            if (auto* active = segment.mode.get_pointer<ElementSection::Active>()) {
+                if (active->index.value() >= m_context.tables.size()) {
+                    set_error(ValidationError { String::formatted("Element segment refers to nonexistent table {}", active->index.value()) });
+                    continue;
+                }
+                if (m_context.tables[active->index.value()].element_type().kind() != segment.type.kind())
+                    set_error(ValidationError { "Element segment doesn't match the type of its table" });
+                set_error(validate_constant_expression(active->expression, ValueType(ValueType::I32)));
+            }
+        }
+    });
+
+    size_t data_count = 0;
+    m_module.for_each_section_of_type<DataSection>([&](DataSection const& section) {
+        data_count = section.data().size();
+        for (auto& segment : section.data()) {
+            if (auto* active = segment.value().get_pointer<DataSection::Data::Active>()) {
+                if (active->index.value() >= m_context.memories.size()) {
+                    set_error(ValidationError { String::formatted("Data segment refers to nonexistent memory {}", active->index.value()) });
+                    continue;
+                }
+                set_error(validate_constant_expression(active->offset, ValueType(ValueType::I32)));
+            }
+        }
+    });
+    if (m_context.data_count.has_value() && *m_context.data_count != data_count)
+        set_error(ValidationError { String::formatted("Data count section says {} data segments, but there are {}", *m_context.data_count, data_count) });
+
+    m_module.for_each_section_of_type<StartSection>([&](StartSection const& section) {
+        auto index = section.function().index().value();
+        if (index >= m_context.functions.size()) {
+            set_error(ValidationError { String::formatted("Start function {} doesn't exist", index) });
+            return;
+        }
+        auto& type = m_context.functions[index];
+        if (!type.parameters().is_empty() || !type.results().is_empty())
+            set_error(ValidationError { "Start function can't take or return values" });
+    });
+
+    m_module.for_each_section_of_type<ExportSection>([&](ExportSection const& section) {
+        HashTable<String> names;
+        for (auto& entry : section.entries()) {
+            if (names.set(entry.name()) != AK::HashSetResult::InsertedNewEntry)
+                set_error(ValidationError { String::formatted("Duplicate export name '{}'", entry.name()) });
+            auto in_range = entry.description().visit(
+                [&](FunctionIndex const& index) { return index.value() < m_context.functions.size(); },
+                [&](TableIndex const& index) { return index.value() < m_context.tables.size(); },
+                [&](MemoryIndex const& index) { return index.value() < m_context.memories.size(); },
+                [&](GlobalIndex const& index) { return index.value() < m_context.globals.size(); });
+            if (!in_range)
+                set_error(ValidationError { String::formatted("Export '{}' refers to something that doesn't exist", entry.name()) });
+        }
+    });
+
+    if (error.has_value())
+        return error;
+
+    auto imported_function_count = m_context.functions.size() - m_module.functions().size();
+    m_function_metadata.resize(m_module.functions().size());
+    for (size_t i = 0; i < m_module.functions().size(); ++i) {
+        auto& function = m_module.functions()[i];
+        FunctionValidator validator { m_context, function, m_context.functions[imported_function_count + i] };
+        if (!validator.validate())
+            return ValidationError { String::formatted("Function {} is invalid: {}", imported_function_count + i, validator.error()) };
+        m_function_metadata[i].max_stack_height = validator.max_stack_height();
+    }
+
+    return {};
+}
+
+}
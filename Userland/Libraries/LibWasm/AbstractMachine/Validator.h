@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2021, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashTable.h>
+#include <AK/String.h>
+#include <AK/Vector.h>
+#include <LibWasm/Types.h>
+
+namespace Wasm {
+
+struct ValidationError {
+    String error { "Unknown error" };
+};
+
+// What validating a function tells us about running it.
+struct FunctionMetadata {
+    // The most values and labels the function has on the stack at the same time.
+    size_t max_stack_height { 0 };
+};
+
+// https://webassembly.github.io/spec/core/valid/index.html
+class Validator {
+public:
+    explicit Validator(Module const& module)
+        : m_module(module)
+    {
+    }
+
+    Optional<ValidationError> validate();
+
+    // Metadata for each of the module's functions (in the order of Module::functions()), once validation succeeded.
+    auto& function_metadata() const { return m_function_metadata; }
+
+private:
+    friend class FunctionValidator;
+
+    // https://webassembly.github.io/spec/core/valid/conventions.html#contexts
+    struct Context {
+        Vector<FunctionType> types;
+        Vector<FunctionType> functions;
+        Vector<TableType> tables;
+        Vector<MemoryType> memories;
+        Vector<GlobalType> globals;
+        Vector<ValueType> elements;
+        Optional<size_t> data_count;
+        HashTable<size_t> references;
+        size_t imported_global_count { 0 };
+    };
+
+    Optional<ValidationError> build_context();
+    Optional<ValidationError> validate_limits(Limits const&, size_t bound) const;
+    Optional<ValidationError> validate_constant_expression(Expression const&, ValueType const&, bool allow_multiple_values = false) const;
+    Optional<ValidationError> validate_function(Module::Function const&, FunctionMetadata&) const;
+
+    Module const& m_module;
+    Context m_context;
+    Vector<FunctionMetadata> m_function_metadata;
+};
+
+}
@@ -1361,11 +1361,13 @@ void Module::populate_sections()
     FunctionSection const* function_section { nullptr };
     for_each_section_of_type<FunctionSection>([&](FunctionSection const& section) { function_section = &section; });
     for_each_section_of_type<CodeSection>([&](CodeSection const& section) {
-        // FIXME: This should be considered invalid once validation is implemented.
+        // Code without a matching function section entry is left for the validator to complain about.
         if (!function_section)
             return;
         size_t index = 0;
         for (auto& entry : section.functions()) {
+            if (index >= function_section->types().size())
+                break;
             auto& type_index = function_section->types()[index];
             Vector<ValueType> locals;
             for (auto& local : entry.func().locals()) {
@@ -0,0 +1,72 @@
+// prettier-ignore
+const binary = new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x13, 0x03, 0x60, 0x01, 0x7f, 0x01, 0x7f,
+        0x60, 0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x60, 0x02, 0x7f, 0x7f, 0x02, 0x7f, 0x7f, 0x03, 0x09, 0x08,
+        0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x02, 0x01, 0x05, 0x03, 0x01, 0x00, 0x01, 0x07, 0x49, 0x08,
+        0x03, 0x66, 0x69, 0x62, 0x00, 0x00, 0x03, 0x73, 0x75, 0x6d, 0x00, 0x01, 0x06, 0x62, 0x72, 0x61,
+        0x6e, 0x63, 0x68, 0x00, 0x02, 0x05, 0x61, 0x6c, 0x69, 0x61, 0x73, 0x00, 0x03, 0x09, 0x73, 0x74,
+        0x6f, 0x72, 0x65, 0x4c, 0x6f, 0x61, 0x64, 0x00, 0x04, 0x06, 0x64, 0x69, 0x76, 0x69, 0x64, 0x65,
+        0x00, 0x05, 0x04, 0x73, 0x77, 0x61, 0x70, 0x00, 0x06, 0x0c, 0x73, 0x77, 0x61, 0x70, 0x53, 0x75,
+        0x62, 0x74, 0x72, 0x61, 0x63, 0x74, 0x00, 0x07, 0x0a, 0x98, 0x01, 0x08, 0x1c, 0x00, 0x20, 0x00,
+        0x41, 0x02, 0x48, 0x04, 0x7f, 0x20, 0x00, 0x05, 0x20, 0x00, 0x41, 0x01, 0x6b, 0x10, 0x00, 0x20,
+        0x00, 0x41, 0x02, 0x6b, 0x10, 0x00, 0x6a, 0x0b, 0x0b, 0x25, 0x02, 0x01, 0x7f, 0x01, 0x7f, 0x02,
+        0x40, 0x03, 0x40, 0x20, 0x02, 0x20, 0x00, 0x4e, 0x0d, 0x01, 0x20, 0x01, 0x20, 0x02, 0x6a, 0x21,
+        0x01, 0x20, 0x02, 0x41, 0x01, 0x6a, 0x21, 0x02, 0x0c, 0x00, 0x0b, 0x0b, 0x20, 0x01, 0x0b, 0x1c,
+        0x00, 0x02, 0x7f, 0x02, 0x7f, 0x02, 0x7f, 0x41, 0x07, 0x20, 0x00, 0x0e, 0x02, 0x00, 0x01, 0x02,
+        0x0b, 0x41, 0xe4, 0x00, 0x6a, 0x0b, 0x41, 0xc8, 0x01, 0x6a, 0x0b, 0x0b, 0x0e, 0x00, 0x20, 0x00,
+        0x20, 0x00, 0x41, 0x0a, 0x6a, 0x21, 0x00, 0x20, 0x00, 0x6b, 0x0b, 0x0e, 0x00, 0x20, 0x00, 0x20,
+        0x01, 0x36, 0x02, 0x00, 0x20, 0x00, 0x28, 0x02, 0x00, 0x0b, 0x07, 0x00, 0x20, 0x00, 0x20, 0x01,
+        0x6d, 0x0b, 0x06, 0x00, 0x20, 0x01, 0x20, 0x00, 0x0b, 0x09, 0x00, 0x20, 0x00, 0x20, 0x01, 0x10,
+        0x06, 0x6b, 0x0b
+]);
+
+// The module's functions are, in WAT:
+//   fib(n) -> i32: recursive Fibonacci
+//   sum(n) -> i32: sum of 0..n-1, computed in a loop
+//   branch(i) -> i32: br_table into three nested blocks that each carry a value
+//   alias(a) -> i32: pushes a, sets a to a + 10, and subtracts the new a from the old one
+//   storeLoad(address, value) -> i32: stores value at address and loads it back
+//   divide(a, b) -> i32: i32.div_s
+//   swap(a, b) -> (i32, i32)
+//   swapSubtract(a, b) -> i32: subtracts the results of swap(a, b)
+const module = parseWebAssemblyModule(binary);
+
+test("recursive calls", () => {
+    const fib = module.getExport("fib");
+    expect(module.invoke(fib, 0)).toBe(0);
+    expect(module.invoke(fib, 1)).toBe(1);
+    expect(module.invoke(fib, 20)).toBe(6765);
+});
+
+test("loops and branches", () => {
+    expect(module.invoke(module.getExport("sum"), 0)).toBe(0);
+    expect(module.invoke(module.getExport("sum"), 100)).toBe(4950);
+
+    const branch = module.getExport("branch");
+    expect(module.invoke(branch, 0)).toBe(307);
+    expect(module.invoke(branch, 1)).toBe(207);
+    expect(module.invoke(branch, 2)).toBe(7);
+    expect(module.invoke(branch, 1000)).toBe(7);
+});
+
+test("operands keep the value a local had when they were pushed", () => {
+    expect(module.invoke(module.getExport("alias"), 5)).toBe(-10);
+});
+
+test("memory accesses", () => {
+    const storeLoad = module.getExport("storeLoad");
+    expect(module.invoke(storeLoad, 16, 12345)).toBe(12345);
+    expect(module.invoke(storeLoad, 65532, 42)).toBe(42);
+    expect(() => module.invoke(storeLoad, 65533, 42)).toThrow(TypeError, "Execution trapped");
+});
+
+test("traps", () => {
+    const divide = module.getExport("divide");
+    expect(module.invoke(divide, 7, 2)).toBe(3);
+    expect(() => module.invoke(divide, 1, 0)).toThrow(TypeError, "Execution trapped");
+});
+
+test("multiple results keep their order", () => {
+    expect(module.invoke(module.getExport("swap"), 1, 2)).toBe(2);
+    expect(module.invoke(module.getExport("swapSubtract"), 10, 3)).toBe(-7);
+});
@@ -0,0 +1,67 @@
+// Every module here has a single function of type [] -> [i32] and exports it.
+
+test("valid module", () => {
+    // prettier-ignore
+    const binary = new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x05, 0x01, 0x60, 0x00, 0x01, 0x7f, 0x03,
+        0x02, 0x01, 0x00, 0x07, 0x0a, 0x01, 0x06, 0x61, 0x6e, 0x73, 0x77, 0x65, 0x72, 0x00, 0x00, 0x0a,
+        0x06, 0x01, 0x04, 0x00, 0x41, 0x2a, 0x0b
+    ]);
+    const module = parseWebAssemblyModule(binary);
+    expect(module.invoke(module.getExport("answer"))).toBe(42);
+});
+
+test("function returning the wrong type", () => {
+    // i64.const 1
+    // prettier-ignore
+    const binary = new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x05, 0x01, 0x60, 0x00, 0x01, 0x7f, 0x03,
+        0x02, 0x01, 0x00, 0x07, 0x05, 0x01, 0x01, 0x66, 0x00, 0x00, 0x0a, 0x06, 0x01, 0x04, 0x00, 0x42,
+        0x01, 0x0b
+    ]);
+    expect(() => parseWebAssemblyModule(binary)).toThrowWithMessage(
+        TypeError,
+        "Validation failed: Function 0 is invalid: Expected a value of type i32, but got i64"
+    );
+});
+
+test("use of a nonexistent local", () => {
+    // local.get 0
+    // prettier-ignore
+    const binary = new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x05, 0x01, 0x60, 0x00, 0x01, 0x7f, 0x03,
+        0x02, 0x01, 0x00, 0x07, 0x05, 0x01, 0x01, 0x66, 0x00, 0x00, 0x0a, 0x06, 0x01, 0x04, 0x00, 0x20,
+        0x00, 0x0b
+    ]);
+    expect(() => parseWebAssemblyModule(binary)).toThrowWithMessage(
+        TypeError,
+        "Validation failed: Function 0 is invalid: Use of nonexistent local 0"
+    );
+});
+
+test("stack underflow", () => {
+    // i32.add
+    // prettier-ignore
+    const binary = new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x05, 0x01, 0x60, 0x00, 0x01, 0x7f, 0x03,
+        0x02, 0x01, 0x00, 0x07, 0x05, 0x01, 0x01, 0x66, 0x00, 0x00, 0x0a, 0x05, 0x01, 0x03, 0x00, 0x6a,
+        0x0b
+    ]);
+    expect(() => parseWebAssemblyModule(binary)).toThrowWithMessage(
+        TypeError,
+        "Validation failed: Function 0 is invalid: Not enough values on the stack"
+    );
+});
+
+test("duplicate export names", () => {
+    // prettier-ignore
+    const binary = new Uint8Array([
+        0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x05, 0x01, 0x60, 0x00, 0x01, 0x7f, 0x03,
+        0x02, 0x01, 0x00, 0x07, 0x09, 0x02, 0x01, 0x66, 0x00, 0x00, 0x01, 0x66, 0x00, 0x00, 0x0a, 0x06,
+        0x01, 0x04, 0x00, 0x41, 0x01, 0x0b
+    ]);
+    expect(() => parseWebAssemblyModule(binary)).toThrowWithMessage(
+        TypeError,
+        "Validation failed: Duplicate export name 'f'"
+    );
+});
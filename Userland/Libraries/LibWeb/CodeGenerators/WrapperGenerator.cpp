@@ -819,6 +819,12 @@ public:
 )~~~");
     }
 
+    if (interface.extended_attributes.contains("CustomGet") || interface.extended_attributes.contains("CustomSet")) {
+        generator.append(R"~~~(
+    virtual bool has_exotic_property_access() const override { return true; }
+)~~~");
+    }
+
     if (interface.wrapper_base_class == "Wrapper") {
         generator.append(R"~~~(
     @fully_qualified_name@& impl() { return *m_impl; }
@@ -16,6 +16,7 @@
 #include <LibJS/Runtime/DataView.h>
 #include <LibJS/Runtime/TypedArray.h>
 #include <LibWasm/AbstractMachine/Interpreter.h>
+#include <LibWasm/AbstractMachine/Validator.h>
 #include <LibWeb/Bindings/WindowObject.h>
 #include <LibWeb/WebAssembly/WebAssemblyInstanceConstructor.h>
 #include <LibWeb/WebAssembly/WebAssemblyObject.h>
@@ -79,30 +80,57 @@ void WebAssemblyObject::visit_edges(Visitor& visitor)
     }
 }
 
+static Optional<ReadonlyBytes> buffer_source_bytes(JS::Object* buffer_object)
+{
+    if (is<JS::ArrayBuffer>(buffer_object)) {
+        auto& buffer = static_cast<JS::ArrayBuffer&>(*buffer_object);
+        return buffer.buffer().bytes();
+    }
+    if (is<JS::TypedArrayBase>(buffer_object)) {
+        auto& buffer = static_cast<JS::TypedArrayBase&>(*buffer_object);
+        return buffer.viewed_array_buffer()->buffer().span().slice(buffer.byte_offset(), buffer.byte_length());
+    }
+    if (is<JS::DataView>(buffer_object)) {
+        auto& buffer = static_cast<JS::DataView&>(*buffer_object);
+        return buffer.viewed_array_buffer()->buffer().span().slice(buffer.byte_offset(), buffer.byte_length());
+    }
+    return {};
+}
+
 JS_DEFINE_NATIVE_FUNCTION(WebAssemblyObject::validate)
 {
-    // FIXME: Implement this once module validation is implemented in LibWasm.
-    dbgln("Hit WebAssemblyObject::validate() stub!");
-    return JS::Value { true };
+    auto buffer = vm.argument(0).to_object(global_object);
+    if (!buffer)
+        return {};
+
+    auto data = buffer_source_bytes(buffer);
+    if (!data.has_value()) {
+        vm.throw_exception<JS::TypeError>(global_object, "Not a BufferSource");
+        return {};
+    }
+
+    InputMemoryStream stream { *data };
+    auto module_result = Wasm::Module::parse(stream);
+    ScopeGuard drain_errors {
+        [&] {
+            stream.handle_any_error();
+        }
+    };
+    if (module_result.is_error())
+        return JS::Value { false };
+
+    Wasm::Validator validator { module_result.value() };
+    return JS::Value { !validator.validate().has_value() };
 }
 
 Result<size_t, JS::Value> parse_module(JS::GlobalObject& global_object, JS::Object* buffer_object)
 {
-    ReadonlyBytes data;
-    if (is<JS::ArrayBuffer>(buffer_object)) {
-        auto& buffer = static_cast<JS::ArrayBuffer&>(*buffer_object);
-        data = buffer.buffer();
-    } else if (is<JS::TypedArrayBase>(buffer_object)) {
-        auto& buffer = static_cast<JS::TypedArrayBase&>(*buffer_object);
-        data = buffer.viewed_array_buffer()->buffer().span().slice(buffer.byte_offset(), buffer.byte_length());
-    } else if (is<JS::DataView>(buffer_object)) {
-        auto& buffer = static_cast<JS::DataView&>(*buffer_object);
-        data = buffer.viewed_array_buffer()->buffer().span().slice(buffer.byte_offset(), buffer.byte_length());
-    } else {
+    auto data = buffer_source_bytes(buffer_object);
+    if (!data.has_value()) {
         auto error = JS::TypeError::create(global_object, "Not a BufferSource");
         return JS::Value { error };
     }
-    InputMemoryStream stream { data };
+    InputMemoryStream stream { *data };
     auto module_result = Wasm::Module::parse(stream);
     ScopeGuard drain_errors {
         [&] {